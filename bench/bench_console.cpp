@@ -0,0 +1,52 @@
+#include "console.h"
+#include "muted.h"
+
+#include <cstdint>
+#include <string>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+const std::string HOST { "192.168.100.42" };
+
+// a message below the threshold should cost one relaxed load
+void consoleFiltered(benchmark::State& state)
+{
+    const Muted muted(console::Level::ERROR);
+    int64_t round = 0;
+    for (auto _ : state)
+    {
+        console::info("{} answered request {}", HOST, ++round);
+    }
+}
+
+void consoleSync(benchmark::State& state)
+{
+    const Muted muted(console::Level::INFO);
+    int64_t round = 0;
+    for (auto _ : state)
+    {
+        console::info("{} answered request {}", HOST, ++round);
+    }
+}
+
+void consoleAsync(benchmark::State& state)
+{
+    const Muted muted(console::Level::INFO);
+    console::startAsync(console::AsyncConfig { .capacity = 4096 });
+    int64_t round = 0;
+    for (auto _ : state)
+    {
+        console::info("{} answered request {}", HOST, ++round);
+    }
+    console::stopAsync();
+    state.counters["dropped"] = static_cast<double>(console::dropped());
+}
+
+} // anonymous namespace
+
+BENCHMARK(consoleFiltered);
+BENCHMARK(consoleSync);
+BENCHMARK(consoleAsync);
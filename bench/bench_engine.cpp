@@ -0,0 +1,116 @@
+#include "console.h"
+#include "fake_io.h"
+#include "muted.h"
+#include "sticky_engine.h"
+#include "sticky_socket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+// counts what arrives instead of dumping it to the console
+class QuietSocket : public StickySocket
+{
+  public:
+    using StickySocket::StickySocket;
+
+    void didReceived(std::span<const uint8_t> data) override { received += data.size(); }
+
+    size_t received = 0;
+};
+
+class BenchEngine : public StickyEngine
+{
+  public:
+    using StickyEngine::rebuild_poll_params;
+    using StickyEngine::StickyEngine;
+};
+
+auto populate(StickyEngine& engine, int64_t count) -> std::vector<StickySocket*>
+{
+    std::vector<StickySocket*> fleet;
+    fleet.reserve(static_cast<size_t>(count));
+    for (int64_t i = 0; i < count; i++)
+    {
+        const auto port = static_cast<uint16_t>(5000 + i);
+        fleet.push_back(&engine.makeSocket<QuietSocket>("10.0.0.1", port));
+    }
+    return fleet;
+}
+
+void bringOnline(StickyEngine& engine, const std::vector<StickySocket*>& fleet)
+{
+    for (auto* skt : fleet)
+    {
+        skt->connect();
+    }
+    engine.poll(0);
+}
+
+// every session readable on every poll, the engine's worst steady state
+void enginePollDispatch(benchmark::State& state)
+{
+    const Muted muted(console::Level::ERROR);
+    const FakeIo io;
+    BenchEngine engine(io);
+    const auto fleet = populate(engine, state.range(0));
+    bringOnline(engine, fleet);
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(engine.poll(0));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void engineRebuildPollParams(benchmark::State& state)
+{
+    const Muted muted(console::Level::ERROR);
+    const FakeIo io;
+    BenchEngine engine(io);
+    const auto fleet = populate(engine, state.range(0));
+    bringOnline(engine, fleet);
+
+    for (auto _ : state)
+    {
+        engine.rebuild_poll_params();
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+// the whole fleet refused at once: connect, fail, back off, give up
+void engineReconnectStorm(benchmark::State& state)
+{
+    const Muted muted(console::Level::ERROR);
+    FakeIo io;
+    io.refuseConnections(true);
+    BenchEngine engine(io);
+    const auto fleet = populate(engine, state.range(0));
+
+    for (auto _ : state)
+    {
+        for (auto* skt : fleet)
+        {
+            skt->connect();
+        }
+        engine.poll(0);
+        for (auto* skt : fleet)
+        {
+            skt->disconnect();
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // anonymous namespace
+
+BENCHMARK(enginePollDispatch)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(engineRebuildPollParams)->RangeMultiplier(4)->Range(16, 4096);
+BENCHMARK(engineReconnectStorm)->RangeMultiplier(4)->Range(16, 4096);
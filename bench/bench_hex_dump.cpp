@@ -0,0 +1,79 @@
+#include "console.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iomanip>
+#include <iterator>
+#include <numeric>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+// what console::buffer used to do for every received chunk
+auto streamDump(std::span<const uint8_t> buffer) -> std::string
+{
+    std::ostringstream oss;
+    oss << "bench (" << buffer.size() << " bytes): ";
+    for (const auto& value : buffer)
+    {
+        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(value)
+            << " ";
+    }
+    return oss.str();
+}
+
+auto payload(int64_t size) -> std::vector<uint8_t>
+{
+    std::vector<uint8_t> bytes(static_cast<size_t>(size));
+    std::iota(bytes.begin(), bytes.end(), uint8_t { 0 });
+    return bytes;
+}
+
+void hexDumpStream(benchmark::State& state)
+{
+    const auto bytes = payload(state.range(0));
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(streamDump(bytes));
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void hexDumpTable(benchmark::State& state)
+{
+    const auto bytes = payload(state.range(0));
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        std::format_to(std::back_inserter(out), "{} ({} bytes): ", "bench", bytes.size());
+        console::hexDump(out, bytes);
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void hexDumpTableWithGutter(benchmark::State& state)
+{
+    const auto bytes = payload(state.range(0));
+    std::string out;
+    for (auto _ : state)
+    {
+        out.clear();
+        console::hexDump(out, bytes, { .perLine = 16, .ascii = true, .limit = 0 });
+        benchmark::DoNotOptimize(out.data());
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+} // anonymous namespace
+
+BENCHMARK(hexDumpStream)->Arg(64)->Arg(4096);
+BENCHMARK(hexDumpTable)->Arg(64)->Arg(4096);
+BENCHMARK(hexDumpTableWithGutter)->Arg(64)->Arg(4096);
@@ -0,0 +1,120 @@
+#include "hot_state.h"
+#include "io_access.h"
+#include "sticky_socket.h"
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+using State = EasySocketIntf::ConnectionState;
+
+// the fleet the way the engine used to hold it, one heap object per session
+auto makeFleet(const IoIntf& io, size_t count)
+    -> std::vector<std::unique_ptr<StickySocket>>
+{
+    std::vector<std::unique_ptr<StickySocket>> fleet;
+    fleet.reserve(count);
+    for (size_t i = 0; i < count; i++)
+    {
+        fleet.push_back(std::make_unique<StickySocket>(io, "127.0.0.1", 5000));
+    }
+    return fleet;
+}
+
+void scanSocketsForReconnect(benchmark::State& state)
+{
+    const IoAdapter io;
+    const auto fleet = makeFleet(io, static_cast<size_t>(state.range(0)));
+    const auto now = Timer::Clock::now();
+    std::vector<size_t> rows;
+    rows.reserve(fleet.size());
+
+    for (auto _ : state)
+    {
+        rows.clear();
+        for (size_t row = 0; row < fleet.size(); row++)
+        {
+            const auto& skt = *fleet[row];
+            if (skt.getState() == State::Disconnected && skt.getNextAttempt() <= now)
+            {
+                rows.push_back(row);
+            }
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void scanHotStateForReconnect(benchmark::State& state)
+{
+    const IoAdapter io;
+    const StickySocket skt(io, "127.0.0.1", 5000);
+    HotState hot;
+    for (int64_t i = 0; i < state.range(0); i++)
+    {
+        hot.append(skt);
+    }
+    const auto now = Timer::Clock::now();
+    std::vector<size_t> rows;
+    rows.reserve(hot.size());
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hot.dueForReconnect(now, rows));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void scanSocketsForOutput(benchmark::State& state)
+{
+    const IoAdapter io;
+    const auto fleet = makeFleet(io, static_cast<size_t>(state.range(0)));
+    std::vector<size_t> rows;
+    rows.reserve(fleet.size());
+
+    for (auto _ : state)
+    {
+        rows.clear();
+        for (size_t row = 0; row < fleet.size(); row++)
+        {
+            if (fleet[row]->pendingBytes() > 0)
+            {
+                rows.push_back(row);
+            }
+        }
+        benchmark::DoNotOptimize(rows.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void scanHotStateForOutput(benchmark::State& state)
+{
+    const IoAdapter io;
+    const StickySocket skt(io, "127.0.0.1", 5000);
+    HotState hot;
+    for (int64_t i = 0; i < state.range(0); i++)
+    {
+        hot.append(skt);
+    }
+    std::vector<size_t> rows;
+    rows.reserve(hot.size());
+
+    for (auto _ : state)
+    {
+        benchmark::DoNotOptimize(hot.withPendingOutput(rows));
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+} // anonymous namespace
+
+BENCHMARK(scanSocketsForReconnect)->Arg(10'000)->Arg(100'000);
+BENCHMARK(scanHotStateForReconnect)->Arg(10'000)->Arg(100'000);
+BENCHMARK(scanSocketsForOutput)->Arg(10'000)->Arg(100'000);
+BENCHMARK(scanHotStateForOutput)->Arg(10'000)->Arg(100'000);
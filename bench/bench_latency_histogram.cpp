@@ -0,0 +1,57 @@
+#include "latency_histogram.h"
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+// spread like reply times are, mostly short with a long tail
+auto samples() -> std::vector<std::chrono::nanoseconds>
+{
+    std::vector<std::chrono::nanoseconds> taken;
+    uint64_t seed = 0x9E3779B97F4A7C15ULL;
+    for (int i = 0; i < 4096; i++)
+    {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        taken.emplace_back(static_cast<int64_t>((seed % 4096) * (seed % 4096)) * 100);
+    }
+    return taken;
+}
+
+void latencyRecord(benchmark::State& state)
+{
+    const auto values = samples();
+    LatencyHistogram histogram;
+    size_t next = 0;
+    for (auto _ : state)
+    {
+        histogram.record(values[next]);
+        next = (next + 1) % values.size();
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+void latencySnapshot(benchmark::State& state)
+{
+    LatencyHistogram histogram;
+    for (const auto value : samples())
+    {
+        histogram.record(value);
+    }
+    for (auto _ : state)
+    {
+        const auto snapshot = histogram.snapshot();
+        benchmark::DoNotOptimize(snapshot.percentile(99.9));
+    }
+}
+
+} // anonymous namespace
+
+BENCHMARK(latencyRecord);
+BENCHMARK(latencySnapshot);
@@ -0,0 +1,146 @@
+#include "io_access.h"
+#include "ipv4_socket.h"
+#include "muted.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <benchmark/benchmark.h>
+
+namespace
+{
+
+class CountingSocket : public IPv4Socket
+{
+  public:
+    using IPv4Socket::IPv4Socket;
+
+    void didReceived(std::span<const uint8_t> data) override { received += data.size(); }
+
+    size_t received = 0;
+};
+
+/***
+ * A socket connected over loopback to a peer the benchmark plays itself
+ */
+class Loopback
+{
+  public:
+    explicit Loopback(const IoIntf& io)
+        : listener(::socket(AF_INET, SOCK_STREAM, 0))
+    {
+        struct sockaddr_in address {
+            .sin_family = AF_INET,
+            .sin_port = 0,
+            .sin_addr = { .s_addr = htonl(INADDR_LOOPBACK) },
+        };
+        socklen_t length = sizeof(address);
+        auto* raw = reinterpret_cast<struct sockaddr*>(&address);
+        ::bind(listener, raw, sizeof(address));
+        ::listen(listener, 1);
+        ::getsockname(listener, raw, &length);
+
+        const uint16_t port = ntohs(address.sin_port);
+        client = std::make_unique<CountingSocket>(io, "127.0.0.1", port);
+        client->connect();
+        peer = ::accept(listener, nullptr, nullptr);
+        client->eval(pollfd {
+            .fd = client->getDescriptor(), .events = POLLOUT, .revents = POLLOUT
+        });
+    }
+
+    ~Loopback()
+    {
+        client.reset();
+        ::close(peer);
+        ::close(listener);
+    }
+
+    // bad luck
+    Loopback(const Loopback&) = delete;
+    Loopback& operator=(const Loopback&) = delete;
+    Loopback(Loopback&&) = delete;
+    Loopback& operator=(Loopback&&) = delete;
+
+    [[nodiscard]] auto online() const -> bool
+    {
+        return client->getState() == EasySocketIntf::ConnectionState::Connected;
+    }
+
+    void drainPeer()
+    {
+        std::array<uint8_t, 65536> sink {};
+        while (::recv(peer, sink.data(), sink.size(), MSG_DONTWAIT) > 0)
+        {
+        }
+    }
+
+    int listener;
+    int peer = -1;
+    std::unique_ptr<CountingSocket> client;
+};
+
+void socketSend(benchmark::State& state)
+{
+    const Muted muted(console::Level::ERROR);
+    const IoAdapter io;
+    Loopback link(io);
+    if (!link.online())
+    {
+        state.SkipWithError("loopback connection failed");
+        return;
+    }
+    const std::vector<uint8_t> payload(static_cast<size_t>(state.range(0)), 0x5A);
+
+    for (auto _ : state)
+    {
+        link.client->send(payload);
+        state.PauseTiming();
+        link.drainPeer();
+        link.client->flush();
+        state.ResumeTiming();
+    }
+    state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+
+void socketReceive(benchmark::State& state)
+{
+    const Muted muted(console::Level::ERROR);
+    const IoAdapter io;
+    Loopback link(io);
+    if (!link.online())
+    {
+        state.SkipWithError("loopback connection failed");
+        return;
+    }
+    const auto size = static_cast<size_t>(state.range(0));
+    const std::vector<uint8_t> payload(size, 0x5A);
+    link.client->setReceiveSize(size);
+    const struct pollfd readable {
+        .fd = link.client->getDescriptor(), .events = POLLIN, .revents = POLLIN,
+    };
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        ::send(link.peer, payload.data(), payload.size(), 0);
+        state.ResumeTiming();
+        link.client->eval(readable);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(link.client->received));
+}
+
+} // anonymous namespace
+
+BENCHMARK(socketSend)->Arg(64)->Arg(1024)->Arg(16384);
+BENCHMARK(socketReceive)->Arg(64)->Arg(1024)->Arg(16384);
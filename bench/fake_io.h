@@ -0,0 +1,113 @@
+#pragma once
+
+#include "ioi.h"
+
+#include <cerrno>
+#include <cstddef>
+#include <cstring>
+
+#include <netdb.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/***
+ * Kernel stand-in for the engine benchmarks, every descriptor is always ready
+ * and every call succeeds at once, so only the library's own work is measured
+ */
+class FakeIo : public IoIntf
+{
+  public:
+    static constexpr int WAKE_DESCRIPTOR = 3;
+
+    explicit FakeIo(size_t useChunk = 64) : chunk(useChunk) {}
+
+    // connect attempts fail the way a refused connection does
+    void refuseConnections(bool refuse) { refusing = refuse; }
+
+    auto inet_pton(int, const char*, void*) const -> int override { return 1; }
+
+    auto socket(int, int, int) const -> int override { return ++lastDescriptor; }
+
+    auto connect(int, const struct sockaddr*, socklen_t) const -> int override
+    {
+        errno = EINPROGRESS;
+        return -1;
+    }
+
+    auto close(int) const -> int override { return 0; }
+
+    auto send(int, const void*, size_t len, int) const -> size_t override { return len; }
+
+    auto recv(int, void* buf, size_t len, int) const -> size_t override
+    {
+        const size_t size = len < chunk ? len : chunk;
+        std::memset(buf, 0x5A, size);
+        return size;
+    }
+
+    auto getsockopt(int, int, int, void*, socklen_t*) const -> int override
+    {
+        return refusing ? ECONNREFUSED : 0;
+    }
+
+    auto poll(struct pollfd* fds, nfds_t count, int) const -> int override
+    {
+        int events = 0;
+        for (nfds_t i = 0; i < count; i++)
+        {
+            const auto ready = static_cast<short>(fds[i].events & (POLLIN | POLLOUT));
+            fds[i].revents = (fds[i].fd == WAKE_DESCRIPTOR) ? 0 : ready;
+            events += (fds[i].revents != 0) ? 1 : 0;
+        }
+        return events;
+    }
+
+    auto epoll_create1(int) const -> int override { return -1; }
+
+    auto epoll_ctl(int, int, int, struct epoll_event*) const -> int override
+    {
+        return -1;
+    }
+
+    auto epoll_wait(int, struct epoll_event*, int, int) const -> int override
+    {
+        return -1;
+    }
+
+    auto eventfd(unsigned int, int) const -> int override { return WAKE_DESCRIPTOR; }
+
+    auto read(int, void*, size_t) const -> ssize_t override
+    {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    auto write(int, const void*, size_t len) const -> ssize_t override
+    {
+        return static_cast<ssize_t>(len);
+    }
+
+    auto writev(int, const struct iovec* iov, int iovcnt) const -> ssize_t override
+    {
+        ssize_t total = 0;
+        for (int i = 0; i < iovcnt; i++)
+        {
+            total += static_cast<ssize_t>(iov[i].iov_len);
+        }
+        return total;
+    }
+
+    auto getaddrinfo(const char*, const char*, const struct addrinfo*, struct addrinfo**)
+        const -> int override
+    {
+        return EAI_NONAME;
+    }
+
+    void freeaddrinfo(struct addrinfo*) const override {}
+
+  private:
+    size_t chunk;
+    bool refusing = false;
+    mutable int lastDescriptor = WAKE_DESCRIPTOR;
+};
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "console.h"
+
+#include <iostream>
+#include <streambuf>
+
+// swallows whatever the console writes, so the terminal is not what gets measured
+class NullBuffer : public std::streambuf
+{
+  protected:
+    auto overflow(int_type value) -> int_type override { return value; }
+    auto xsputn(const char_type*, std::streamsize count) -> std::streamsize override
+    {
+        return count;
+    }
+};
+
+/***
+ * Points std::cout at nothing and sets a level for as long as it lives
+ */
+class Muted
+{
+  public:
+    explicit Muted(console::Level threshold)
+        : saved(std::cout.rdbuf(&sink))
+        , level(console::getLevel())
+    {
+        console::setLevel(threshold);
+    }
+
+    ~Muted()
+    {
+        console::setLevel(level);
+        std::cout.rdbuf(saved);
+    }
+
+    // bad luck
+    Muted(const Muted&) = delete;
+    Muted& operator=(const Muted&) = delete;
+    Muted(Muted&&) = delete;
+    Muted& operator=(Muted&&) = delete;
+
+  private:
+    NullBuffer sink;
+    std::streambuf* saved;
+    console::Level level;
+};
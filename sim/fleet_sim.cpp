@@ -0,0 +1,487 @@
+#include "fleet_sim.h"
+
+#include "console.h"
+#include "sicp_decoder.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+using namespace std::literals;
+
+namespace
+{
+
+constexpr uint8_t SICP_ACK = 0x06;
+constexpr uint8_t FILLER = 0x5A;
+constexpr size_t HEADER = 3; // length, control and group
+constexpr size_t READ_CHUNK = 4096;
+constexpr int MAX_EVENTS = 256;
+constexpr int BACKLOG = 128;
+
+// IonSession says hello in plain text before its first frame
+constexpr std::string_view GREETING { "hello"sv };
+
+// listeners are told apart from clients by this bit in the epoll data
+constexpr uint64_t LISTENER_TAG = uint64_t { 1 } << 32;
+
+void raiseDescriptorLimit()
+{
+    struct rlimit limit {};
+    if (::getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max)
+    {
+        limit.rlim_cur = limit.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+auto perSecond(uint64_t amount, std::chrono::duration<double> elapsed) -> double
+{
+    return elapsed.count() > 0 ? static_cast<double>(amount) / elapsed.count() : 0.0;
+}
+
+} // anonymous namespace
+
+FleetSimulator::FleetSimulator(FleetConfig useConfig)
+    : config(std::move(useConfig))
+    , poller(-1)
+    , random(config.seed)
+{
+}
+
+FleetSimulator::~FleetSimulator()
+{
+    for (auto& client : clients)
+    {
+        if (client)
+        {
+            ::close(client->descriptor);
+        }
+    }
+    for (const int listener : listeners)
+    {
+        ::close(listener);
+    }
+    if (poller >= 0)
+    {
+        ::close(poller);
+    }
+}
+
+auto FleetSimulator::displays() const -> size_t { return listeners.size(); }
+
+auto FleetSimulator::getStats() const -> const FleetStats& { return stats; }
+
+auto FleetSimulator::open() -> bool
+{
+    raiseDescriptorLimit();
+    poller = ::epoll_create1(EPOLL_CLOEXEC);
+    if (poller < 0)
+    {
+        console::error("Cannot create epoll instance: {}.", strerror(errno));
+        return false;
+    }
+
+    struct in_addr first {};
+    if (::inet_pton(AF_INET, config.firstAddress.c_str(), &first) <= 0)
+    {
+        console::error("address {} is invalid or not supported.", config.firstAddress);
+        return false;
+    }
+
+    const uint32_t base = ntohl(first.s_addr);
+    for (size_t a = 0; a < config.addresses; a++)
+    {
+        for (size_t p = 0; p < config.ports; p++)
+        {
+            const auto port = static_cast<uint16_t>(config.firstPort + p);
+            if (!listenOn(base + static_cast<uint32_t>(a), port))
+            {
+                return false;
+            }
+        }
+    }
+    console::info("{} displays listening from {}:{}.", displays(), config.firstAddress,
+                  config.firstPort);
+    return true;
+}
+
+auto FleetSimulator::listenOn(uint32_t address, uint16_t port) -> bool
+{
+    const int listener =
+        ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listener < 0)
+    {
+        console::error("Cannot create socket, reason: {}", strerror(errno));
+        return false;
+    }
+    listeners.push_back(listener);
+
+    const int reuse = 1;
+    ::setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in local {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr = { .s_addr = htonl(address) },
+    };
+    if (::bind(listener, reinterpret_cast<struct sockaddr*>(&local), sizeof(local)) < 0 ||
+        ::listen(listener, BACKLOG) < 0)
+    {
+        std::array<char, INET_ADDRSTRLEN> text {};
+        ::inet_ntop(AF_INET, &local.sin_addr, text.data(), text.size());
+        console::error("Cannot listen on {}:{}, reason: {}", text.data(), port,
+                       strerror(errno));
+        return false;
+    }
+
+    struct epoll_event event {
+        .events = EPOLLIN,
+        .data = { .u64 = LISTENER_TAG | static_cast<uint32_t>(listener) },
+    };
+    return ::epoll_ctl(poller, EPOLL_CTL_ADD, listener, &event) == 0;
+}
+
+void FleetSimulator::run(const std::atomic<bool>& stopping)
+{
+    const auto started = Clock::now();
+    reportedAt = started;
+    std::array<struct epoll_event, MAX_EVENTS> events {};
+
+    while (!stopping.load(std::memory_order_relaxed))
+    {
+        auto now = Clock::now();
+        if (config.duration.count() > 0 && now - started >= config.duration)
+        {
+            break;
+        }
+
+        const int count = ::epoll_wait(poller, events.data(), MAX_EVENTS, timeout(now));
+        if (count < 0 && errno != EINTR)
+        {
+            console::error("Polling error: {}.", strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < count; i++)
+        {
+            const auto& event = events.at(static_cast<size_t>(i));
+            const auto descriptor = static_cast<int>(event.data.u64 & ~LISTENER_TAG);
+            if ((event.data.u64 & LISTENER_TAG) != 0)
+            {
+                accept(descriptor);
+                continue;
+            }
+
+            auto* client = lookup(descriptor);
+            if (client != nullptr && (event.events & EPOLLOUT) != 0)
+            {
+                flush(*client);
+            }
+            client = lookup(descriptor);
+            if (client != nullptr && (event.events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0)
+            {
+                receive(*client);
+            }
+        }
+
+        now = Clock::now();
+        release(now);
+        report(now);
+    }
+}
+
+void FleetSimulator::accept(int listener)
+{
+    while (true)
+    {
+        const int descriptor =
+            ::accept4(listener, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (descriptor < 0)
+        {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            {
+                console::warning("accept failed: {}.", strerror(errno));
+            }
+            return;
+        }
+
+        const auto slot = static_cast<size_t>(descriptor);
+        if (slot >= clients.size())
+        {
+            clients.resize(slot + 1);
+            generations.resize(slot + 1, 0);
+        }
+        clients[slot] = std::make_unique<Client>(Client {
+            .descriptor = descriptor,
+            .generation = ++generations[slot],
+            .greeted = 0,
+            .decoder = {},
+            .backlog = {},
+        });
+
+        struct epoll_event event {
+            .events = EPOLLIN, .data = { .u64 = static_cast<uint32_t>(descriptor) },
+        };
+        ::epoll_ctl(poller, EPOLL_CTL_ADD, descriptor, &event);
+        stats.accepted++;
+    }
+}
+
+void FleetSimulator::receive(Client& client)
+{
+    std::array<uint8_t, READ_CHUNK> chunk {};
+    const ssize_t bytes = ::recv(client.descriptor, chunk.data(), chunk.size(), 0);
+    if (bytes <= 0)
+    {
+        if (bytes == 0 || (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR))
+        {
+            close(client);
+        }
+        return;
+    }
+    stats.bytesIn += static_cast<uint64_t>(bytes);
+
+    std::span<const uint8_t> data { chunk.data(), static_cast<size_t>(bytes) };
+    while (client.greeted < GREETING.size() && !data.empty())
+    {
+        if (data.front() != static_cast<uint8_t>(GREETING[client.greeted]))
+        {
+            client.greeted = GREETING.size();
+            break;
+        }
+        client.greeted++;
+        data = data.subspan(1);
+    }
+
+    // replies may hang up, so frames are copied out before any of them is answered
+    std::vector<std::array<uint8_t, sicp::MAX_FRAME + 1>> frames;
+    const uint64_t errors = client.decoder.getErrors();
+    client.decoder.feed(data, [&frames](std::span<const uint8_t> frame)
+    {
+        auto& copy = frames.emplace_back();
+        copy[0] = static_cast<uint8_t>(frame.size());
+        std::copy(frame.begin(), frame.end(), copy.begin() + 1);
+    });
+    stats.badFrames += client.decoder.getErrors() - errors;
+
+    const int descriptor = client.descriptor;
+    for (const auto& copy : frames)
+    {
+        auto* current = lookup(descriptor);
+        if (current == nullptr)
+        {
+            break;
+        }
+        answer(*current, std::span(copy).subspan(1, copy[0]));
+    }
+}
+
+void FleetSimulator::answer(Client& client, std::span<const uint8_t> request)
+{
+    stats.requests++;
+    if (chance(config.disconnectRate))
+    {
+        stats.disconnects++;
+        close(client);
+        return;
+    }
+    if (chance(config.dropRate))
+    {
+        stats.dropped++;
+        return;
+    }
+
+    // control and group come back the way they went, like a real display does
+    const uint8_t control = request[1];
+    const uint8_t group = request.size() > sicp::MIN_FRAME ? request[2] : 0;
+    std::array<uint8_t, sicp::MAX_FRAME> data {};
+    size_t length = 1;
+    data[0] = SICP_ACK;
+    if (config.payload > 0)
+    {
+        length = std::min(config.payload, sicp::MAX_FRAME - HEADER - 1);
+        data[0] = request.size() > HEADER + 1 ? request[HEADER] : FILLER;
+        std::fill(data.begin() + 1, data.begin() + static_cast<ptrdiff_t>(length), FILLER);
+    }
+
+    Reply reply {
+        .due = Clock::now() + config.latency,
+        .descriptor = client.descriptor,
+        .generation = client.generation,
+        .length = 0,
+        .frame = {},
+    };
+    reply.length = static_cast<uint8_t>(
+        sicp::encode(reply.frame, control, group, std::span(data).first(length))
+    );
+    if (config.jitter.count() > 0)
+    {
+        std::uniform_int_distribution<int64_t> spread(0, config.jitter.count());
+        reply.due += std::chrono::milliseconds(spread(random));
+    }
+
+    if (config.latency.count() == 0 && config.jitter.count() == 0)
+    {
+        transmit(client, std::span(reply.frame).first(reply.length));
+        return;
+    }
+    replies.push(reply);
+}
+
+void FleetSimulator::transmit(Client& client, std::span<const uint8_t> bytes)
+{
+    stats.replies++;
+    if (!client.backlog.empty())
+    {
+        client.backlog.insert(client.backlog.end(), bytes.begin(), bytes.end());
+        return;
+    }
+
+    const ssize_t sent =
+        ::send(client.descriptor, bytes.data(), bytes.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+    {
+        close(client);
+        return;
+    }
+
+    const auto written = static_cast<size_t>(std::max<ssize_t>(sent, 0));
+    stats.bytesOut += written;
+    if (written < bytes.size())
+    {
+        client.backlog.assign(bytes.begin() + static_cast<ptrdiff_t>(written),
+                              bytes.end());
+        struct epoll_event event {
+            .events = EPOLLIN | EPOLLOUT,
+            .data = { .u64 = static_cast<uint32_t>(client.descriptor) },
+        };
+        ::epoll_ctl(poller, EPOLL_CTL_MOD, client.descriptor, &event);
+    }
+}
+
+void FleetSimulator::flush(Client& client)
+{
+    if (client.backlog.empty())
+    {
+        return;
+    }
+
+    const ssize_t sent = ::send(client.descriptor, client.backlog.data(),
+                                client.backlog.size(), MSG_NOSIGNAL | MSG_DONTWAIT);
+    if (sent < 0)
+    {
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        {
+            close(client);
+        }
+        return;
+    }
+
+    stats.bytesOut += static_cast<uint64_t>(sent);
+    client.backlog.erase(client.backlog.begin(), client.backlog.begin() + sent);
+    if (client.backlog.empty())
+    {
+        struct epoll_event event {
+            .events = EPOLLIN, .data = { .u64 = static_cast<uint32_t>(client.descriptor) },
+        };
+        ::epoll_ctl(poller, EPOLL_CTL_MOD, client.descriptor, &event);
+    }
+}
+
+void FleetSimulator::close(Client& client)
+{
+    const auto slot = static_cast<size_t>(client.descriptor);
+    ::epoll_ctl(poller, EPOLL_CTL_DEL, client.descriptor, nullptr);
+    ::close(client.descriptor);
+    clients[slot].reset();
+    stats.closed++;
+}
+
+void FleetSimulator::release(Clock::time_point now)
+{
+    while (!replies.empty() && replies.top().due <= now)
+    {
+        const Reply reply = replies.top();
+        replies.pop();
+
+        auto* client = lookup(reply.descriptor);
+        if (client == nullptr || client->generation != reply.generation)
+        {
+            continue;
+        }
+        transmit(*client, std::span(reply.frame).first(reply.length));
+    }
+}
+
+void FleetSimulator::report(Clock::time_point now)
+{
+    const std::chrono::duration<double> elapsed = now - reportedAt;
+    if (elapsed < config.reportEvery)
+    {
+        return;
+    }
+
+    const size_t online = static_cast<size_t>(
+        std::count_if(clients.begin(), clients.end(), [](const auto& c) { return !!c; })
+    );
+    console::info(
+        "clients {} | requests {:.0f}/s replies {:.0f}/s | dropped {} hung up {} bad {} | "
+        "in {:.2f} MB/s out {:.2f} MB/s | pending {}",
+        online, perSecond(stats.requests - lastReport.requests, elapsed),
+        perSecond(stats.replies - lastReport.replies, elapsed),
+        stats.dropped - lastReport.dropped, stats.disconnects - lastReport.disconnects,
+        stats.badFrames - lastReport.badFrames,
+        perSecond(stats.bytesIn - lastReport.bytesIn, elapsed) / 1e6,
+        perSecond(stats.bytesOut - lastReport.bytesOut, elapsed) / 1e6, replies.size()
+    );
+    lastReport = stats;
+    reportedAt = now;
+}
+
+auto FleetSimulator::timeout(Clock::time_point now) const -> int
+{
+    // wake for the next due reply or the next report, whichever comes first
+    auto until = reportedAt + config.reportEvery;
+    if (!replies.empty())
+    {
+        until = std::min(until, replies.top().due);
+    }
+    if (until <= now)
+    {
+        return 0;
+    }
+    const auto wait = std::chrono::ceil<std::chrono::milliseconds>(until - now);
+    return static_cast<int>(wait.count());
+}
+
+auto FleetSimulator::lookup(int descriptor) const -> Client*
+{
+    const auto slot = static_cast<size_t>(descriptor);
+    return slot < clients.size() ? clients[slot].get() : nullptr;
+}
+
+auto FleetSimulator::chance(double rate) -> bool
+{
+    if (rate <= 0.0)
+    {
+        return false;
+    }
+    return std::uniform_real_distribution<double>(0.0, 1.0)(random) < rate;
+}
@@ -0,0 +1,118 @@
+#pragma once
+
+#include "sicp_decoder.h"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <random>
+#include <span>
+#include <string>
+#include <vector>
+
+struct FleetConfig
+{
+    std::string firstAddress = "127.0.0.1";
+    size_t addresses = 1;   // consecutive loopback addresses, one listener each per port
+    uint16_t firstPort = 5000;
+    size_t ports = 1;       // consecutive ports per address
+    std::chrono::milliseconds latency { 0 };
+    std::chrono::milliseconds jitter { 0 }; // added on top of latency, uniformly
+    double dropRate = 0.0;       // share of requests never answered
+    double disconnectRate = 0.0; // share of requests answered by closing the connection
+    size_t payload = 0;          // 0 acknowledges, otherwise echoes this many bytes
+    std::chrono::seconds reportEvery { 5 };
+    std::chrono::seconds duration { 0 }; // 0 runs until stopped
+    uint64_t seed = 0x51C9;
+};
+
+struct FleetStats
+{
+    uint64_t accepted = 0;
+    uint64_t closed = 0;
+    uint64_t requests = 0;
+    uint64_t replies = 0;
+    uint64_t dropped = 0;
+    uint64_t disconnects = 0;
+    uint64_t badFrames = 0;
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+};
+
+/***
+ * Emulates a fleet of SICP displays from one epoll loop: every address and port
+ * pair is a display, and every request is answered after a configurable delay,
+ * or dropped, or answered by hanging up
+ */
+class FleetSimulator
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit FleetSimulator(FleetConfig useConfig);
+    ~FleetSimulator();
+
+    // bad luck
+    FleetSimulator(const FleetSimulator&) = delete;
+    FleetSimulator& operator=(const FleetSimulator&) = delete;
+    FleetSimulator(FleetSimulator&&) = delete;
+    FleetSimulator& operator=(FleetSimulator&&) = delete;
+
+    // actions
+    auto open() -> bool;
+    void run(const std::atomic<bool>& stopping);
+
+    // inspectors
+    [[nodiscard]] auto displays() const -> size_t;
+    [[nodiscard]] auto getStats() const -> const FleetStats&;
+
+  private:
+    struct Client
+    {
+        int descriptor;
+        uint32_t generation;
+        size_t greeted; // bytes of the session's "hello" already skipped
+        SicpDecoder decoder;
+        std::vector<uint8_t> backlog; // reply bytes the socket did not take yet
+    };
+
+    struct Reply
+    {
+        Clock::time_point due;
+        int descriptor;
+        uint32_t generation; // a reconnect on the same descriptor voids older replies
+        uint8_t length;
+        std::array<uint8_t, sicp::MAX_FRAME> frame;
+
+        auto operator>(const Reply& other) const -> bool { return due > other.due; }
+    };
+
+    auto listenOn(uint32_t address, uint16_t port) -> bool;
+    void accept(int listener);
+    void receive(Client& client);
+    void answer(Client& client, std::span<const uint8_t> request);
+    void transmit(Client& client, std::span<const uint8_t> bytes);
+    void flush(Client& client);
+    void close(Client& client);
+    void release(Clock::time_point now);
+    void report(Clock::time_point now);
+    [[nodiscard]] auto timeout(Clock::time_point now) const -> int;
+    [[nodiscard]] auto lookup(int descriptor) const -> Client*;
+    [[nodiscard]] auto chance(double rate) -> bool;
+
+    FleetConfig config;
+    int poller;
+    std::vector<int> listeners;
+    std::vector<std::unique_ptr<Client>> clients; // by descriptor
+    std::vector<uint32_t> generations;            // by descriptor
+    std::priority_queue<Reply, std::vector<Reply>, std::greater<>> replies;
+    std::mt19937_64 random;
+    FleetStats stats;
+    FleetStats lastReport;
+    Clock::time_point reportedAt;
+};
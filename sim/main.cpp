@@ -0,0 +1,174 @@
+#include "console.h"
+#include "fleet_sim.h"
+
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+static std::atomic<bool> stopping { false };
+
+static void signalHandler(int signal)
+{
+    if (signal == SIGINT || signal == SIGTERM)
+    {
+        stopping.store(true);
+    }
+}
+
+static void usage(std::string_view program)
+{
+    std::cout
+        << "usage: " << program << " [options]\n"
+        << "  --host ADDRESS     first address to listen on (127.0.0.1)\n"
+        << "  --addresses N      consecutive addresses, each one a display per port (1)\n"
+        << "  --port PORT        first port (5000)\n"
+        << "  --ports N          consecutive ports per address (1)\n"
+        << "  --latency MS       delay before every reply (0)\n"
+        << "  --jitter MS        random extra delay, up to this much (0)\n"
+        << "  --drop RATE        share of requests never answered, 0..1 (0)\n"
+        << "  --disconnect RATE  share of requests answered by hanging up, 0..1 (0)\n"
+        << "  --payload N        reply with N data bytes instead of an ACK (0)\n"
+        << "  --report S         seconds between throughput reports (5)\n"
+        << "  --duration S       stop after this many seconds, 0 runs until SIGINT (0)\n"
+        << "  --seed N           random seed for jitter, drops and hang ups\n";
+}
+
+template <typename T> static auto parse(std::string_view text, T& value) -> bool
+{
+    const auto* end = text.data() + text.size();
+    const auto [stop, error] = std::from_chars(text.data(), end, value);
+    return error == std::errc {} && stop == end;
+}
+
+static auto parseRate(std::string_view text, double& value) -> bool
+{
+    try
+    {
+        size_t used = 0;
+        value = std::stod(std::string(text), &used);
+        return used == text.size() && value >= 0.0 && value <= 1.0;
+    }
+    catch (...)
+    {
+        return false;
+    }
+}
+
+static auto configure(int argc, char* argv[], FleetConfig& config) -> bool
+{
+    for (int i = 1; i < argc; i++)
+    {
+        const std::string_view option { argv[i] };
+        if (option == "--help" || option == "-h" || i + 1 >= argc)
+        {
+            return false;
+        }
+
+        const std::string_view value { argv[++i] };
+        int64_t number = 0;
+        bool valid = true;
+        if (option == "--host")
+        {
+            config.firstAddress = value;
+        }
+        else if (option == "--drop")
+        {
+            valid = parseRate(value, config.dropRate);
+        }
+        else if (option == "--disconnect")
+        {
+            valid = parseRate(value, config.disconnectRate);
+        }
+        else if (option == "--seed")
+        {
+            valid = parse(value, config.seed);
+        }
+        else if (!parse(value, number) || number < 0)
+        {
+            valid = false;
+        }
+        else if (option == "--addresses")
+        {
+            config.addresses = static_cast<size_t>(number);
+        }
+        else if (option == "--port")
+        {
+            config.firstPort = static_cast<uint16_t>(number);
+            valid = number <= UINT16_MAX;
+        }
+        else if (option == "--ports")
+        {
+            config.ports = static_cast<size_t>(number);
+        }
+        else if (option == "--latency")
+        {
+            config.latency = std::chrono::milliseconds(number);
+        }
+        else if (option == "--jitter")
+        {
+            config.jitter = std::chrono::milliseconds(number);
+        }
+        else if (option == "--payload")
+        {
+            config.payload = static_cast<size_t>(number);
+        }
+        else if (option == "--report")
+        {
+            config.reportEvery = std::chrono::seconds(std::max<int64_t>(number, 1));
+        }
+        else if (option == "--duration")
+        {
+            config.duration = std::chrono::seconds(number);
+        }
+        else
+        {
+            valid = false;
+        }
+
+        if (!valid)
+        {
+            console::error("bad value {} for {}.", value, option);
+            return false;
+        }
+    }
+    return config.addresses > 0 && config.ports > 0;
+}
+
+int main(int argc, char* argv[])
+{
+    FleetConfig config;
+    if (!configure(argc, argv, config))
+    {
+        usage(argv[0]);
+        return 1;
+    }
+
+    FleetSimulator fleet(config);
+    if (!fleet.open())
+    {
+        return 1;
+    }
+
+    auto prevIntH = std::signal(SIGINT, signalHandler);
+    auto prevTermH = std::signal(SIGTERM, signalHandler);
+    fleet.run(stopping);
+    (void)std::signal(SIGINT, prevIntH);
+    (void)std::signal(SIGTERM, prevTermH);
+
+    const auto& stats = fleet.getStats();
+    console::info(
+        "connections {} accepted, {} closed | requests {} replies {} dropped {} "
+        "hung up {} bad {} | {} bytes in, {} bytes out",
+        stats.accepted, stats.closed, stats.requests, stats.replies, stats.dropped,
+        stats.disconnects, stats.badFrames, stats.bytesIn, stats.bytesOut
+    );
+    return 0;
+}
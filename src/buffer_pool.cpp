@@ -0,0 +1,139 @@
+#include "buffer_pool.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+
+BufferPool::Lease::Lease(
+    BufferPool* useOwner, std::unique_ptr<uint8_t[]> useBlock, size_t useSize
+)
+    : owner(useOwner)
+    , block(std::move(useBlock))
+    , capacity(useSize)
+{
+}
+
+BufferPool::Lease::~Lease() { reset(); }
+
+BufferPool::Lease::Lease(Lease&& other) noexcept
+    : owner(std::exchange(other.owner, nullptr))
+    , block(std::move(other.block))
+    , capacity(std::exchange(other.capacity, 0))
+{
+}
+
+auto BufferPool::Lease::operator=(Lease&& other) noexcept -> Lease&
+{
+    if (this != &other)
+    {
+        reset();
+        owner = std::exchange(other.owner, nullptr);
+        block = std::move(other.block);
+        capacity = std::exchange(other.capacity, 0);
+    }
+    return *this;
+}
+
+auto BufferPool::Lease::data() const -> uint8_t* { return block.get(); }
+
+auto BufferPool::Lease::size() const -> size_t { return capacity; }
+
+auto BufferPool::Lease::bytes() const -> std::span<uint8_t>
+{
+    return { block.get(), capacity };
+}
+
+BufferPool::Lease::operator bool() const { return block != nullptr; }
+
+void BufferPool::Lease::reset()
+{
+    if (owner != nullptr && block != nullptr)
+    {
+        owner->giveBack(std::move(block), capacity);
+    }
+    owner = nullptr;
+    block.reset();
+    capacity = 0;
+}
+
+BufferPool::BufferPool(BufferPoolConfig useConfig) { configure(std::move(useConfig)); }
+
+auto BufferPool::local() -> BufferPool&
+{
+    thread_local BufferPool pool;
+    return pool;
+}
+
+auto BufferPool::getConfig() const -> const BufferPoolConfig& { return config; }
+
+auto BufferPool::outstanding() const -> size_t { return leased; }
+
+auto BufferPool::idleBytes() const -> size_t
+{
+    size_t total = 0;
+    for (size_t index = 0; index < idle.size(); index++)
+    {
+        total += idle[index].size() * config.sizes[index];
+    }
+    return total;
+}
+
+auto BufferPool::lease(size_t size) -> Lease
+{
+    leased++;
+    const auto found = std::ranges::lower_bound(config.sizes, size);
+    if (found == config.sizes.end())
+    {
+        // larger than any class, served but never cached
+        return { this, std::make_unique_for_overwrite<uint8_t[]>(size), size };
+    }
+
+    const auto index = static_cast<size_t>(found - config.sizes.begin());
+    auto& spare = idle[index];
+    if (spare.empty())
+    {
+        return { this, std::make_unique_for_overwrite<uint8_t[]>(*found), *found };
+    }
+
+    auto block = std::move(spare.back());
+    spare.pop_back();
+    return { this, std::move(block), *found };
+}
+
+void BufferPool::giveBack(std::unique_ptr<uint8_t[]> block, size_t size)
+{
+    leased--;
+    const auto found = std::ranges::find(config.sizes, size);
+    if (found == config.sizes.end())
+    {
+        return;
+    }
+
+    auto& spare = idle[static_cast<size_t>(found - config.sizes.begin())];
+    if (spare.size() < config.keep)
+    {
+        spare.push_back(std::move(block));
+    }
+}
+
+void BufferPool::configure(BufferPoolConfig useConfig)
+{
+    // buffers still out return to whichever class matches them, if any is left
+    config = std::move(useConfig);
+    std::ranges::sort(config.sizes);
+    const auto [first, last] = std::ranges::unique(config.sizes);
+    config.sizes.erase(first, last);
+    idle.clear();
+    idle.resize(config.sizes.size());
+}
+
+void BufferPool::trim()
+{
+    for (auto& spare : idle)
+    {
+        spare.clear();
+    }
+}
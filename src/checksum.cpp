@@ -0,0 +1,197 @@
+#include "checksum.h"
+#include "sicp_decoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #define CHECKSUM_X86 1
+  #include <immintrin.h>
+#endif
+
+namespace
+{
+
+using KernelFn = uint8_t (*)(const uint8_t* data, size_t size);
+
+auto foldWord(uint64_t word) -> uint8_t
+{
+    word ^= word >> 32U;
+    word ^= word >> 16U;
+    word ^= word >> 8U;
+    return static_cast<uint8_t>(word);
+}
+
+auto xorScalar(const uint8_t* data, size_t size) -> uint8_t
+{
+    // a word at a time, XOR does not care about lanes
+    uint64_t acc = 0;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t))
+    {
+        uint64_t word = 0;
+        std::memcpy(&word, data + i, sizeof(word));
+        acc ^= word;
+    }
+
+    uint8_t sum = foldWord(acc);
+    for (; i < size; i++)
+    {
+        sum ^= data[i];
+    }
+    return sum;
+}
+
+#ifdef CHECKSUM_X86
+
+__attribute__((target("sse2"))) auto fold128(__m128i acc) -> uint8_t
+{
+    acc = _mm_xor_si128(acc, _mm_srli_si128(acc, 8));
+    uint64_t word = 0;
+    std::memcpy(&word, &acc, sizeof(word));
+    return foldWord(word);
+}
+
+__attribute__((target("sse2"))) auto xorSse2(const uint8_t* data, size_t size) -> uint8_t
+{
+    constexpr size_t LANE = sizeof(__m128i);
+    __m128i left = _mm_setzero_si128();
+    __m128i right = _mm_setzero_si128();
+    size_t i = 0;
+    for (; i + (2 * LANE) <= size; i += 2 * LANE)
+    {
+        left = _mm_xor_si128(
+            left, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i))
+        );
+        right = _mm_xor_si128(
+            right, _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i + LANE))
+        );
+    }
+    return fold128(_mm_xor_si128(left, right)) ^ xorScalar(data + i, size - i);
+}
+
+__attribute__((target("avx2"))) auto xorAvx2(const uint8_t* data, size_t size) -> uint8_t
+{
+    constexpr size_t LANE = sizeof(__m256i);
+    __m256i left = _mm256_setzero_si256();
+    __m256i right = _mm256_setzero_si256();
+    size_t i = 0;
+    for (; i + (2 * LANE) <= size; i += 2 * LANE)
+    {
+        left = _mm256_xor_si256(
+            left, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i))
+        );
+        right = _mm256_xor_si256(
+            right, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + i + LANE))
+        );
+    }
+
+    const __m256i acc = _mm256_xor_si256(left, right);
+    const __m128i half =
+        _mm_xor_si128(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+    return fold128(half) ^ xorSse2(data + i, size - i);
+}
+
+#endif
+
+auto kernelOf(checksum::Kernel kernel) -> KernelFn
+{
+    switch (kernel)
+    {
+#ifdef CHECKSUM_X86
+    case checksum::Kernel::Avx2:
+        return xorAvx2;
+    case checksum::Kernel::Sse2:
+        return xorSse2;
+#endif
+    default:
+        return xorScalar;
+    }
+}
+
+// resolved on first use, so static initializers of other units may checksum too
+auto active() -> KernelFn
+{
+    static const KernelFn best = kernelOf(checksum::bestKernel());
+    return best;
+}
+
+} // anonymous namespace
+
+namespace checksum
+{
+
+auto isSupported(Kernel kernel) -> bool
+{
+    switch (kernel)
+    {
+    case Kernel::Scalar:
+        return true;
+#ifdef CHECKSUM_X86
+    case Kernel::Sse2:
+        return __builtin_cpu_supports("sse2");
+    case Kernel::Avx2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+auto bestKernel() -> Kernel
+{
+    if (isSupported(Kernel::Avx2))
+    {
+        return Kernel::Avx2;
+    }
+    if (isSupported(Kernel::Sse2))
+    {
+        return Kernel::Sse2;
+    }
+    return Kernel::Scalar;
+}
+
+auto compute(std::span<const uint8_t> data) -> uint8_t
+{
+    return active()(data.data(), data.size());
+}
+
+auto compute(std::span<const uint8_t> data, Kernel kernel) -> uint8_t
+{
+    if (!isSupported(kernel))
+    {
+        kernel = Kernel::Scalar;
+    }
+    return kernelOf(kernel)(data.data(), data.size());
+}
+
+auto verifyFrames(std::span<const uint8_t> buffer, std::span<uint8_t> verdicts)
+    -> BatchResult
+{
+    const KernelFn kernel = active();
+    BatchResult result { .frames = 0, .valid = 0, .consumed = 0 };
+    while (result.consumed < buffer.size())
+    {
+        const auto rest = buffer.subspan(result.consumed);
+        const size_t length = rest[0];
+        if (length < sicp::MIN_FRAME || length > rest.size())
+        {
+            break;
+        }
+
+        // a frame including its checksum XORs down to zero
+        const bool good = (kernel(rest.data(), length) == 0);
+        if (result.frames < verdicts.size())
+        {
+            verdicts[result.frames] = good ? 1 : 0;
+        }
+        result.frames++;
+        result.valid += good ? 1 : 0;
+        result.consumed += length;
+    }
+    return result;
+}
+
+} // namespace checksum
@@ -0,0 +1,122 @@
+#include "connect_gate.h"
+#include "session_store.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+
+ConnectGate::ConnectGate()
+    : tokens(1.0)
+    , refilled(Clock::now())
+{
+}
+
+auto ConnectGate::getLimits() const -> const Limits& { return limits; }
+
+auto ConnectGate::isLimited() const -> bool
+{
+    return limits.maxConnecting > 0 || limits.perSecond > 0.0;
+}
+
+auto ConnectGate::isFull(size_t connecting) const -> bool
+{
+    return limits.maxConnecting > 0 && connecting >= limits.maxConnecting;
+}
+
+auto ConnectGate::waiting() const -> size_t { return line.size(); }
+
+auto ConnectGate::front() const -> SessionHandle
+{
+    return line.empty() ? SessionHandle {} : line.front();
+}
+
+auto ConnectGate::untilToken(Clock::time_point now) const -> std::chrono::milliseconds
+{
+    if (limits.perSecond <= 0.0)
+    {
+        return std::chrono::milliseconds(0);
+    }
+
+    const std::chrono::duration<double> elapsed = now - refilled;
+    const double missing = 1.0 - (tokens + elapsed.count() * limits.perSecond);
+    if (missing <= 0.0)
+    {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::milliseconds(
+        static_cast<int64_t>(std::ceil(missing * 1000.0 / limits.perSecond))
+    );
+}
+
+void ConnectGate::configure(Limits useLimits)
+{
+    limits = useLimits;
+    limits.burst = std::max<size_t>(limits.burst, 1);
+    tokens = static_cast<double>(limits.burst);
+    refilled = Clock::now();
+}
+
+auto ConnectGate::tryAdmit(Clock::time_point now, size_t connecting) -> bool
+{
+    if (isFull(connecting))
+    {
+        return false;
+    }
+
+    if (limits.perSecond > 0.0)
+    {
+        refill(now);
+        if (tokens < 1.0)
+        {
+            return false;
+        }
+        tokens -= 1.0;
+    }
+    return true;
+}
+
+auto ConnectGate::enqueue(SessionHandle handle) -> bool
+{
+    if (handle.index >= queued.size())
+    {
+        queued.resize(handle.index + 1, 0);
+    }
+
+    // a stale entry of a removed session in the same slot does not count
+    if (queued[handle.index] == handle.generation)
+    {
+        return false;
+    }
+    queued[handle.index] = handle.generation;
+    line.push_back(handle);
+    return true;
+}
+
+void ConnectGate::pop()
+{
+    if (line.empty())
+    {
+        return;
+    }
+
+    const auto handle = line.front();
+    line.pop_front();
+    if (queued.at(handle.index) == handle.generation)
+    {
+        queued.at(handle.index) = 0;
+    }
+}
+
+void ConnectGate::refill(Clock::time_point now)
+{
+    const std::chrono::duration<double> elapsed = now - refilled;
+    if (elapsed.count() > 0.0)
+    {
+        tokens = std::min(
+            static_cast<double>(limits.burst), tokens + elapsed.count() * limits.perSecond
+        );
+        refilled = now;
+    }
+}
@@ -1,13 +1,22 @@
 #include "console.h"
+#include "spsc_ring.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstddef>
 #include <cstdint>
-#include <iomanip>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <iterator>
+#include <memory>
+#include <mutex>
 #include <span>
-#include <sstream>
 #include <string>
 #include <string_view>
+#include <thread>
+#include <vector>
 
 #ifdef __ANDROID__
   #include <android/log.h>
@@ -16,12 +25,33 @@
 namespace
 {
 constexpr std::string MOD_TAG = "ions";
-}
+constexpr size_t RECORD_TEXT = 496;
+constexpr size_t BATCH_BYTES = 64 * 1024;
 
-namespace console
+using console::Level;
+
+constexpr auto HEX_PAIRS = []()
 {
+    constexpr std::string_view digits { "0123456789abcdef" };
+    std::array<char, 512> table {};
+    for (size_t value = 0; value < 256; value++)
+    {
+        table.at(value * 2) = digits[value >> 4];
+        table.at(value * 2 + 1) = digits[value & 0x0F];
+    }
+    return table;
+}();
 
-void log_message(Level level, std::string_view message)
+auto hexPair(size_t value) -> const char* { return &HEX_PAIRS.at(value * 2); }
+
+struct Record
+{
+    Level level;
+    uint16_t length;
+    std::array<char, RECORD_TEXT> text;
+};
+
+void emit(Level level, std::string_view message)
 {
     const auto ndx = static_cast<size_t>(level);
 
@@ -32,7 +62,9 @@ void log_message(Level level, std::string_view message)
         ANDROID_LOG_WARN,
         ANDROID_LOG_ERROR,
     };
-    __android_log_print(asLogId[ndx], MOD_TAG.data(), "%s", message.data());
+    // logd wants a terminated string, the view may not be one
+    const std::string line { message };
+    __android_log_print(asLogId[ndx], MOD_TAG.data(), "%s", line.c_str());
 #else
     static const std::array<std::string_view, 4> asStr {
         "DEBUG",
@@ -45,17 +77,361 @@ void log_message(Level level, std::string_view message)
 #endif
 }
 
-void buffer(std::string_view name, std::span<const uint8_t> buffer)
+/***
+ * Rings of every thread that logged, drained by one writer that hands the
+ * lines to the sink in batches
+ */
+class AsyncBackend
 {
-    std::ostringstream oss;
-    oss << name << " (" << buffer.size() << " bytes): ";
+  public:
+    using Ring = SpscRing<Record>;
+
+    ~AsyncBackend() { stop(); }
+
+    void start(console::AsyncConfig useConfig)
+    {
+        const std::scoped_lock lock(guard);
+        if (writer.joinable())
+        {
+            return;
+        }
+        config = useConfig;
+        idle.store(false, std::memory_order_release);
+        running.store(true, std::memory_order_release);
+        writer = std::thread([this]() { run(); });
+        accepting.store(true, std::memory_order_release);
+    }
+
+    void stop()
+    {
+        const std::scoped_lock lock(guard);
+        if (!writer.joinable())
+        {
+            return;
+        }
+        accepting.store(false, std::memory_order_seq_cst);
+        // whoever got past the check still pushes, the last pass must find it
+        {
+            const std::scoped_lock ringsLock(ringsGuard);
+            for (const auto& slot : rings)
+            {
+                while (slot.producer->pushing.load(std::memory_order_seq_cst))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        running.store(false, std::memory_order_release);
+        wake();
+        writer.join();
+    }
+
+    auto tryLog(Level level, std::string_view message) -> bool
+    {
+        // synchronous logging never gets to the handshake
+        if (!accepting.load(std::memory_order_relaxed))
+        {
+            return false;
+        }
+
+        // only this thread's own slot is written, stop() scans them all
+        auto& producer = localProducer();
+        producer.pushing.store(true, std::memory_order_seq_cst);
+        if (!accepting.load(std::memory_order_seq_cst))
+        {
+            producer.pushing.store(false, std::memory_order_release);
+            return false;
+        }
+
+        const bool pushed = producer.ring.tryPush([level, message](Record& record)
+        {
+            const size_t length = std::min(message.size(), RECORD_TEXT);
+            record.level = level;
+            record.length = static_cast<uint16_t>(length);
+            std::copy_n(message.begin(), length, record.text.begin());
+        });
+        if (!pushed)
+        {
+            lost.fetch_add(1, std::memory_order_relaxed);
+        }
+        else
+        {
+            // either we see the writer idle or its last look at the rings sees us
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (idle.load(std::memory_order_seq_cst))
+            {
+                wake();
+            }
+        }
+        producer.pushing.store(false, std::memory_order_release);
+        return true;
+    }
+
+    void flush()
+    {
+        while (accepting.load(std::memory_order_acquire) && !drained())
+        {
+            std::this_thread::yield();
+        }
+    }
+
+    [[nodiscard]] auto getDropped() const -> uint64_t
+    {
+        return lost.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Producer
+    {
+        explicit Producer(size_t capacity)
+            : ring(capacity)
+        {
+        }
+
+        Ring ring;
+        alignas(64) std::atomic<bool> pushing { false }; // between the check and the push
+    };
+
+    struct Slot
+    {
+        std::shared_ptr<Producer> producer;
+        std::weak_ptr<void> owner; // expires once the logging thread is gone
+    };
+
+    auto localProducer() -> Producer&
+    {
+        // the slot keeps the ring until drained, only the thread holds its token
+        thread_local std::shared_ptr<Producer> mine;
+        thread_local std::shared_ptr<void> token;
+        if (!mine)
+        {
+            const std::scoped_lock lock(ringsGuard);
+            mine = std::make_shared<Producer>(config.capacity);
+            token = std::make_shared<bool>(true);
+            rings.push_back(Slot { .producer = mine, .owner = token });
+        }
+        return *mine;
+    }
+
+    void wake()
+    {
+        signal.fetch_add(1, std::memory_order_release);
+        signal.notify_one();
+    }
+
+    [[nodiscard]] auto pending() -> bool
+    {
+        const std::scoped_lock lock(ringsGuard);
+        return std::ranges::any_of(rings, [](const Slot& slot)
+        { return !slot.producer->ring.empty(); });
+    }
+
+    [[nodiscard]] auto drained() -> bool
+    {
+        // empty rings first, the writer only goes idle after writing what it took
+        return !pending() && idle.load(std::memory_order_seq_cst);
+    }
+
+    auto collect(std::vector<std::shared_ptr<Producer>>& active) -> size_t
+    {
+        {
+            const std::scoped_lock lock(ringsGuard);
+            std::erase_if(rings, [](const Slot& slot)
+            { return slot.owner.expired() && slot.producer->ring.empty(); });
+            active.clear();
+            for (const auto& slot : rings)
+            {
+                active.push_back(slot.producer);
+            }
+        }
 
-    for (const auto& value : buffer)
+        size_t taken = 0;
+        for (const auto& producer : active)
+        {
+            auto& ring = producer->ring;
+            while (batch.size() < BATCH_BYTES && ring.tryPop([this](const Record& record)
+            { append(record.level, { record.text.data(), record.length }); }))
+            {
+                taken++;
+            }
+        }
+        return taken;
+    }
+
+    void append(Level level, std::string_view message)
+    {
+#ifdef __ANDROID__
+        emit(level, message);
+#else
+        static const std::array<std::string_view, 4> asStr {
+            "DEBUG",
+            "INFO",
+            "WARNING",
+            "ERROR",
+        };
+        std::format_to(
+            std::back_inserter(batch), "[{}] {}\n", asStr.at(static_cast<size_t>(level)),
+            message
+        );
+#endif
+    }
+
+    void write()
+    {
+        const uint64_t missing = lost.load(std::memory_order_relaxed);
+        if (config.overflow == console::Overflow::Count && missing > reported)
+        {
+            append(
+                Level::WARNING, std::format("{} log messages dropped.", missing - reported)
+            );
+            reported = missing;
+        }
+
+        if (!batch.empty())
+        {
+            std::cout.write(batch.data(), static_cast<std::streamsize>(batch.size()));
+            std::cout.flush();
+            batch.clear();
+        }
+    }
+
+    void run()
+    {
+        std::vector<std::shared_ptr<Producer>> active;
+        batch.reserve(BATCH_BYTES);
+        while (true)
+        {
+            const uint64_t seen = signal.load(std::memory_order_acquire);
+            while (collect(active) > 0)
+            {
+                write();
+            }
+            write();
+
+            if (!running.load(std::memory_order_acquire))
+            {
+                break;
+            }
+
+            idle.store(true, std::memory_order_seq_cst);
+            if (!pending())
+            {
+                signal.wait(seen, std::memory_order_acquire);
+            }
+            idle.store(false, std::memory_order_seq_cst);
+        }
+        idle.store(true, std::memory_order_release);
+    }
+
+    std::mutex guard;
+    std::mutex ringsGuard;
+    std::vector<Slot> rings;
+    console::AsyncConfig config;
+    std::thread writer;
+    std::atomic<bool> running { false };
+    std::atomic<bool> accepting { false };
+    std::atomic<bool> idle { true };
+    std::atomic<uint64_t> signal { 0 };
+    std::atomic<uint64_t> lost { 0 };
+    uint64_t reported = 0;
+    std::string batch;
+};
+
+auto backend() -> AsyncBackend&
+{
+    static AsyncBackend instance;
+    return instance;
+}
+
+} // anonymous namespace
+
+namespace console
+{
+
+void log_message(Level level, std::string_view message)
+{
+    if (!backend().tryLog(level, message))
+    {
+        emit(level, message);
+    }
+}
+
+void startAsync(AsyncConfig config) { backend().start(config); }
+
+void stopAsync() { backend().stop(); }
+
+void flush() { backend().flush(); }
+
+auto dropped() -> uint64_t { return backend().getDropped(); }
+
+void hexDump(
+    std::string& out, std::span<const uint8_t> bytes, const HexLayout& layout
+)
+{
+    const size_t shown = (layout.limit > 0) ? std::min(layout.limit, bytes.size())
+                                            : bytes.size();
+    const size_t perLine =
+        (layout.perLine > 0) ? layout.perLine : std::max<size_t>(shown, 1);
+    out.reserve(out.size() + shown * (layout.ascii ? 4 : 3) + (shown / perLine + 1) * 12);
+
+    for (size_t start = 0; start < shown; start += perLine)
+    {
+        const size_t end = std::min(start + perLine, shown);
+        if (layout.perLine > 0)
+        {
+            const auto offset = static_cast<uint32_t>(start);
+            out += '\n';
+            for (int shift = 24; shift >= 0; shift -= 8)
+            {
+                out.append(hexPair((offset >> shift) & 0xFFU), 2);
+            }
+            out += ": ";
+        }
+
+        // three characters per byte, written straight from the table
+        const size_t at = out.size();
+        out.resize(at + (end - start) * 3);
+        char* cursor = out.data() + at;
+        for (size_t i = start; i < end; i++)
+        {
+            std::memcpy(cursor, hexPair(bytes[i]), 2);
+            cursor[2] = ' ';
+            cursor += 3;
+        }
+
+        if (layout.ascii)
+        {
+            out.append((perLine - (end - start)) * 3, ' ');
+            out += '|';
+            for (size_t i = start; i < end; i++)
+            {
+                out += (bytes[i] >= 0x20 && bytes[i] < 0x7F) ? static_cast<char>(bytes[i])
+                                                             : '.';
+            }
+            out += '|';
+        }
+    }
+
+    if (shown < bytes.size())
+    {
+        std::format_to(std::back_inserter(out), "... ({} more)", bytes.size() - shown);
+    }
+}
+
+void buffer(
+    std::string_view name, std::span<const uint8_t> buffer, const HexLayout& layout
+)
+{
+    if (!enabled(Level::DEBUG))
     {
-        oss << std::hex << std::setw(2) << std::setfill('0') << static_cast<int>(value)
-            << " ";
+        return;
     }
 
-    log_message(Level::DEBUG, oss.str());
+    // reused between dumps, wire tracing would otherwise allocate on every read
+    thread_local std::string line;
+    line.clear();
+    std::format_to(std::back_inserter(line), "{} ({} bytes): ", name, buffer.size());
+    hexDump(line, buffer, layout);
+    log_message(Level::DEBUG, line);
 }
 } // namespace console
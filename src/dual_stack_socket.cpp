@@ -0,0 +1,299 @@
+#include "dual_stack_socket.h"
+#include "console.h"
+#include "easy_socket.h"
+#include "ioi.h"
+#include "reactor.h"
+#include "resolver.h"
+#include "sticky_socket.h"
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <netinet/in.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+
+DualStackSocket::DualStackSocket(
+    const IoIntf& useIo,
+    std::string host,
+    uint16_t port,
+    size_t retries
+)
+    : StickySocket(useIo, std::move(host), port, retries)
+    , nextCandidate(0)
+    , attemptTimer([this]() { stagger(); })
+    , probeTimer([this]() { probe(); })
+    , probeEvery(PROBE_INTERVAL)
+    , probeUntil {}
+{
+    CONSOLE_TRACE(this->host);
+}
+
+DualStackSocket::~DualStackSocket()
+{
+    for (const int fd : parked)
+    {
+        getIo().close(fd);
+    }
+}
+
+auto DualStackSocket::getCandidates() const -> const std::vector<SocketAddress>&
+{
+    return candidates;
+}
+
+auto DualStackSocket::racing() const -> size_t { return parked.size(); }
+
+void DualStackSocket::useAddresses(const Resolver::Resolution& resolution)
+{
+    std::vector<SocketAddress> ipv6;
+    std::vector<SocketAddress> ipv4;
+    for (const auto& address : resolution.addresses)
+    {
+        if (address.family() == AF_INET6)
+        {
+            ipv6.push_back(address);
+        }
+        else if (address.family() == AF_INET)
+        {
+            ipv4.push_back(address);
+        }
+    }
+    if (ipv6.empty() && ipv4.empty())
+    {
+        return;
+    }
+
+    // families take turns, IPv6 first (RFC 8305)
+    candidates.clear();
+    for (size_t i = 0; i < std::max(ipv6.size(), ipv4.size()); i++)
+    {
+        if (i < ipv6.size())
+        {
+            candidates.push_back(ipv6[i]);
+        }
+        if (i < ipv4.size())
+        {
+            candidates.push_back(ipv4[i]);
+        }
+    }
+    useAddress(candidates.front(), resolution.expires);
+}
+
+auto DualStackSocket::enter(ConnectionState newState) -> bool
+{
+    // a failed attempt is no failure while another one can take over
+    if (newState == ConnectionState::Disconnected &&
+        state == ConnectionState::Connecting && failOver())
+    {
+        return false;
+    }
+
+    if (newState != ConnectionState::Connecting)
+    {
+        dropRace();
+    }
+    if (!StickySocket::enter(newState))
+    {
+        return false;
+    }
+
+    if (newState == ConnectionState::Connecting)
+    {
+        rearm();
+    }
+    return true;
+}
+
+void DualStackSocket::disconnect()
+{
+    dropRace();
+    StickySocket::disconnect();
+}
+
+auto DualStackSocket::openAttempt() -> int
+{
+    if (candidates.empty())
+    {
+        return StickySocket::openAttempt();
+    }
+
+    nextCandidate = 0;
+    return launchNext();
+}
+
+void DualStackSocket::stagger()
+{
+    if (state != ConnectionState::Connecting || harvest())
+    {
+        return;
+    }
+
+    const int fd = launchNext();
+    if (fd != INVALID_SOCKET)
+    {
+        parked.push_back(swapTo(fd));
+        console::debug("{} still connecting, racing attempt {}", host, nextCandidate);
+    }
+    rearm();
+}
+
+void DualStackSocket::probe()
+{
+    // a parked family that connects first should not wait for the next attempt delay
+    if (state != ConnectionState::Connecting || harvest() || parked.empty())
+    {
+        return;
+    }
+
+    // black-holed attempts would be probed until the connect times out, back off
+    // and leave them to the next attempt delay or a fail-over once the window closes
+    const auto now = Timer::Clock::now();
+    probeEvery = std::min(probeEvery * 2, ATTEMPT_DELAY);
+    auto* reactor = getReactor();
+    if (reactor && now + probeEvery <= probeUntil)
+    {
+        reactor->schedule(probeTimer, now + probeEvery);
+    }
+}
+
+auto DualStackSocket::launchNext() -> int
+{
+    // an attempt that fails on the spot, say without a route, hands over right away
+    while (nextCandidate < candidates.size())
+    {
+        const int fd = openTo(candidates.at(nextCandidate++));
+        if (fd != INVALID_SOCKET)
+        {
+            return fd;
+        }
+    }
+    return INVALID_SOCKET;
+}
+
+auto DualStackSocket::failOver() -> bool
+{
+    int fd = launchNext();
+    if (fd == INVALID_SOCKET && !parked.empty())
+    {
+        fd = parked.front();
+        parked.erase(parked.begin());
+    }
+    if (fd == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    getIo().close(swapTo(fd));
+    rearm();
+    return true;
+}
+
+auto DualStackSocket::harvest() -> bool
+{
+    if (parked.empty())
+    {
+        return false;
+    }
+
+    std::vector<struct pollfd> probes;
+    probes.reserve(parked.size());
+    for (const int fd : parked)
+    {
+        probes.push_back(pollfd { .fd = fd, .events = POLLOUT, .revents = 0 });
+    }
+    if (getIo().poll(probes.data(), probes.size(), 0) <= 0)
+    {
+        return false;
+    }
+
+    int winner = INVALID_SOCKET;
+    for (const auto& probe : probes)
+    {
+        if (probe.revents == 0)
+        {
+            continue;
+        }
+
+        int error = 0;
+        socklen_t length = sizeof(error);
+        const bool failed = (probe.revents & (POLLERR | POLLHUP | POLLNVAL)) ||
+                            getIo().getsockopt(
+                                probe.fd, SOL_SOCKET, SO_ERROR, &error, &length
+                            ) != 0 ||
+                            error != 0;
+        std::erase(parked, probe.fd);
+        if (failed || winner != INVALID_SOCKET)
+        {
+            getIo().close(probe.fd);
+            continue;
+        }
+        winner = probe.fd;
+    }
+    if (winner == INVALID_SOCKET)
+    {
+        return false;
+    }
+
+    getIo().close(swapTo(winner));
+    enter(ConnectionState::Connected);
+    return true;
+}
+
+auto DualStackSocket::swapTo(int fd) -> int
+{
+    // the reactor watches one descriptor per socket, the new attempt takes its place
+    auto* reactor = getReactor();
+    if (reactor)
+    {
+        reactor->forget(*this);
+    }
+    const int previous = std::exchange(descriptor, fd);
+    if (reactor)
+    {
+        reactor->watch(*this);
+    }
+    return previous;
+}
+
+void DualStackSocket::rearm()
+{
+    auto* reactor = getReactor();
+    if (reactor == nullptr)
+    {
+        return;
+    }
+
+    const auto now = Timer::Clock::now();
+    if (nextCandidate < candidates.size())
+    {
+        reactor->schedule(attemptTimer, now + ATTEMPT_DELAY);
+    }
+    if (!parked.empty())
+    {
+        // every newly parked attempt gets quick probes again
+        probeEvery = PROBE_INTERVAL;
+        probeUntil = now + PROBE_WINDOW;
+        reactor->schedule(probeTimer, now + probeEvery);
+    }
+}
+
+void DualStackSocket::dropRace()
+{
+    if (auto* reactor = getReactor())
+    {
+        reactor->cancel(attemptTimer);
+        reactor->cancel(probeTimer);
+    }
+    for (const int fd : parked)
+    {
+        getIo().close(fd);
+    }
+    parked.clear();
+    nextCandidate = candidates.size();
+}
@@ -34,6 +34,8 @@ auto EasySocketIntf::getStatus() const -> const std::string&
 
 auto EasySocketIntf::getHost() const -> const std::string& { return host; }
 
+auto EasySocketIntf::getPort() const -> uint16_t { return port; }
+
 auto EasySocketIntf::isOnline() const -> bool
 {
     return state == ConnectionState::Connected;
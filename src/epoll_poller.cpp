@@ -0,0 +1,120 @@
+#include "epoll_poller.h"
+#include "console.h"
+#include "easy_socket.h"
+#include "ioi.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+
+#include <sys/epoll.h>
+
+EpollPoller::EpollPoller(const IoIntf& useIo)
+    : io(useIo)
+    , descriptor(io.epoll_create1(EPOLL_CLOEXEC))
+    , events(MAX_EVENTS)
+{
+    if (descriptor < 0)
+    {
+        console::error("Cannot create epoll instance, reason: {}", strerror(errno));
+    }
+}
+
+EpollPoller::~EpollPoller()
+{
+    if (descriptor >= 0)
+    {
+        io.close(descriptor);
+    }
+}
+
+void EpollPoller::watch(EasySocketIntf& skt)
+{
+    const int fd = skt.getDescriptor();
+    if (fd == EasySocketIntf::INVALID_SOCKET)
+    {
+        return;
+    }
+
+    struct epoll_event event {
+        .events = static_cast<uint32_t>(skt.interest()), .data = { .ptr = &skt },
+    };
+
+    int op = EPOLL_CTL_ADD;
+    auto found = registered.find(&skt);
+    if (found != registered.end())
+    {
+        if (found->second == fd)
+        {
+            op = EPOLL_CTL_MOD;
+        }
+        else
+        {
+            // socket was reopened, the stale descriptor goes away on its own
+            io.epoll_ctl(descriptor, EPOLL_CTL_DEL, found->second, nullptr);
+        }
+    }
+
+    int err = io.epoll_ctl(descriptor, op, fd, &event);
+    if (err < 0 && op == EPOLL_CTL_MOD && errno == ENOENT)
+    {
+        // a recycled descriptor number, the kernel already dropped the old one
+        err = io.epoll_ctl(descriptor, EPOLL_CTL_ADD, fd, &event);
+    }
+
+    if (err < 0)
+    {
+        console::error("Cannot watch descriptor {}, reason: {}", fd, strerror(errno));
+        registered.erase(&skt);
+        return;
+    }
+    registered[&skt] = fd;
+}
+
+void EpollPoller::forget(EasySocketIntf& skt)
+{
+    auto found = registered.find(&skt);
+    if (found == registered.end())
+    {
+        return;
+    }
+
+    io.epoll_ctl(descriptor, EPOLL_CTL_DEL, found->second, nullptr);
+    registered.erase(found);
+}
+
+void EpollPoller::wakeOn(int fd)
+{
+    struct epoll_event event {
+        .events = EPOLLIN, .data = { .ptr = nullptr },
+    };
+    if (io.epoll_ctl(descriptor, EPOLL_CTL_ADD, fd, &event) < 0)
+    {
+        console::error("Cannot watch wakeup {}, reason: {}", fd, strerror(errno));
+    }
+}
+
+auto EpollPoller::wait(std::vector<Readiness>& ready, int timeout) -> int
+{
+    ready.clear();
+    int count =
+        io.epoll_wait(descriptor, events.data(), static_cast<int>(events.size()), timeout);
+
+    for (int i = 0; i < count; i++)
+    {
+        const auto& event = events.at(i);
+        ready.push_back(Readiness {
+            .socket = static_cast<EasySocketIntf*>(event.data.ptr),
+            .revents = static_cast<short>(event.events),
+            .data = {},
+            .sent = {},
+        });
+    }
+    return count;
+}
+
+auto EpollPoller::transmit(EasySocketIntf&, const std::deque<FrameRef>&, size_t) -> bool
+{
+    // readiness only, the socket writes once EPOLLOUT says so
+    return false;
+}
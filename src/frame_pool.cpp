@@ -0,0 +1,92 @@
+#include "frame_pool.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+FramePool::~FramePool()
+{
+    for (size_t index = 0; index < CLASSES; index++)
+    {
+        auto& list = lists.at(index);
+        while (list.head != nullptr)
+        {
+            FreeBlock* block = list.head;
+            list.head = block->next;
+            ::operator delete(block, MIN_BLOCK << index);
+        }
+    }
+}
+
+auto FramePool::local() -> FramePool&
+{
+    thread_local FramePool pool;
+    return pool;
+}
+
+auto FramePool::classOf(size_t size) -> size_t
+{
+    const size_t rounded = std::bit_ceil(std::max(size, MIN_BLOCK));
+    return static_cast<size_t>(std::countr_zero(rounded) - std::countr_zero(MIN_BLOCK));
+}
+
+auto FramePool::allocate(size_t size) -> void*
+{
+    const size_t index = classOf(size);
+    if (index >= CLASSES)
+    {
+        misses++;
+        return ::operator new(size);
+    }
+
+    auto& list = lists.at(index);
+    if (list.head == nullptr)
+    {
+        misses++;
+        return ::operator new(MIN_BLOCK << index);
+    }
+
+    hits++;
+    FreeBlock* block = list.head;
+    list.head = block->next;
+    list.count--;
+    return block;
+}
+
+void FramePool::release(void* block, size_t size)
+{
+    const size_t index = classOf(size);
+    if (index >= CLASSES)
+    {
+        ::operator delete(block, size);
+        return;
+    }
+
+    auto& list = lists.at(index);
+    if (list.count >= MAX_CACHED)
+    {
+        ::operator delete(block, MIN_BLOCK << index);
+        return;
+    }
+
+    // frames may finish on another thread than they started, they just move pools
+    auto* node = ::new (block) FreeBlock { .next = list.head };
+    list.head = node;
+    list.count++;
+}
+
+auto FramePool::getHits() const -> uint64_t { return hits; }
+
+auto FramePool::getMisses() const -> uint64_t { return misses; }
+
+auto FramePool::cached() const -> size_t
+{
+    size_t total = 0;
+    for (const auto& list : lists)
+    {
+        total += list.count;
+    }
+    return total;
+}
@@ -0,0 +1,124 @@
+#include "hot_state.h"
+#include "sticky_socket.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace
+{
+
+template <typename T> void moveLast(std::vector<T>& column, size_t row)
+{
+    column.at(row) = column.back();
+    column.pop_back();
+}
+
+} // anonymous namespace
+
+auto HotState::size() const -> size_t { return states.size(); }
+
+auto HotState::descriptorAt(size_t row) const -> int { return descriptors.at(row); }
+
+auto HotState::stateAt(size_t row) const -> State { return states.at(row); }
+
+auto HotState::interestAt(size_t row) const -> short { return interests.at(row); }
+
+auto HotState::deadlineAt(size_t row) const -> Clock::time_point
+{
+    return deadlines.at(row);
+}
+
+auto HotState::attemptsAt(size_t row) const -> size_t { return attempts.at(row); }
+
+auto HotState::hasPendingOutput(size_t row) const -> bool
+{
+    return pendingOutput.at(row) != 0;
+}
+
+auto HotState::dueForReconnect(Clock::time_point now, std::vector<size_t>& rows) const
+    -> size_t
+{
+    rows.clear();
+    for (size_t row = 0; row < states.size(); row++)
+    {
+        if (states[row] == State::Disconnected && deadlines[row] <= now)
+        {
+            rows.push_back(row);
+        }
+    }
+    return rows.size();
+}
+
+auto HotState::withPendingOutput(std::vector<size_t>& rows) const -> size_t
+{
+    rows.clear();
+    for (size_t row = 0; row < pendingOutput.size(); row++)
+    {
+        if (pendingOutput[row] != 0)
+        {
+            rows.push_back(row);
+        }
+    }
+    return rows.size();
+}
+
+auto HotState::count(State wanted) const -> size_t
+{
+    return static_cast<size_t>(std::ranges::count(states, wanted));
+}
+
+auto HotState::connecting() const -> size_t { return connectingRows; }
+
+void HotState::append(const StickySocket& skt)
+{
+    descriptors.push_back(0);
+    states.push_back(State::Disconnected);
+    interests.push_back(0);
+    deadlines.emplace_back();
+    attempts.push_back(0);
+    pendingOutput.push_back(0);
+    update(states.size() - 1, skt);
+}
+
+void HotState::update(size_t row, const StickySocket& skt)
+{
+    constexpr size_t MAX_ATTEMPTS = std::numeric_limits<uint16_t>::max();
+
+    const State last = states.at(row);
+    descriptors.at(row) = skt.getDescriptor();
+    states.at(row) = skt.getState();
+    if (last != states[row])
+    {
+        connectingRows += (states[row] == State::Connecting) ? 1 : 0;
+        connectingRows -= (last == State::Connecting) ? 1 : 0;
+    }
+    interests.at(row) = skt.interest();
+    deadlines.at(row) = skt.getNextAttempt();
+    attempts.at(row) = static_cast<uint16_t>(std::min(skt.getAttempts(), MAX_ATTEMPTS));
+    pendingOutput.at(row) = skt.pendingBytes() > 0 ? 1 : 0;
+}
+
+void HotState::removeAt(size_t row)
+{
+    connectingRows -= (states.at(row) == State::Connecting) ? 1 : 0;
+    moveLast(descriptors, row);
+    moveLast(states, row);
+    moveLast(interests, row);
+    moveLast(deadlines, row);
+    moveLast(attempts, row);
+    moveLast(pendingOutput, row);
+}
+
+void HotState::clear()
+{
+    descriptors.clear();
+    states.clear();
+    interests.clear();
+    deadlines.clear();
+    attempts.clear();
+    pendingOutput.clear();
+    connectingRows = 0;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+struct BufferPoolConfig
+{
+    std::vector<size_t> sizes { 512, 4096, 16384 }; // ascending size classes
+    size_t keep = 64;                                // idle buffers kept per class
+};
+
+/***
+ * Receive buffers handed out only while a read is in progress, so memory grows
+ * with traffic instead of with the number of displays
+ */
+class BufferPool
+{
+  public:
+    /***
+     * Owns a buffer until it goes out of scope, then hands it back to the pool
+     */
+    class Lease
+    {
+      public:
+        Lease() = default;
+        ~Lease();
+        Lease(Lease&& other) noexcept;
+        Lease& operator=(Lease&& other) noexcept;
+
+        // bad luck
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        // inspectors
+        [[nodiscard]] auto data() const -> uint8_t*;
+        [[nodiscard]] auto size() const -> size_t;
+        [[nodiscard]] auto bytes() const -> std::span<uint8_t>;
+        explicit operator bool() const;
+
+        // actions
+        void reset();
+
+      private:
+        friend class BufferPool;
+        Lease(BufferPool* useOwner, std::unique_ptr<uint8_t[]> useBlock, size_t useSize);
+
+        BufferPool* owner = nullptr;
+        std::unique_ptr<uint8_t[]> block; // NOLINT(*-avoid-c-arrays)
+        size_t capacity = 0;
+    };
+
+    explicit BufferPool(BufferPoolConfig useConfig = {});
+
+    // bad luck
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+    BufferPool(BufferPool&&) = delete;
+    BufferPool& operator=(BufferPool&&) = delete;
+
+    static auto local() -> BufferPool&; // one per loop thread
+
+    // inspectors
+    [[nodiscard]] auto getConfig() const -> const BufferPoolConfig&;
+    [[nodiscard]] auto outstanding() const -> size_t;
+    [[nodiscard]] auto idleBytes() const -> size_t;
+
+    // actions
+    auto lease(size_t size) -> Lease;
+    void configure(BufferPoolConfig useConfig);
+    void trim();
+
+  private:
+    // NOLINTNEXTLINE(*-avoid-c-arrays)
+    void giveBack(std::unique_ptr<uint8_t[]> block, size_t size);
+
+    BufferPoolConfig config;
+    std::vector<std::vector<std::unique_ptr<uint8_t[]>>> idle; // NOLINT(*-avoid-c-arrays)
+    size_t leased = 0;
+};
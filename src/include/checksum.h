@@ -0,0 +1,35 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+/***
+ * XOR-of-all-bytes checksum used by SICP, vector kernels are picked once at
+ * startup from what the CPU supports
+ */
+namespace checksum
+{
+enum class Kernel : uint8_t
+{
+    Scalar,
+    Sse2,
+    Avx2,
+};
+
+struct BatchResult
+{
+    size_t frames;   // complete frames walked
+    size_t valid;    // of which carried a matching checksum
+    size_t consumed; // bytes covered by those frames
+};
+
+auto isSupported(Kernel kernel) -> bool;
+auto bestKernel() -> Kernel;
+auto compute(std::span<const uint8_t> data) -> uint8_t;
+auto compute(std::span<const uint8_t> data, Kernel kernel) -> uint8_t;
+
+// walks length prefixed frames laid out back to back, verdicts[i] is 1 for a good frame
+auto verifyFrames(std::span<const uint8_t> buffer, std::span<uint8_t> verdicts = {})
+    -> BatchResult;
+} // namespace checksum
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "session_store.h"
+#include "timer_wheel.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+/***
+ * Admission control for connects. A token bucket paces how many attempts start
+ * per second and a cap bounds how many are in flight at once, so a fleet that
+ * dropped together does not come back as one wave of SYNs. Whoever is turned
+ * away waits in line and gets its turn in order
+ */
+class ConnectGate
+{
+  public:
+    using Clock = Timer::Clock;
+
+    struct Limits
+    {
+        size_t maxConnecting = 0; // attempts in flight at once, 0 leaves it open
+        double perSecond = 0.0;   // attempts started per second, 0 leaves it open
+        size_t burst = 1;         // attempts a full bucket lets through back to back
+    };
+
+    ConnectGate();
+
+    // inspectors
+    [[nodiscard]] auto getLimits() const -> const Limits&;
+    [[nodiscard]] auto isLimited() const -> bool;
+    [[nodiscard]] auto isFull(size_t connecting) const -> bool;
+    [[nodiscard]] auto waiting() const -> size_t;
+    [[nodiscard]] auto front() const -> SessionHandle;
+    [[nodiscard]] auto untilToken(Clock::time_point now) const
+        -> std::chrono::milliseconds;
+
+    // actions
+    void configure(Limits useLimits);
+    auto tryAdmit(Clock::time_point now, size_t connecting) -> bool; // spends a token
+    auto enqueue(SessionHandle handle) -> bool; // false when it waits already
+    void pop();
+
+  private:
+    void refill(Clock::time_point now);
+
+    Limits limits;
+    double tokens;
+    Clock::time_point refilled;
+    std::deque<SessionHandle> line;
+    std::vector<uint32_t> queued; // generation in line, by slot index
+};
@@ -1,9 +1,13 @@
 #pragma once
 
+#include <atomic>
+#include <cstddef>
 #include <cstdint>
 #include <format>
 #include <span>
+#include <string>
 #include <string_view>
+#include <utility>
 
 namespace console
 {
@@ -16,36 +20,99 @@ enum class Level : uint8_t
     ERROR
 };
 
+enum class Overflow : uint8_t
+{
+    Drop,  // full ring loses the message quietly
+    Count, // full ring loses the message, the writer reports how many went missing
+};
+
+struct AsyncConfig
+{
+    size_t capacity = 1024; // records per logging thread
+    Overflow overflow = Overflow::Count;
+};
+
+struct HexLayout
+{
+    size_t perLine = 0; // bytes per line, 0 keeps the dump on one line
+    bool ascii = false; // printable characters after each line
+    size_t limit = 0;   // bytes shown at most, 0 shows them all
+};
+
 void log_message(Level level, std::string_view message);
-void buffer(std::string_view name, std::span<const uint8_t> buffer);
+void hexDump(
+    std::string& out, std::span<const uint8_t> bytes, const HexLayout& layout = {}
+);
+void buffer(
+    std::string_view name, std::span<const uint8_t> buffer, const HexLayout& layout = {}
+);
+
+// messages go to a per thread ring and a background writer until stopped
+void startAsync(AsyncConfig config = {});
+void stopAsync();
+void flush();
+auto dropped() -> uint64_t;
+
+// calls below the build's minimum level compile to nothing, arguments included
+#ifndef CONSOLE_MIN_LEVEL
+  #ifdef NDEBUG
+    #define CONSOLE_MIN_LEVEL 1
+  #else
+    #define CONSOLE_MIN_LEVEL 0
+  #endif
+#endif
+
+constexpr Level MIN_LEVEL = static_cast<Level>(CONSOLE_MIN_LEVEL);
 
 #ifdef NDEBUG
-  #define CONSOLE_TRACE() ((void)0)
+  #define CONSOLE_TRACE(...) ((void)0)
 #else
   #define CONSOLE_TRACE(...) console::debug("{}({})", __PRETTY_FUNCTION__, __VA_ARGS__)
 #endif
 
-// NOLINTBEGIN(cppcoreguidelines-missing-std-forward)
-template <typename... Args> void debug(std::string_view format, Args&&... args)
+// runtime threshold, checked before anything gets formatted
+inline std::atomic<Level> threshold { MIN_LEVEL };
+
+inline void setLevel(Level level) { threshold.store(level, std::memory_order_relaxed); }
+
+inline auto getLevel() -> Level { return threshold.load(std::memory_order_relaxed); }
+
+inline auto enabled(Level level) -> bool
 {
-    log_message(Level::DEBUG, std::vformat(format, (std::make_format_args(args...))));
+    return level >= MIN_LEVEL && level >= threshold.load(std::memory_order_relaxed);
 }
 
-template <typename... Args> void info(std::string_view format, Args&&... args)
+template <Level level, typename... Args>
+void log(std::format_string<Args...> format, Args&&... args)
 {
-    log_message(Level::INFO, std::vformat(format, (std::make_format_args(args...))));
+    if constexpr (level >= MIN_LEVEL)
+    {
+        if (enabled(level))
+        {
+            log_message(level, std::format(format, std::forward<Args>(args)...));
+        }
+    }
 }
 
-template <typename... Args> void warning(std::string_view format, Args&&... args)
+template <typename... Args> void debug(std::format_string<Args...> format, Args&&... args)
 {
-    log_message(Level::WARNING, std::vformat(format, (std::make_format_args(args...))));
+    log<Level::DEBUG>(format, std::forward<Args>(args)...);
 }
 
-template <typename... Args> void error(std::string_view format, Args&&... args)
+template <typename... Args> void info(std::format_string<Args...> format, Args&&... args)
 {
-    log_message(Level::ERROR, std::vformat(format, (std::make_format_args(args...))));
+    log<Level::INFO>(format, std::forward<Args>(args)...);
 }
 
-// NOLINTEND(cppcoreguidelines-missing-std-forward)
+template <typename... Args>
+void warning(std::format_string<Args...> format, Args&&... args)
+{
+    log<Level::WARNING>(format, std::forward<Args>(args)...);
+}
+
+template <typename... Args> void error(std::format_string<Args...> format, Args&&... args)
+{
+    log<Level::ERROR>(format, std::forward<Args>(args)...);
+}
 
 } // namespace console
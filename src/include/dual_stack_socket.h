@@ -0,0 +1,72 @@
+#pragma once
+
+#include "ioi.h"
+#include "resolver.h"
+#include "sticky_socket.h"
+#include "timer_wheel.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/***
+ * Sticky socket for IPv6-only and dual stack displays. Attempts race in the
+ * happy eyeballs style: families alternate, IPv6 first, and every attempt delay
+ * one more starts while the earlier ones keep going, so a broken family costs
+ * one delay instead of a whole connect timeout
+ */
+class DualStackSocket : public StickySocket
+{
+  public:
+    // numbers and types
+    static constexpr std::chrono::milliseconds ATTEMPT_DELAY { 250 };
+    static constexpr std::chrono::milliseconds PROBE_INTERVAL { 10 }; // doubles each time
+    static constexpr std::chrono::milliseconds PROBE_WINDOW { ATTEMPT_DELAY * 4 };
+
+    // you know
+    DualStackSocket(
+        const IoIntf& useIo,
+        std::string host,
+        uint16_t port,
+        size_t retries = DEFAULT_RETRIES
+    );
+    ~DualStackSocket() override;
+
+    // bad luck
+    DualStackSocket(const DualStackSocket&) = delete;
+    DualStackSocket& operator=(const DualStackSocket&) = delete;
+    DualStackSocket(DualStackSocket&&) = delete;
+    DualStackSocket& operator=(DualStackSocket&&) = delete;
+
+    // inspectors
+    [[nodiscard]] auto getCandidates() const -> const std::vector<SocketAddress>&;
+    [[nodiscard]] auto racing() const -> size_t; // attempts besides the watched one
+
+    // actions
+    void useAddresses(const Resolver::Resolution& resolution) override;
+    auto enter(ConnectionState newState) -> bool override;
+    void disconnect() override;
+
+  protected:
+    auto openAttempt() -> int override;
+
+  private:
+    void stagger();
+    void probe();
+    auto launchNext() -> int;
+    auto failOver() -> bool;
+    auto harvest() -> bool;
+    auto swapTo(int fd) -> int; // returns the descriptor it replaced
+    void rearm();
+    void dropRace();
+
+    std::vector<SocketAddress> candidates; // in the order they get tried
+    size_t nextCandidate;
+    std::vector<int> parked; // earlier attempts nobody watches, probed for a while
+    Timer attemptTimer;
+    Timer probeTimer;
+    std::chrono::milliseconds probeEvery;
+    Timer::Clock::time_point probeUntil;
+};
@@ -30,9 +30,11 @@ class EasySocketIntf
     // inspectors
     [[nodiscard]] auto getDescriptor() const -> int;
     [[nodiscard]] auto getHost() const -> const std::string&;
+    [[nodiscard]] auto getPort() const -> uint16_t;
     [[nodiscard]] auto getState() const -> ConnectionState;
     [[nodiscard]] auto getStatus() const -> const std::string&;
     [[nodiscard]] auto isOnline() const -> bool;
+    [[nodiscard]] virtual auto interest() const -> short = 0;
 
     // actions
     virtual auto eval(const struct pollfd& response) -> bool = 0;
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ioi.h"
+#include "poller.h"
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/epoll.h>
+
+class EpollPoller : public PollerIntf
+{
+  public:
+    static constexpr size_t MAX_EVENTS = 256;
+
+    EpollPoller(const IoIntf& useIo);
+    ~EpollPoller() override;
+
+    // bad luck
+    EpollPoller(const EpollPoller&) = delete;
+    EpollPoller& operator=(const EpollPoller&) = delete;
+    EpollPoller(EpollPoller&&) = delete;
+    EpollPoller& operator=(EpollPoller&&) = delete;
+
+    // actions
+    void watch(EasySocketIntf& skt) override;
+    void forget(EasySocketIntf& skt) override;
+    void wakeOn(int fd) override;
+    auto wait(std::vector<Readiness>& ready, int timeout) -> int override;
+    auto transmit(EasySocketIntf& skt, const std::deque<FrameRef>& queue, size_t offset)
+        -> bool override;
+
+  private:
+    const IoIntf& io;
+    int descriptor;
+    std::unordered_map<const EasySocketIntf*, int> registered;
+    std::vector<struct epoll_event> events;
+};
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+/***
+ * Per thread free lists for coroutine frames in power of two size classes,
+ * a finished workflow hands its frame straight to the next one
+ */
+class FramePool
+{
+  public:
+    static constexpr size_t MIN_BLOCK = 64;
+    static constexpr size_t CLASSES = 7; // up to 4 KiB, larger frames go to the heap
+    static constexpr size_t MAX_CACHED = 1024;
+
+    FramePool() = default;
+    ~FramePool();
+
+    // bad luck
+    FramePool(const FramePool&) = delete;
+    FramePool& operator=(const FramePool&) = delete;
+    FramePool(FramePool&&) = delete;
+    FramePool& operator=(FramePool&&) = delete;
+
+    static auto local() -> FramePool&;
+
+    // actions
+    auto allocate(size_t size) -> void*;
+    void release(void* block, size_t size);
+
+    // inspectors
+    [[nodiscard]] auto getHits() const -> uint64_t;
+    [[nodiscard]] auto getMisses() const -> uint64_t;
+    [[nodiscard]] auto cached() const -> size_t;
+
+  private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    struct FreeList
+    {
+        FreeBlock* head = nullptr;
+        size_t count = 0;
+    };
+
+    static auto classOf(size_t size) -> size_t;
+
+    std::array<FreeList, CLASSES> lists {};
+    uint64_t hits = 0;
+    uint64_t misses = 0;
+};
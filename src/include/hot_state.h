@@ -0,0 +1,50 @@
+#pragma once
+
+#include "easy_socket.h"
+#include "sticky_socket.h"
+#include "timer_wheel.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/***
+ * The few per session fields the loop looks at every turn, kept in parallel
+ * arrays so fleet wide scans never drag whole sockets through the cache
+ */
+class HotState
+{
+  public:
+    using State = EasySocketIntf::ConnectionState;
+    using Clock = Timer::Clock;
+
+    // inspectors
+    [[nodiscard]] auto size() const -> size_t;
+    [[nodiscard]] auto descriptorAt(size_t row) const -> int;
+    [[nodiscard]] auto stateAt(size_t row) const -> State;
+    [[nodiscard]] auto interestAt(size_t row) const -> short;
+    [[nodiscard]] auto deadlineAt(size_t row) const -> Clock::time_point;
+    [[nodiscard]] auto attemptsAt(size_t row) const -> size_t;
+    [[nodiscard]] auto hasPendingOutput(size_t row) const -> bool;
+
+    // scans, they fill rows and return how many matched
+    auto dueForReconnect(Clock::time_point now, std::vector<size_t>& rows) const -> size_t;
+    auto withPendingOutput(std::vector<size_t>& rows) const -> size_t;
+    [[nodiscard]] auto count(State wanted) const -> size_t;
+    [[nodiscard]] auto connecting() const -> size_t; // kept up to date, no scan
+
+    // actions
+    void append(const StickySocket& skt);
+    void update(size_t row, const StickySocket& skt);
+    void removeAt(size_t row); // moves the last row into the hole, like SessionStore
+    void clear();
+
+  private:
+    std::vector<int> descriptors;
+    std::vector<State> states;
+    std::vector<short> interests;
+    std::vector<Clock::time_point> deadlines;
+    std::vector<uint16_t> attempts;
+    std::vector<uint8_t> pendingOutput;
+    size_t connectingRows = 0;
+};
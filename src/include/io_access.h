@@ -5,8 +5,11 @@
 #include <arpa/inet.h>
 #include <fcntl.h>
 #include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
 class IoAdapter : public IoIntf
@@ -52,4 +55,52 @@ class IoAdapter : public IoIntf
     {
         return ::poll(fds, count, timeout);
     };
+
+    [[nodiscard]] auto epoll_create1(int flags) const -> int override
+    {
+        return ::epoll_create1(flags);
+    };
+
+    auto epoll_ctl(int epfd, int op, int fd, struct epoll_event* event) const
+        -> int override
+    {
+        return ::epoll_ctl(epfd, op, fd, event);
+    };
+
+    [[nodiscard]] auto
+    epoll_wait(int epfd, struct epoll_event* events, int maxevents, int timeout) const
+        -> int override
+    {
+        return ::epoll_wait(epfd, events, maxevents, timeout);
+    };
+
+    [[nodiscard]] auto eventfd(unsigned int initval, int flags) const -> int override
+    {
+        return ::eventfd(initval, flags);
+    };
+
+    auto read(int fd, void* buf, size_t len) const -> ssize_t override
+    {
+        return ::read(fd, buf, len);
+    };
+
+    auto write(int fd, const void* buf, size_t len) const -> ssize_t override
+    {
+        return ::write(fd, buf, len);
+    };
+
+    auto writev(int fd, const struct iovec* iov, int iovcnt) const -> ssize_t override
+    {
+        return ::writev(fd, iov, iovcnt);
+    };
+
+    auto getaddrinfo(
+        const char* node, const char* service, const struct addrinfo* hints,
+        struct addrinfo** res
+    ) const -> int override
+    {
+        return ::getaddrinfo(node, service, hints, res);
+    };
+
+    void freeaddrinfo(struct addrinfo* res) const override { ::freeaddrinfo(res); };
 };
@@ -1,7 +1,11 @@
 #pragma once
 
+#include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 
 class IoIntf
 {
@@ -26,4 +30,19 @@ class IoIntf
     getsockopt(int sockfd, int level, int optname, void* optval, socklen_t* optlen) const
         -> int = 0;
     virtual auto poll(struct pollfd* fds, nfds_t count, int timeout) const -> int = 0;
+    virtual auto epoll_create1(int flags) const -> int = 0;
+    virtual auto epoll_ctl(int epfd, int op, int fd, struct epoll_event* event) const
+        -> int = 0;
+    virtual auto
+    epoll_wait(int epfd, struct epoll_event* events, int maxevents, int timeout) const
+        -> int = 0;
+    virtual auto eventfd(unsigned int initval, int flags) const -> int = 0;
+    virtual auto read(int fd, void* buf, size_t len) const -> ssize_t = 0;
+    virtual auto write(int fd, const void* buf, size_t len) const -> ssize_t = 0;
+    virtual auto writev(int fd, const struct iovec* iov, int iovcnt) const -> ssize_t = 0;
+    virtual auto getaddrinfo(
+        const char* node, const char* service, const struct addrinfo* hints,
+        struct addrinfo** res
+    ) const -> int = 0;
+    virtual void freeaddrinfo(struct addrinfo* res) const = 0;
 };
@@ -1,15 +1,52 @@
 #pragma once
 
 #include "ioi.h"
+#include "ion_session.h"
+#include "resolver.h"
+#include "shard_ring.h"
 #include "sticky_engine.h"
 
 #include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
 #include <thread>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __ANDROID__
+constexpr bool TICKLESS_BY_DEFAULT = true;
+constexpr std::chrono::milliseconds TIMER_SLACK_BY_DEFAULT { 50 };
+#else
+constexpr bool TICKLESS_BY_DEFAULT = false;
+constexpr std::chrono::milliseconds TIMER_SLACK_BY_DEFAULT { 0 };
+#endif
+
+struct IonServiceConfig
+{
+    size_t shards = 1;
+    bool pinThreads = false;
+    StickyEngine::Backend backend = StickyEngine::Backend::Epoll;
+    bool tickless = TICKLESS_BY_DEFAULT; // block until something is actually due
+    std::chrono::milliseconds timerSlack = TIMER_SLACK_BY_DEFAULT;
+    size_t resolverThreads = Resolver::DEFAULT_WORKERS;
+    std::chrono::seconds resolveTtl = Resolver::DEFAULT_TTL; // how long a DNS answer holds
+    ConnectGate::Limits connectLimits {}; // for the whole fleet, shards get a share each
+};
 
 class IonService
 {
   public:
-    IonService(const IoIntf& useIo);
+    struct Endpoint
+    {
+        std::string host;
+        uint16_t port;
+    };
+
+    IonService(const IoIntf& useIo, IonServiceConfig useConfig = {});
     ~IonService();
 
     // bad luck
@@ -20,23 +57,46 @@ class IonService
 
     // actions
     int setup();
+    void addDisplay(std::string host, uint16_t port); // same thread as start() and stop()
     void start(std::stop_token superToken);
     void stop();
     void resetHealth();
+    void submit(std::string host, uint16_t port, std::function<void(IonSession&)> command);
 
     // inspectors
     [[nodiscard]] auto isRunning() const -> bool;
     [[nodiscard]] auto isHealthy() const -> bool;
+    [[nodiscard]] auto shardCount() const -> size_t;
+    [[nodiscard]] auto shardOf(const std::string& host, uint16_t port) const -> size_t;
+    [[nodiscard]] auto wakeupsPerMinute() const -> uint64_t;
+    [[nodiscard]] auto getMetrics() const -> EngineMetrics; // summed over shards
+    [[nodiscard]] auto getLatency() const -> LatencyReport; // merged over shards
 
     // notifications
-    void onEntry();
-    void onExit();
+    void onEntry(size_t shard);
+    void onExit(size_t shard);
 
   protected:
-    void loop(std::stop_token token);
+    void loop(size_t shard, std::stop_token token);
 
   private:
-    std::atomic<bool> healthy;
-    std::jthread worker;
-    StickyEngine engine;
+    struct Shard
+    {
+        Shard(const IoIntf& useIo, StickyEngine::Backend backend);
+
+        // worker thread only
+        void makeDisplay(const std::string& host, uint16_t port);
+        auto findDisplay(const std::string& host, uint16_t port) -> IonSession*;
+
+        std::atomic<bool> healthy;
+        std::jthread worker;
+        StickyEngine engine;
+        std::vector<Endpoint> endpoints;
+        std::unordered_map<std::string, SessionHandle> displays; // by "host:port"
+    };
+
+    IonServiceConfig config;
+    ShardRing ring;
+    Resolver resolver; // shared by the shards, outlives their engines
+    std::vector<std::unique_ptr<Shard>> shards;
 };
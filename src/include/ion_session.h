@@ -1,19 +1,160 @@
 #pragma once
 
 #include "ioi.h"
+#include "ion_task.h"
+#include "sicp_decoder.h"
 #include "sticky_socket.h"
+#include "timer_wheel.h"
 
+#include <chrono>
+#include <cstddef>
+#include <coroutine>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <span>
 #include <string>
+#include <vector>
 
+/***
+ * SICP display session, requests are pipelined up to a window and replies are
+ * matched to them in order since the protocol carries no request ids
+ */
 class IonSession : public StickySocket
 {
   public:
+    enum class ReplyStatus : uint8_t
+    {
+        Ack,
+        Nack,
+        Nav,
+        Data,
+        Timeout,
+        Dropped,
+    };
+
+    using RequestId = uint64_t;
+    using ReplyHandler = std::function<void(ReplyStatus, std::span<const uint8_t>)>;
+
+    static constexpr RequestId NO_REQUEST = 0;
+    static constexpr size_t DEFAULT_WINDOW = 8;
+    static constexpr size_t BACKLOG_LIMIT = 256;
+    static constexpr std::chrono::milliseconds DEFAULT_REQUEST_TIMEOUT { 2000 };
+
+    struct Reply
+    {
+        ReplyStatus status;
+        std::vector<uint8_t> frame; // empty unless the display answered
+    };
+
+    /***
+     * Resumes the coroutine once the session is online, right away if it is
+     */
+    class OnlineAwaiter
+    {
+      public:
+        explicit OnlineAwaiter(IonSession& useSession);
+
+        [[nodiscard]] auto await_ready() const -> bool;
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume() const {}
+
+      private:
+        IonSession& session;
+    };
+
+    /***
+     * Pipelines a request like request() does and resumes with its reply
+     */
+    class ReplyAwaiter
+    {
+      public:
+        ReplyAwaiter(
+            IonSession& useSession, uint8_t control, uint8_t group,
+            std::span<const uint8_t> data
+        );
+
+        // bad luck
+        ReplyAwaiter(const ReplyAwaiter&) = delete;
+        ReplyAwaiter& operator=(const ReplyAwaiter&) = delete;
+        ReplyAwaiter(ReplyAwaiter&&) = delete;
+        ReplyAwaiter& operator=(ReplyAwaiter&&) = delete;
+
+        [[nodiscard]] auto await_ready() const -> bool { return false; }
+        auto await_suspend(std::coroutine_handle<> handle) -> bool;
+        auto await_resume() -> Reply;
+
+      private:
+        IonSession& session;
+        uint8_t control;
+        uint8_t group;
+        std::span<const uint8_t> data;
+        Reply reply;
+        bool suspending;
+        bool answered;
+    };
+
     IonSession(const IoIntf& useIo, std::string host, uint16_t port);
+    ~IonSession() override;
+
+    // bad luck
+    IonSession(const IonSession&) = delete;
+    IonSession& operator=(const IonSession&) = delete;
+    IonSession(IonSession&&) = delete;
+    IonSession& operator=(IonSession&&) = delete;
+
+    // inspectors
+    [[nodiscard]] auto getDecoder() const -> const SicpDecoder&;
+    [[nodiscard]] auto inFlight() const -> size_t;
+    [[nodiscard]] auto queued() const -> size_t;
+
+    // actions
+    auto sendFrame(uint8_t control, uint8_t group, std::span<const uint8_t> data) -> int;
+    auto request(
+        uint8_t control, uint8_t group, std::span<const uint8_t> data, ReplyHandler onReply
+    ) -> RequestId;
+    void setWindow(size_t size);
+
+    // awaitables, resumed from the event loop driving this session
+    [[nodiscard]] auto connected() -> OnlineAwaiter;
+    [[nodiscard]] auto request(
+        uint8_t control, uint8_t group, std::span<const uint8_t> data
+    ) -> ReplyAwaiter;
+    [[nodiscard]] auto sleepFor(std::chrono::milliseconds delay) -> SleepAwaiter;
+    void setRequestTimeout(std::chrono::milliseconds timeout);
 
     // notifications
     void didReceived(std::span<const uint8_t> data) override;
+    virtual void didReceiveFrame(std::span<const uint8_t> frame); // unsolicited
     void wentOnline() override;
     void wentOffline() override;
+
+  private:
+    struct Pending
+    {
+        RequestId id;
+        ReplyHandler onReply;
+        std::vector<uint8_t> frame; // kept only while waiting for the window
+        uint8_t control;
+        uint8_t group;
+        Timer::Clock::time_point sentAt;
+        Timer::Clock::time_point deadline;
+    };
+
+    void onFrame(std::span<const uint8_t> frame);
+    void transmit(Pending pending);
+    void pump();
+    void expire();
+    void armTimeout();
+    void failAll(std::deque<Pending>& requests, ReplyStatus status);
+
+    SicpDecoder decoder;
+    size_t window;
+    std::chrono::milliseconds requestTimeout;
+    RequestId lastId;
+    std::deque<Pending> waiting;
+    std::deque<Pending> backlog;
+    Timer timeoutTimer;
+    std::vector<std::coroutine_handle<>> onlineWaiters;
+    bool closing; // refuses requests made while the destructor fails the rest
 };
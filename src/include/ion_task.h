@@ -0,0 +1,56 @@
+#pragma once
+
+#include "frame_pool.h"
+#include "reactor.h"
+#include "timer_wheel.h"
+
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+
+/***
+ * Fire and forget coroutine for session workflows, it starts right away on the
+ * calling thread (post() it to land on a shard) and frees its frame when done
+ */
+class IonTask
+{
+  public:
+    struct promise_type
+    {
+        static auto operator new(size_t size) -> void*;
+        static void operator delete(void* frame, size_t size);
+
+        auto get_return_object() -> IonTask { return {}; }
+        auto initial_suspend() -> std::suspend_never { return {}; }
+        auto final_suspend() noexcept -> std::suspend_never { return {}; }
+        void return_void() {}
+        void unhandled_exception();
+    };
+};
+
+/***
+ * Resumes the coroutine from the reactor's timer wheel once the delay passed
+ */
+class SleepAwaiter
+{
+  public:
+    SleepAwaiter(ReactorIntf* useReactor, std::chrono::milliseconds useDelay);
+
+    // bad luck
+    SleepAwaiter(const SleepAwaiter&) = delete;
+    SleepAwaiter& operator=(const SleepAwaiter&) = delete;
+    SleepAwaiter(SleepAwaiter&&) = delete;
+    SleepAwaiter& operator=(SleepAwaiter&&) = delete;
+
+    [[nodiscard]] auto await_ready() const -> bool;
+    void await_suspend(std::coroutine_handle<> handle);
+    void await_resume() const {}
+
+  private:
+    ReactorIntf* reactor;
+    std::chrono::milliseconds delay;
+    std::coroutine_handle<> waiter;
+    Timer wake;
+};
+
+auto sleepFor(ReactorIntf& reactor, std::chrono::milliseconds delay) -> SleepAwaiter;
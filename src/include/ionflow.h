@@ -1,13 +1,36 @@
 #pragma once
 
-#include "console.h"       // NOLINT(clang-diagnostic-unused-include)
-#include "easy_socket.h"   // NOLINT(clang-diagnostic-unused-include)
-#include "helpnet.h"       // NOLINT(clang-diagnostic-unused-include)
-#include "io_access.h"     // NOLINT(clang-diagnostic-unused-include)
-#include "ioi.h"           // NOLINT(clang-diagnostic-unused-include)
-#include "ion_service.h"   // NOLINT(clang-diagnostic-unused-include)
-#include "ion_session.h"   // NOLINT(clang-diagnostic-unused-include)
-#include "ipv4_socket.h"   // NOLINT(clang-diagnostic-unused-include)
-#include "sizes.h"         // NOLINT(clang-diagnostic-unused-include)
-#include "sticky_socket.h" // NOLINT(clang-diagnostic-unused-include)
-#include "version.h"       // NOLINT(clang-diagnostic-unused-include)
+#include "buffer_pool.h"       // NOLINT(clang-diagnostic-unused-include)
+#include "checksum.h"          // NOLINT(clang-diagnostic-unused-include)
+#include "connect_gate.h"      // NOLINT(clang-diagnostic-unused-include)
+#include "console.h"           // NOLINT(clang-diagnostic-unused-include)
+#include "dual_stack_socket.h" // NOLINT(clang-diagnostic-unused-include)
+#include "easy_socket.h"       // NOLINT(clang-diagnostic-unused-include)
+#include "epoll_poller.h"      // NOLINT(clang-diagnostic-unused-include)
+#include "frame_pool.h"        // NOLINT(clang-diagnostic-unused-include)
+#include "helpnet.h"           // NOLINT(clang-diagnostic-unused-include)
+#include "hot_state.h"         // NOLINT(clang-diagnostic-unused-include)
+#include "io_access.h"         // NOLINT(clang-diagnostic-unused-include)
+#include "ioi.h"               // NOLINT(clang-diagnostic-unused-include)
+#include "ion_service.h"       // NOLINT(clang-diagnostic-unused-include)
+#include "ion_session.h"       // NOLINT(clang-diagnostic-unused-include)
+#include "ion_task.h"          // NOLINT(clang-diagnostic-unused-include)
+#include "ipv4_socket.h"       // NOLINT(clang-diagnostic-unused-include)
+#include "latency_histogram.h" // NOLINT(clang-diagnostic-unused-include)
+#include "metrics.h"           // NOLINT(clang-diagnostic-unused-include)
+#include "mpsc_queue.h"        // NOLINT(clang-diagnostic-unused-include)
+#include "poller.h"            // NOLINT(clang-diagnostic-unused-include)
+#include "rate_meter.h"        // NOLINT(clang-diagnostic-unused-include)
+#include "reactor.h"           // NOLINT(clang-diagnostic-unused-include)
+#include "resolver.h"          // NOLINT(clang-diagnostic-unused-include)
+#include "session_store.h"     // NOLINT(clang-diagnostic-unused-include)
+#include "shard_ring.h"        // NOLINT(clang-diagnostic-unused-include)
+#include "shared_frame.h"      // NOLINT(clang-diagnostic-unused-include)
+#include "sicp_decoder.h"      // NOLINT(clang-diagnostic-unused-include)
+#include "sizes.h"             // NOLINT(clang-diagnostic-unused-include)
+#include "spsc_ring.h"         // NOLINT(clang-diagnostic-unused-include)
+#include "sticky_engine.h"     // NOLINT(clang-diagnostic-unused-include)
+#include "sticky_socket.h"     // NOLINT(clang-diagnostic-unused-include)
+#include "timer_wheel.h"       // NOLINT(clang-diagnostic-unused-include)
+#include "uring_poller.h"      // NOLINT(clang-diagnostic-unused-include)
+#include "version.h"           // NOLINT(clang-diagnostic-unused-include)
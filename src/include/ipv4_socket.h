@@ -1,23 +1,51 @@
 #pragma once
 
+#include "buffer_pool.h"
 #include "easy_socket.h"
 #include "ioi.h"
+#include "latency_histogram.h"
+#include "metrics.h"
+#include "reactor.h"
+#include "resolver.h"
+#include "shared_frame.h"
 
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <vector>
 
 class IPv4Socket : public EasySocketIntf
 {
   public:
+    static constexpr size_t TX_QUEUE_LIMIT = 64 * 1024;
+    static constexpr size_t TX_BATCH = 64;
+
     IPv4Socket(const IoIntf& ioRef, std::string host, uint16_t port);
     ~IPv4Socket() override;
     IPv4Socket(IPv4Socket&&) noexcept;
 
+    // inspectors
+    [[nodiscard]] auto interest() const -> short override;
+    [[nodiscard]] auto pendingBytes() const -> size_t;
+    [[nodiscard]] auto getReceiveSize() const -> size_t;
+    [[nodiscard]] auto getMetrics() const -> TrafficMetrics; // from any thread
+    [[nodiscard]] auto isResolved() const -> bool;
+    [[nodiscard]] auto getAddress() const -> const SocketAddress&;
+
     // actions
+    void attach(ReactorIntf* useReactor);
+    void setReceiveSize(size_t size);
+    void linkMetrics(TrafficCounters* parent, LatencyBook* latency = nullptr);
+    virtual void useAddresses(const Resolver::Resolution& resolution);
     auto enter(ConnectionState newState) -> bool override;
     auto connect() -> bool override;
     void disconnect() override;
     auto eval(const struct pollfd& response) -> bool override;
+    auto ingest(std::span<const uint8_t> data) -> bool;
     auto send(std::span<const uint8_t> buffer) -> int override;
+    auto send(FrameRef frame) -> int;
+    auto flush() -> bool;
+    auto transmitted(int sent) -> bool; // the reactor's send finished, bytes or -errno
     auto receive() -> std::span<const uint8_t> override;
 
     // notifications
@@ -25,10 +53,50 @@ class IPv4Socket : public EasySocketIntf
     void wentOnline() override;
     void wentOffline() override;
 
+  protected:
+    [[nodiscard]] auto getIo() const -> const IoIntf&;
+    [[nodiscard]] auto getReactor() const -> ReactorIntf*;
+    [[nodiscard]] auto getLatencyBook() const -> LatencyBook*;
+    void tally(TrafficCounters::Counter counter, uint64_t amount = 1);
+    void useAddress(const SocketAddress& chosen, Resolver::Clock::time_point expires);
+    virtual auto openAttempt() -> int; // a descriptor connecting somewhere, or none
+    auto openTo(const SocketAddress& target) -> int;
+    auto awaitsAddress() -> bool; // a lookup is under way, connecting now is pointless
+    auto dial() -> bool;          // opens an attempt to the address already known
+
   private:
     void canReceive();
     void canSend();
+    void dropPending();
+    void track(ConnectionState last);
+    void refuse(const FrameRef& frame);
+    auto enqueue(FrameRef frame, bool writeNow) -> int;
+    void retire(size_t written, std::vector<FrameRef>& sent);
+    void armOutput();
 
     const IoIntf& io;
-    std::array<uint8_t, BUFFER_SIZE> rxBuffer;
+    ReactorIntf* reactor;
+
+    // leased from the loop's pool for one read, and handed back once it is consumed
+    BufferPool::Lease rxLease;
+    size_t rxSize;
+
+    // looked up once, reconnects reuse it until it expires
+    SocketAddress address;
+    Resolver::Clock::time_point addressExpires;
+    bool resolved;
+
+    // frames waiting for the socket to become writable, the first one maybe partially
+    std::deque<FrameRef> txQueue;
+    size_t txOffset;
+    size_t txBytes;
+    bool txArmed;
+    bool txInFlight; // the reactor sends the head of the queue, do not touch it
+
+    // own counters plus the engine's, which outlive every session it drives
+    TrafficCounters traffic;
+    TrafficCounters* parentTraffic;
+    TrafficCounters::Clock::time_point onlineSince;
+    LatencyBook* latencyBook;
+    TrafficCounters::Clock::time_point connectStarted;
 };
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <span>
+#include <vector>
+
+/***
+ * Non-empty buckets of a latency histogram, cheap to copy, merge and ship
+ */
+struct LatencySnapshot
+{
+    struct Bucket
+    {
+        uint16_t index;
+        uint64_t count;
+    };
+
+    std::vector<Bucket> buckets; // ascending by index
+
+    // inspectors
+    [[nodiscard]] auto count() const -> uint64_t;
+    [[nodiscard]] auto percentile(double percent) const -> std::chrono::microseconds;
+    [[nodiscard]] auto max() const -> std::chrono::microseconds;
+    [[nodiscard]] auto encode() const -> std::vector<uint8_t>; // varints, see decode
+
+    // actions
+    auto operator+=(const LatencySnapshot& other) -> LatencySnapshot&;
+    static auto decode(std::span<const uint8_t> data, LatencySnapshot& into) -> bool;
+};
+
+/***
+ * Log bucketed histogram in the HDR layout: every power of two range is split
+ * into the same number of linear buckets, keeping the error below 1% from one
+ * microsecond up to an hour. Written by one event loop, readable from any thread
+ */
+class LatencyHistogram
+{
+  public:
+    static constexpr unsigned SUB_BITS = 7;
+    static constexpr unsigned RANGE_BITS = 32; // microseconds, a bit over an hour
+    static constexpr uint64_t SUB_COUNT = uint64_t { 1 } << SUB_BITS;
+    static constexpr uint64_t HALF_COUNT = SUB_COUNT / 2;
+    static constexpr size_t BUCKETS = (RANGE_BITS - SUB_BITS + 2) * HALF_COUNT;
+    static constexpr uint64_t HIGHEST = (uint64_t { 1 } << RANGE_BITS) - 1;
+
+    LatencyHistogram() = default;
+
+    // bad luck
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+    LatencyHistogram(LatencyHistogram&&) = delete;
+    LatencyHistogram& operator=(LatencyHistogram&&) = delete;
+
+    // actions, loop thread only
+    void record(std::chrono::nanoseconds elapsed);
+
+    // inspectors, any thread
+    [[nodiscard]] auto snapshot() const -> LatencySnapshot;
+    [[nodiscard]] static auto bucketOf(uint64_t micros) -> size_t;
+    [[nodiscard]] static auto highestOf(size_t bucket) -> uint64_t;
+
+  private:
+    std::array<std::atomic<uint64_t>, BUCKETS> counts {};
+};
+
+/***
+ * Latency percentiles of one engine or of a whole service
+ */
+struct LatencyReport
+{
+    LatencySnapshot connect;            // connect() until the socket is writable
+    LatencySnapshot replies;            // request sent until its reply, every group
+    std::map<uint8_t, LatencySnapshot> groups; // the same, per display group
+
+    auto operator+=(const LatencyReport& other) -> LatencyReport&;
+};
+
+/***
+ * The histograms an engine keeps for all of its sessions. Group histograms are
+ * made when a group is first asked for, recording itself never allocates
+ */
+class LatencyBook
+{
+  public:
+    static constexpr size_t GROUPS = 256;
+
+    LatencyBook() = default;
+
+    // bad luck
+    LatencyBook(const LatencyBook&) = delete;
+    LatencyBook& operator=(const LatencyBook&) = delete;
+    LatencyBook(LatencyBook&&) = delete;
+    LatencyBook& operator=(LatencyBook&&) = delete;
+
+    // actions, loop thread only
+    void prepare(uint8_t group);
+    void recordConnect(std::chrono::nanoseconds elapsed);
+    void recordReply(uint8_t group, std::chrono::nanoseconds elapsed);
+
+    // inspectors, any thread
+    [[nodiscard]] auto report() const -> LatencyReport;
+
+  private:
+    LatencyHistogram connects;
+    std::array<std::atomic<LatencyHistogram*>, GROUPS> groups {};
+    std::vector<std::unique_ptr<LatencyHistogram>> owned;
+};
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+struct TrafficMetrics
+{
+    uint64_t bytesIn = 0;
+    uint64_t bytesOut = 0;
+    uint64_t framesIn = 0;
+    uint64_t framesOut = 0;
+    uint64_t unsolicited = 0; // frames in that answered no request
+    uint64_t sendStalls = 0; // writes that hit EAGAIN
+    uint64_t reconnects = 0; // attempts made by the backoff, not by connect()
+    uint64_t connectFailures = 0;
+    std::chrono::milliseconds connected { 0 }; // summed over every session counted
+
+    auto operator+=(const TrafficMetrics& other) -> TrafficMetrics&;
+};
+
+/***
+ * Counters written by one event loop and snapshotted from any thread, a
+ * sequence number makes sure a snapshot never mixes two updates
+ */
+class TrafficCounters
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    enum class Counter : uint8_t
+    {
+        BytesIn,
+        BytesOut,
+        FramesIn,
+        FramesOut,
+        Unsolicited,
+        SendStalls,
+        Reconnects,
+        ConnectFailures,
+        COUNT,
+    };
+
+    TrafficCounters() = default;
+
+    // bad luck
+    TrafficCounters(const TrafficCounters&) = delete;
+    TrafficCounters& operator=(const TrafficCounters&) = delete;
+    TrafficCounters(TrafficCounters&&) = delete;
+    TrafficCounters& operator=(TrafficCounters&&) = delete;
+
+    // actions, loop thread only
+    void add(Counter counter, uint64_t amount = 1);
+    void wentOnline(Clock::time_point since);
+    void wentOffline(Clock::time_point since, Clock::time_point now);
+
+    // inspectors, any thread
+    [[nodiscard]] auto snapshot(Clock::time_point now = Clock::now()) const
+        -> TrafficMetrics;
+
+  private:
+    static constexpr auto COUNTERS = static_cast<size_t>(Counter::COUNT);
+
+    [[nodiscard]] auto microsOf(Clock::time_point point) const -> int64_t;
+    void beginWrite();
+    void endWrite();
+
+    std::atomic<uint64_t> sequence { 0 }; // odd while an update is under way
+    std::array<std::atomic<uint64_t>, COUNTERS> counters {};
+    // microseconds after origin, summed modulo 2^64 so a whole fleet runs for years
+    const Clock::time_point origin { Clock::now() };
+    std::atomic<uint64_t> connectedUs { 0 }; // sessions that already went offline
+    std::atomic<int64_t> online { 0 };
+    std::atomic<uint64_t> sinceSumUs { 0 }; // online since, summed over online sessions
+    std::atomic<int64_t> latestSinceUs { INT64_MIN }; // keeps a racing snapshot positive
+};
+
+/***
+ * Loop level figures of one engine, traffic covers every session it ever had
+ */
+struct EngineMetrics
+{
+    TrafficMetrics traffic;
+    uint64_t sessions = 0;
+    uint64_t polls = 0;
+    uint64_t events = 0;
+    uint64_t commands = 0;
+    uint64_t connectQueue = 0;     // sessions waiting for the connect gate right now
+    uint64_t connectsDeferred = 0; // connects the gate held back
+
+    auto operator+=(const EngineMetrics& other) -> EngineMetrics&;
+};
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+/***
+ * Lock-free multi producer, single consumer queue (Vyukov style), producers
+ * never wait on each other and the consumer never waits on producers
+ */
+template <typename T> class MpscQueue
+{
+  public:
+    MpscQueue()
+        : head(&stub)
+        , tail(&stub)
+    {
+    }
+
+    ~MpscQueue()
+    {
+        while (pop())
+        {
+        }
+    }
+
+    // bad luck
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+    MpscQueue(MpscQueue&&) = delete;
+    MpscQueue& operator=(MpscQueue&&) = delete;
+
+    // any thread
+    void push(T value)
+    {
+        auto* node = new Node { .next = nullptr, .value = std::move(value) };
+        Node* prev = head.exchange(node, std::memory_order_acq_rel);
+        prev->next.store(node, std::memory_order_release);
+    }
+
+    // consumer thread only
+    auto pop() -> std::optional<T>
+    {
+        Node* first = tail;
+        Node* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub)
+        {
+            if (next == nullptr)
+            {
+                return std::nullopt;
+            }
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+
+        if (next != nullptr)
+        {
+            tail = next;
+            return take(first);
+        }
+
+        if (first != head.load(std::memory_order_acquire))
+        {
+            // a producer is halfway through linking, try again later
+            return std::nullopt;
+        }
+
+        stub.next.store(nullptr, std::memory_order_relaxed);
+        Node* prev = head.exchange(&stub, std::memory_order_acq_rel);
+        prev->next.store(&stub, std::memory_order_release);
+
+        next = first->next.load(std::memory_order_acquire);
+        if (next != nullptr)
+        {
+            tail = next;
+            return take(first);
+        }
+        return std::nullopt;
+    }
+
+  private:
+    struct Node
+    {
+        std::atomic<Node*> next;
+        std::optional<T> value;
+    };
+
+    static auto take(Node* node) -> std::optional<T>
+    {
+        std::optional<T> value { std::move(node->value) };
+        delete node;
+        return value;
+    }
+
+    std::atomic<Node*> head;
+    Node* tail;
+    Node stub { .next = nullptr, .value = std::nullopt };
+};
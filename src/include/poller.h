@@ -0,0 +1,44 @@
+#pragma once
+
+#include "shared_frame.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <span>
+#include <vector>
+
+class EasySocketIntf;
+
+struct Readiness
+{
+    EasySocketIntf* socket; // nullptr when the wakeup descriptor fired
+    short revents;
+    std::span<const uint8_t> data; // already received on the socket's behalf
+    std::optional<int> sent;       // a send run on its behalf finished: bytes or -errno
+};
+
+/***
+ * Readiness backend that keeps its own registrations, unlike the plain poll path
+ */
+class PollerIntf
+{
+  public:
+    PollerIntf() = default;
+    PollerIntf(PollerIntf&&) = default;
+    virtual ~PollerIntf() = default;
+    auto operator=(PollerIntf&&) -> PollerIntf& = default;
+
+    PollerIntf(const PollerIntf&) = delete;
+    auto operator=(const PollerIntf&) -> PollerIntf& = delete;
+
+    // actions
+    virtual void watch(EasySocketIntf& skt) = 0;
+    virtual void forget(EasySocketIntf& skt) = 0;
+    virtual void wakeOn(int fd) = 0;
+    virtual auto wait(std::vector<Readiness>& ready, int timeout) -> int = 0;
+    virtual auto transmit(
+        EasySocketIntf& skt, const std::deque<FrameRef>& queue, size_t offset
+    ) -> bool = 0; // false leaves the writing to the socket
+};
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/***
+ * Sliding one minute event counter in one second buckets, written by a single
+ * thread and readable from any other
+ */
+class RateMeter
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+    static constexpr size_t WINDOW = 60;
+
+    RateMeter() = default;
+
+    // bad luck
+    RateMeter(const RateMeter&) = delete;
+    RateMeter& operator=(const RateMeter&) = delete;
+    RateMeter(RateMeter&&) = delete;
+    RateMeter& operator=(RateMeter&&) = delete;
+
+    // actions
+    void record(Clock::time_point now = Clock::now());
+
+    // inspectors
+    [[nodiscard]] auto perMinute(Clock::time_point now = Clock::now()) const -> uint64_t;
+
+  private:
+    std::array<std::atomic<uint64_t>, WINDOW> buckets {};
+};
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "shared_frame.h"
+#include "timer_wheel.h"
+
+#include <cstddef>
+#include <deque>
+
+class EasySocketIntf;
+
+/***
+ * Whoever drives a socket gets told when its descriptor needs (re)registering,
+ * and keeps the clock for its timers
+ */
+class ReactorIntf
+{
+  public:
+    ReactorIntf() = default;
+    ReactorIntf(ReactorIntf&&) = default;
+    virtual ~ReactorIntf() = default;
+    auto operator=(ReactorIntf&&) -> ReactorIntf& = default;
+
+    ReactorIntf(const ReactorIntf&) = delete;
+    auto operator=(const ReactorIntf&) -> ReactorIntf& = delete;
+
+    // notifications
+    virtual void watch(EasySocketIntf& skt) = 0;
+    virtual void forget(EasySocketIntf& skt) = 0;
+    virtual void refresh(EasySocketIntf& skt) = 0; // state or backoff moved
+    virtual auto resolve(EasySocketIntf& skt) -> bool = 0; // true while a lookup runs
+
+    // actions
+    virtual auto admit(EasySocketIntf& skt) -> bool = 0; // false holds the connect back
+    virtual void schedule(Timer& timer, Timer::Clock::time_point deadline) = 0;
+    virtual void cancel(Timer& timer) = 0;
+    virtual auto transmit(
+        EasySocketIntf& skt, const std::deque<FrameRef>& queue, size_t offset
+    ) -> bool = 0; // true sends the head of the queue, finished by transmitted()
+};
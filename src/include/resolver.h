@@ -0,0 +1,118 @@
+#pragma once
+
+#include "ioi.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <sys/socket.h>
+
+/***
+ * A resolved address, ready to be handed to connect() as it is
+ */
+struct SocketAddress
+{
+    struct sockaddr_storage storage;
+    socklen_t length;
+
+    [[nodiscard]] auto family() const -> int { return storage.ss_family; }
+    [[nodiscard]] auto get() const -> const struct sockaddr*
+    {
+        return reinterpret_cast<const struct sockaddr*>(&storage);
+    }
+};
+
+/***
+ * Name lookups run on a small pool of worker threads, never on an event loop.
+ * Answers are cached for a fixed time to live, failures for a shorter one, and
+ * concurrent requests for the same name share a single lookup
+ */
+class Resolver
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    static constexpr size_t DEFAULT_WORKERS = 4;
+    static constexpr std::chrono::seconds DEFAULT_TTL { 300 };
+    static constexpr std::chrono::seconds FAILURE_TTL { 5 };
+
+    struct Resolution
+    {
+        std::vector<SocketAddress> addresses; // empty when the name did not resolve
+        Clock::time_point expires;
+    };
+
+    // runs on a worker thread, or right away on the caller's when the answer is cached
+    using Callback = std::function<void(const Resolution&)>;
+
+    Resolver(
+        const IoIntf& useIo,
+        size_t workerCount = DEFAULT_WORKERS,
+        std::chrono::seconds useTtl = DEFAULT_TTL
+    );
+    ~Resolver();
+
+    // bad luck
+    Resolver(const Resolver&) = delete;
+    Resolver& operator=(const Resolver&) = delete;
+    Resolver(Resolver&&) = delete;
+    Resolver& operator=(Resolver&&) = delete;
+
+    // inspectors
+    [[nodiscard]] auto cached() const -> size_t;
+    [[nodiscard]] auto lookup(
+        const std::string& host, uint16_t port, Resolution& out,
+        Clock::time_point now = Clock::now()
+    ) const -> bool;
+
+    // actions, safe from any thread
+    void resolve(
+        const std::string& host, uint16_t port, const void* owner, Callback onResolved
+    );
+    void prefetch(const std::string& host, uint16_t port);
+    void forget(const void* owner); // no callback of owner runs once this returns
+
+    // factory methods
+    static auto parseNumeric(
+        const IoIntf& io, const std::string& host, uint16_t port, SocketAddress& out
+    ) -> bool;
+
+  private:
+    struct Waiter
+    {
+        const void* owner;
+        Callback onResolved;
+    };
+
+    struct Job
+    {
+        std::string key;
+        std::string host;
+        uint16_t port = 0;
+    };
+
+    void work(const std::stop_token& token);
+    [[nodiscard]] auto query(const Job& job) const -> Resolution;
+
+    const IoIntf& io;
+    std::chrono::seconds ttl;
+
+    mutable std::mutex mutex;
+    std::condition_variable_any wake;
+    std::deque<Job> jobs;
+    std::unordered_map<std::string, Resolution> cache;
+    std::unordered_map<std::string, std::vector<Waiter>> inFlight;
+
+    // held while callbacks run, so forget() can wait for the ones under way
+    std::mutex dispatching;
+    std::vector<std::jthread> workers;
+};
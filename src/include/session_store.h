@@ -0,0 +1,115 @@
+#pragma once
+
+#include "sticky_socket.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/***
+ * Cheap to copy reference into a SessionStore, it goes stale once the session
+ * it points at is erased even if the slot gets reused
+ */
+struct SessionHandle
+{
+    uint32_t index = 0;
+    uint32_t generation = 0; // never zero for a handle that was handed out
+
+    [[nodiscard]] auto isValid() const -> bool { return generation != 0; }
+    auto operator==(const SessionHandle&) const -> bool = default;
+};
+
+/***
+ * Slab of fixed size slots for sessions, carved from chunks that never move so
+ * pollers and timers may keep pointing at them; bigger sessions go to the heap
+ */
+class SessionStore
+{
+  public:
+    static constexpr size_t SLOT_SIZE = 1536; // an IonSession with some headroom
+    static constexpr size_t SLOTS_PER_CHUNK = 32;
+    static constexpr size_t NO_POSITION = SIZE_MAX;
+
+    SessionStore() = default;
+    ~SessionStore();
+
+    // bad luck
+    SessionStore(const SessionStore&) = delete;
+    SessionStore& operator=(const SessionStore&) = delete;
+    SessionStore(SessionStore&&) = delete;
+    SessionStore& operator=(SessionStore&&) = delete;
+
+    // factory methods
+    template <typename T, typename... Args> auto emplace(Args&&... args) -> SessionHandle
+    {
+        static_assert(
+            std::is_base_of<StickySocket, T>::value, "T must be derived from StickySocket."
+        );
+
+        const uint32_t index = acquire();
+        auto& slot = slots.at(index);
+        if constexpr (sizeof(T) <= SLOT_SIZE && alignof(T) <= alignof(Cell))
+        {
+            slot.socket = ::new (cellAt(index)) T(std::forward<Args>(args)...);
+            slot.pooled = true;
+        }
+        else
+        {
+            slot.socket = new T(std::forward<Args>(args)...);
+            slot.pooled = false;
+        }
+        slot.position = static_cast<uint32_t>(live.size());
+        live.push_back(index);
+        dense.push_back(slot.socket);
+        slotOfSocket.emplace(slot.socket, index);
+        return { .index = index, .generation = slot.generation };
+    }
+
+    // inspectors
+    [[nodiscard]] auto get(SessionHandle handle) const -> StickySocket*;
+    [[nodiscard]] auto isPooled(SessionHandle handle) const -> bool;
+    [[nodiscard]] auto size() const -> size_t;
+    [[nodiscard]] auto capacity() const -> size_t;
+    [[nodiscard]] auto at(size_t position) const -> StickySocket&;
+    [[nodiscard]] auto handleAt(size_t position) const -> SessionHandle;
+    [[nodiscard]] auto positionOf(const EasySocketIntf& skt) const -> size_t;
+    [[nodiscard]] auto begin() const { return dense.begin(); }
+    [[nodiscard]] auto end() const { return dense.end(); }
+
+    // actions
+    auto erase(SessionHandle handle) -> bool;
+    void clear();
+
+  private:
+    struct alignas(64) Cell
+    {
+        std::array<std::byte, SLOT_SIZE> bytes;
+    };
+
+    struct Slot
+    {
+        StickySocket* socket = nullptr;
+        uint32_t generation = 0;
+        uint32_t position = 0; // in the live list, or the next free slot
+        bool pooled = false;
+    };
+
+    static constexpr uint32_t NO_SLOT = UINT32_MAX;
+
+    auto acquire() -> uint32_t;
+    auto cellAt(uint32_t index) -> void*;
+    [[nodiscard]] auto slotOf(SessionHandle handle) const -> const Slot*;
+
+    std::vector<std::unique_ptr<Cell[]>> chunks; // NOLINT(*-avoid-c-arrays)
+    std::vector<Slot> slots;
+    std::vector<uint32_t> live;       // slot of each session, in iteration order
+    std::vector<StickySocket*> dense; // same order, so the fleet walks without lookups
+    std::unordered_map<const EasySocketIntf*, uint32_t> slotOfSocket;
+    uint32_t freeSlot = NO_SLOT;
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/***
+ * Consistent hash ring, a key keeps its shard unless the shard count changes
+ */
+class ShardRing
+{
+  public:
+    static constexpr size_t DEFAULT_REPLICAS = 64;
+
+    ShardRing(size_t shards, size_t replicas = DEFAULT_REPLICAS);
+
+    // inspectors
+    [[nodiscard]] auto size() const -> size_t;
+    [[nodiscard]] auto pick(std::string_view key) const -> size_t;
+
+    static auto hash(std::string_view key) -> uint64_t;
+
+  private:
+    size_t shards;
+    std::vector<std::pair<uint64_t, size_t>> points;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <span>
+#include <vector>
+
+class EasySocketIntf;
+class SharedFrame;
+
+using FrameRef = std::shared_ptr<const SharedFrame>;
+
+/***
+ * Immutable outgoing bytes, shared by every transmit queue they are sitting in
+ * and told about each socket that finished (or gave up) sending them
+ */
+class SharedFrame
+{
+  public:
+    using Delivery = std::function<void(EasySocketIntf& skt, bool sent)>;
+
+    SharedFrame(std::span<const uint8_t> bytes, Delivery onDelivery);
+
+    static auto make(std::span<const uint8_t> bytes, Delivery onDelivery = {}) -> FrameRef;
+
+    // inspectors
+    [[nodiscard]] auto bytes() const -> std::span<const uint8_t>;
+    [[nodiscard]] auto size() const -> size_t;
+    [[nodiscard]] auto wantsDelivery() const -> bool;
+
+    // notifications
+    void delivered(EasySocketIntf& skt, bool sent) const;
+
+  private:
+    std::vector<uint8_t> payload;
+    Delivery onDelivery;
+};
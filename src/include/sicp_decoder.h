@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace sicp
+{
+constexpr size_t MIN_FRAME = 3;   // length, control and checksum
+constexpr size_t MAX_FRAME = 255; // the length is a single byte
+
+auto checksum(std::span<const uint8_t> data) -> uint8_t;
+auto isValid(std::span<const uint8_t> frame) -> bool;
+auto encode(
+    std::span<uint8_t> out, uint8_t control, uint8_t group, std::span<const uint8_t> data
+) -> size_t;
+} // namespace sicp
+
+/***
+ * Incremental SICP frame decoder, whole frames found in a read are handed out
+ * as views into that read and only a frame split across reads is staged
+ */
+class SicpDecoder
+{
+  public:
+    SicpDecoder();
+
+    // inspectors
+    [[nodiscard]] auto pendingBytes() const -> size_t;
+    [[nodiscard]] auto getFrames() const -> uint64_t;
+    [[nodiscard]] auto getErrors() const -> uint64_t;
+
+    // actions
+    void reset();
+
+    template <typename Sink>
+    auto feed(std::span<const uint8_t> chunk, Sink&& onFrame) -> size_t
+    {
+        size_t delivered = 0;
+        if (staged > 0)
+        {
+            const size_t taken = stage(chunk);
+            chunk = chunk.subspan(taken);
+            if (staged < staging[0])
+            {
+                return delivered;
+            }
+
+            const std::span<const uint8_t> frame { staging.data(), staged };
+            staged = 0;
+            if (accept(frame))
+            {
+                onFrame(frame);
+                delivered++;
+            }
+        }
+
+        while (!chunk.empty())
+        {
+            const size_t length = chunk[0];
+            if (length < sicp::MIN_FRAME)
+            {
+                // not a frame start, slide forward until something makes sense
+                errors++;
+                chunk = chunk.subspan(1);
+                continue;
+            }
+
+            if (length > chunk.size())
+            {
+                stage(chunk);
+                break;
+            }
+
+            const auto frame = chunk.first(length);
+            chunk = chunk.subspan(length);
+            if (accept(frame))
+            {
+                onFrame(frame);
+                delivered++;
+            }
+        }
+        return delivered;
+    }
+
+  private:
+    auto stage(std::span<const uint8_t> chunk) -> size_t;
+    auto accept(std::span<const uint8_t> frame) -> bool;
+
+    std::array<uint8_t, sicp::MAX_FRAME> staging;
+    size_t staged;
+    uint64_t frames;
+    uint64_t errors;
+};
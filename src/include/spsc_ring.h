@@ -0,0 +1,81 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+/***
+ * Bounded lock-free single producer, single consumer ring, slots are written
+ * and read in place so nothing is allocated once it is built
+ */
+template <typename T> class SpscRing
+{
+  public:
+    explicit SpscRing(size_t capacity)
+        : slots(std::bit_ceil(std::max<size_t>(capacity, 2)))
+        , mask(slots.size() - 1)
+    {
+    }
+
+    // bad luck
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+    SpscRing(SpscRing&&) = delete;
+    SpscRing& operator=(SpscRing&&) = delete;
+
+    // producer thread only, fill gets the slot to write into
+    template <typename Fill> auto tryPush(Fill&& fill) -> bool
+    {
+        const size_t at = head.load(std::memory_order_relaxed);
+        if (at - tailSeen == slots.size())
+        {
+            tailSeen = tail.load(std::memory_order_acquire);
+            if (at - tailSeen == slots.size())
+            {
+                return false;
+            }
+        }
+
+        fill(slots[at & mask]);
+        head.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+    // consumer thread only, use gets the slot to read from
+    template <typename Use> auto tryPop(Use&& use) -> bool
+    {
+        const size_t at = tail.load(std::memory_order_relaxed);
+        if (at == headSeen)
+        {
+            headSeen = head.load(std::memory_order_acquire);
+            if (at == headSeen)
+            {
+                return false;
+            }
+        }
+
+        use(slots[at & mask]);
+        tail.store(at + 1, std::memory_order_release);
+        return true;
+    }
+
+    // inspectors, any thread
+    [[nodiscard]] auto capacity() const -> size_t { return slots.size(); }
+    [[nodiscard]] auto empty() const -> bool
+    {
+        return head.load(std::memory_order_acquire) ==
+               tail.load(std::memory_order_acquire);
+    }
+
+  private:
+    std::vector<T> slots;
+    const size_t mask;
+
+    // each side caches the other's index to keep cache line ping-pong down
+    alignas(64) std::atomic<size_t> head { 0 };
+    size_t tailSeen = 0;
+    alignas(64) std::atomic<size_t> tail { 0 };
+    size_t headSeen = 0;
+};
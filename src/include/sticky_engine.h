@@ -1,18 +1,45 @@
 #pragma once
 
+#include "connect_gate.h"
+#include "hot_state.h"
 #include "ioi.h"
+#include "latency_histogram.h"
+#include "metrics.h"
+#include "mpsc_queue.h"
+#include "poller.h"
+#include "rate_meter.h"
+#include "reactor.h"
+#include "resolver.h"
+#include "session_store.h"
+#include "shared_frame.h"
 #include "sticky_socket.h"
+#include "timer_wheel.h"
 
+#include <atomic>
+#include <chrono>
+#include <cstddef>
 #include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <span>
 #include <string>
 #include <vector>
 
-class StickyEngine
+class StickyEngine : public ReactorIntf
 {
   public:
-    StickyEngine(const IoIntf& useIo);
-    ~StickyEngine();
+    enum class Backend : uint8_t
+    {
+        Poll,
+        Epoll,
+        Uring,
+    };
+
+    using Command = std::function<void(StickyEngine&)>;
+
+    StickyEngine(const IoIntf& useIo, Backend useBackend = Backend::Poll);
+    ~StickyEngine() override;
 
     // bad luck
     StickyEngine(const StickyEngine&) = delete;
@@ -21,26 +48,101 @@ class StickyEngine
     StickyEngine& operator=(StickyEngine&&) = delete;
 
     // factory methods
+    template <typename T>
+    auto makeSession(std::string host, uint16_t port) -> SessionHandle
+    {
+        const auto handle = sessions.emplace<T>(io, std::move(host), port);
+        auto* skt = sessions.get(handle);
+        skt->attach(this);
+        skt->linkMetrics(&traffic, &latency);
+        hot.append(*skt);
+        if (resolver != nullptr)
+        {
+            resolve(*skt); // names of a whole fleet get looked up side by side
+        }
+        sessionCount.store(sessions.size(), std::memory_order_relaxed);
+        responses.reserve(sessions.size() + 1);
+        return handle;
+    }
+
     template <typename T> StickySocket& makeSocket(std::string host, uint16_t port)
     {
-        static_assert(
-            std::is_base_of<StickySocket, T>::value, "T must be derived from StickySocket."
-        );
-
-        auto pSocket = std::make_unique<T>(io, host, port);
-        connections.push_back(std::move(pSocket));
-        responses.reserve(connections.size());
-        return *connections.back();
+        return *sessions.get(makeSession<T>(std::move(host), port));
     }
 
+    // inspectors
+    [[nodiscard]] auto getBackend() const -> Backend;
+    [[nodiscard]] auto find(const std::string& host, uint16_t port) const
+        -> StickySocket*;
+    [[nodiscard]] auto lookup(SessionHandle handle) const -> StickySocket*;
+    [[nodiscard]] auto getSessions() const -> const SessionStore&;
+    [[nodiscard]] auto getHotState() const -> const HotState&;
+    [[nodiscard]] auto getTimerSlack() const -> std::chrono::milliseconds;
+    [[nodiscard]] auto getWakeupRate() const -> uint64_t; // per minute
+    [[nodiscard]] auto getMetrics() const -> EngineMetrics; // from any thread
+    [[nodiscard]] auto getLatency() const -> LatencyReport; // from any thread
+
     // actions
     int poll(int duration);
+    void post(Command command); // safe from any thread
+    void setTimerSlack(std::chrono::milliseconds useSlack);
+    void setResolver(Resolver* useResolver); // shared, must outlive the engine
+    void setConnectLimits(ConnectGate::Limits limits);
+    auto remove(SessionHandle handle) -> bool; // not from within that session's callbacks
+    auto broadcast(
+        std::span<const uint8_t> frame,
+        std::span<StickySocket* const> targets,
+        SharedFrame::Delivery onDelivery = {}
+    ) -> size_t;
+    auto broadcast(std::span<const uint8_t> frame, SharedFrame::Delivery onDelivery = {})
+        -> size_t;
+
+    auto admit(EasySocketIntf& skt) -> bool override;
+    void schedule(Timer& timer, Timer::Clock::time_point deadline) override;
+    void cancel(Timer& timer) override;
+    auto transmit(EasySocketIntf& skt, const std::deque<FrameRef>& queue, size_t offset)
+        -> bool override;
+
+    // notifications
+    void watch(EasySocketIntf& skt) override;
+    void forget(EasySocketIntf& skt) override;
+    void refresh(EasySocketIntf& skt) override;
+    auto resolve(EasySocketIntf& skt) -> bool override;
 
   protected:
     void rebuild_poll_params();
+    void dispatch(StickySocket& skt, const struct pollfd& response);
+    void deliver(StickySocket& skt, std::span<const uint8_t> data);
+    void complete(StickySocket& skt, int sent);
+    void drain(bool woken);
+    void admitWaiting(Timer::Clock::time_point now);
+    [[nodiscard]] auto coalesce(Timer::Clock::time_point now, int until) const -> int;
 
   private:
     const IoIntf& io;
-    std::vector<std::unique_ptr<StickySocket>> connections;
+    Backend backend;
+    TimerWheel timers;
+    std::chrono::milliseconds slack;
+    RateMeter wakeups;
+    std::unique_ptr<PollerIntf> poller;
+    SessionStore sessions;
+    HotState hot; // row i mirrors sessions.at(i)
     std::vector<struct pollfd> responses;
+    std::vector<Readiness> ready;
+    int wakeup;
+    std::atomic<bool> signalled;
+    MpscQueue<Command> commands;
+    Resolver* resolver;
+    ConnectGate gate;
+    StickySocket* admitting; // its turn came, the gate lets it through
+
+    // written by the loop only, read by whoever asks for metrics
+    TrafficCounters traffic;
+    LatencyBook latency;
+    std::atomic<uint64_t> sessionCount;
+    std::atomic<uint64_t> pollCount;
+    std::atomic<uint64_t> eventCount;
+    std::atomic<uint64_t> commandCount;
+    std::atomic<uint64_t> queueDepth;
+    std::atomic<uint64_t> deferCount;
 };
@@ -2,7 +2,9 @@
 
 #include "ioi.h"
 #include "ipv4_socket.h"
+#include "timer_wheel.h"
 
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <string>
@@ -15,7 +17,7 @@ class StickySocket : public IPv4Socket
   public:
     // numbers and types
     static constexpr size_t DEFAULT_RETRIES = 4;
-    static constexpr size_t BACKOFF_MULTIPLIER = 144;
+    static constexpr std::chrono::milliseconds BACKOFF_MULTIPLIER { 144 };
 
     // you know
     StickySocket(
@@ -25,16 +27,28 @@ class StickySocket : public IPv4Socket
         size_t retries = DEFAULT_RETRIES
     );
 
+    // inspectors
+    [[nodiscard]] auto getNextAttempt() const -> Timer::Clock::time_point;
+    [[nodiscard]] auto getAttempts() const -> size_t;
+    [[nodiscard]] auto isTrying() const -> bool;
+
     // actions
+    auto enter(ConnectionState newState) -> bool override;
     auto connect() -> bool override;
     void disconnect() override;
     auto reconnect() -> bool;
-    auto eval(const struct pollfd& response) -> bool override;
+    auto retryNow() -> bool; // skips the backoff, say because the address just arrived
     virtual auto step() -> bool;
 
   private:
+    void retryIn(std::chrono::milliseconds delay);
+    void backOffMore();
+
     bool keepTrying;
+    bool firstAttempt; // the one connect() asked for is no reconnect
     size_t maxRetries;
     size_t attempts;
-    size_t backOff;
+    std::chrono::milliseconds backOff;
+    Timer::Clock::time_point nextAttempt;
+    Timer retryTimer;
 };
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+class TimerWheel;
+
+struct TimerLink
+{
+    TimerLink* prev = this;
+    TimerLink* next = this;
+};
+
+/***
+ * Intrusive timer, owned by whoever embeds it and linked into at most one wheel
+ */
+class Timer : private TimerLink
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit Timer(std::function<void()> action);
+    ~Timer();
+
+    // bad luck
+    Timer(const Timer&) = delete;
+    Timer& operator=(const Timer&) = delete;
+    Timer(Timer&&) = delete;
+    Timer& operator=(Timer&&) = delete;
+
+    // inspectors
+    [[nodiscard]] auto isArmed() const -> bool;
+    [[nodiscard]] auto getDeadline() const -> Clock::time_point;
+
+  private:
+    friend class TimerWheel;
+
+    std::function<void()> action;
+    TimerWheel* wheel;
+    Clock::time_point deadline;
+    uint64_t tick;
+    size_t level;
+};
+
+/***
+ * Hierarchical timing wheel with O(1) schedule and cancel, ticks are absolute
+ * monotonic milliseconds so backoffs do not depend on how often we poll
+ */
+class TimerWheel
+{
+  public:
+    using Clock = Timer::Clock;
+    static constexpr size_t LEVELS = 4;
+    static constexpr size_t SLOT_BITS = 6;
+    static constexpr size_t SLOTS = 1U << SLOT_BITS;
+    static constexpr std::chrono::milliseconds RESOLUTION { 1 };
+
+    explicit TimerWheel(Clock::time_point origin = Clock::now());
+    ~TimerWheel();
+
+    // bad luck
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+    TimerWheel(TimerWheel&&) = delete;
+    TimerWheel& operator=(TimerWheel&&) = delete;
+
+    // actions
+    void schedule(Timer& timer, Clock::time_point deadline);
+    void cancel(Timer& timer);
+    auto advance(Clock::time_point now) -> size_t;
+
+    // inspectors
+    [[nodiscard]] auto size() const -> size_t;
+    [[nodiscard]] auto timeout(Clock::time_point now) const -> int;
+
+  private:
+    using Slots = std::array<TimerLink, SLOTS>;
+
+    [[nodiscard]] auto toTick(Clock::time_point deadline) const -> uint64_t;
+    void place(Timer& timer);
+    void detach(Timer& timer);
+    void cascade(size_t level);
+    auto fire(TimerLink& list) -> size_t;
+    [[nodiscard]] auto earliest() const -> uint64_t;
+
+    Clock::time_point origin;
+    uint64_t current;
+    size_t armed;
+    std::array<Slots, LEVELS> levels;
+    std::array<size_t, LEVELS> counts;
+    TimerLink due;
+};
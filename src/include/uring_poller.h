@@ -0,0 +1,124 @@
+#pragma once
+
+#include "poller.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <linux/io_uring.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+/***
+ * io_uring backend, connected sockets are read through a provided buffer ring
+ * with multishot receives and their queued output goes out as SENDMSG, so a
+ * loop costs one io_uring_enter
+ *
+ * Connects are still made by the socket and watched with POLL_ADD until they
+ * complete. Kernels without multishot receives are polled for input the same
+ * way.
+ */
+class UringPoller : public PollerIntf
+{
+  public:
+    static constexpr unsigned QUEUE_DEPTH = 1024;
+    static constexpr unsigned BUFFER_COUNT = 256;
+    static constexpr unsigned BUFFER_LENGTH = 4096;
+    static constexpr uint16_t BUFFER_GROUP = 0;
+    static constexpr size_t SEND_BATCH = 64;
+
+    UringPoller();
+    ~UringPoller() override;
+
+    // bad luck
+    UringPoller(const UringPoller&) = delete;
+    UringPoller& operator=(const UringPoller&) = delete;
+    UringPoller(UringPoller&&) = delete;
+    UringPoller& operator=(UringPoller&&) = delete;
+
+    // inspectors
+    [[nodiscard]] auto isReady() const -> bool;
+    [[nodiscard]] auto hasBufferRing() const -> bool;
+
+    // actions
+    void watch(EasySocketIntf& skt) override;
+    void forget(EasySocketIntf& skt) override;
+    void wakeOn(int fd) override;
+    auto wait(std::vector<Readiness>& ready, int timeout) -> int override;
+    auto transmit(EasySocketIntf& skt, const std::deque<FrameRef>& queue, size_t offset)
+        -> bool override;
+
+  private:
+    enum class Op : uint8_t
+    {
+        None,
+        Poll,
+        Receive,
+    };
+
+    // the kernel reads the header and the frames until the send completes
+    struct Outbox
+    {
+        std::array<struct iovec, SEND_BATCH> iov;
+        struct msghdr msg;
+        std::vector<FrameRef> frames; // empty while no send is out
+    };
+
+    struct Slot
+    {
+        EasySocketIntf* socket;
+        int fd;
+        uint32_t generation;
+        Op op;
+        std::unique_ptr<Outbox> outbox; // stays put while the slots grow
+    };
+
+    auto setupRing() -> bool;
+    auto setupBuffers() -> bool;
+    auto nextSqe() -> struct io_uring_sqe*;
+    auto submit(unsigned waitFor, int timeout) -> int;
+    void arm(uint32_t slot);
+    void armWakeup();
+    void cancel(uint32_t slot);
+    void recycle();
+    auto reap(const struct io_uring_cqe& cqe, std::vector<Readiness>& ready) -> bool;
+
+    int ring;
+    struct io_uring_params params;
+
+    // submission ring
+    void* sqMap;
+    size_t sqMapSize;
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned* sqMask;
+    unsigned* sqArray;
+    struct io_uring_sqe* sqes;
+    size_t sqesSize;
+    unsigned prepared;  // written after the tail, not yet published
+    unsigned published; // behind the tail, not yet consumed by the kernel
+
+    // completion ring
+    void* cqMap;
+    size_t cqMapSize;
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned* cqMask;
+    struct io_uring_cqe* cqes;
+
+    // provided buffers
+    struct io_uring_buf_ring* bufRing;
+    size_t bufRingSize;
+    std::vector<uint8_t> arena;
+    std::vector<uint16_t> lent;
+    bool multishot;
+
+    int wakeup;
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::unordered_map<const EasySocketIntf*, uint32_t> registered;
+};
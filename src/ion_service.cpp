@@ -3,74 +3,256 @@
 #include "ioi.h"
 #include "ion_session.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
 #include <cstdio>
 #include <cstring>
 #include <exception>
+#include <format>
+#include <string>
 #include <thread>
 
+#include <sched.h>
+#include <sys/prctl.h>
+
 constexpr int EVENT_WINDOW = 55;
-constexpr int CHILL_WINDOW = 8;
 constexpr int MAX_CONSECUTIVE_FAILS = 5;
 
-IonService::IonService(const IoIntf& useIo)
-    : engine(useIo)
-    , healthy(true)
+namespace
+{
+
+void pinToCpu(size_t shard)
+{
+    const auto cpus = std::max(std::thread::hardware_concurrency(), 1U);
+    const auto cpu = static_cast<int>(shard % cpus);
+
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    CPU_SET(cpu, &mask);
+    if (sched_setaffinity(0, sizeof(mask), &mask) < 0)
+    {
+        console::warning(
+            "Cannot pin shard {} to cpu {}, reason: {}", shard, cpu, strerror(errno)
+        );
+    }
+}
+
+void relaxTimers(std::chrono::milliseconds slack)
+{
+    // let the kernel fold our timeouts into other wakeups as well
+    const auto nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(slack);
+    if (prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(nanos.count())) < 0)
+    {
+        console::warning("Cannot set timer slack, reason: {}", strerror(errno));
+    }
+}
+
+auto shareOf(ConnectGate::Limits limits, size_t shards) -> ConnectGate::Limits
+{
+    // rounded up, a shard with a share of zero would never connect at all
+    const auto share = [shards](size_t whole) { return (whole + shards - 1) / shards; };
+    limits.maxConnecting = share(limits.maxConnecting);
+    limits.perSecond /= static_cast<double>(shards);
+    limits.burst = std::max<size_t>(share(limits.burst), 1);
+    return limits;
+}
+
+auto endpointKey(const std::string& host, uint16_t port) -> std::string
+{
+    return std::format("{}:{}", host, port);
+}
+
+} // anonymous namespace
+
+IonService::Shard::Shard(const IoIntf& useIo, StickyEngine::Backend backend)
+    : healthy(true)
+    , engine(useIo, backend)
+{
+}
+
+void IonService::Shard::makeDisplay(const std::string& host, uint16_t port)
+{
+    // a restarted shard enters again with its sessions still in place
+    if (findDisplay(host, port) != nullptr)
+    {
+        return;
+    }
+    const auto handle = engine.makeSession<IonSession>(host, port);
+    displays[endpointKey(host, port)] = handle;
+    engine.lookup(handle)->connect();
+}
+
+auto IonService::Shard::findDisplay(const std::string& host, uint16_t port)
+    -> IonSession*
+{
+    // the engine's own find() walks every session, commands come too often for that
+    auto found = displays.find(endpointKey(host, port));
+    if (found == displays.end())
+    {
+        return nullptr;
+    }
+    return static_cast<IonSession*>(engine.lookup(found->second));
+}
+
+IonService::IonService(const IoIntf& useIo, IonServiceConfig useConfig)
+    : config(useConfig)
+    , ring(useConfig.shards)
+    , resolver(useIo, useConfig.resolverThreads, useConfig.resolveTtl)
 {
+    for (size_t i = 0; i < ring.size(); i++)
+    {
+        shards.push_back(std::make_unique<Shard>(useIo, config.backend));
+        shards.back()->engine.setTimerSlack(config.timerSlack);
+        shards.back()->engine.setResolver(&resolver);
+        shards.back()->engine.setConnectLimits(shareOf(config.connectLimits, ring.size()));
+    }
 }
 
 IonService::~IonService() { stop(); }
 
 void IonService::start(std::stop_token superToken)
 {
-    if (worker.joinable())
+    if (isRunning())
     {
         console::warning("service is already running, start ignored.\n");
         return;
     }
-    worker = std::jthread([this, superToken]() { loop(superToken); });
+
+    for (size_t i = 0; i < shards.size(); i++)
+    {
+        shards[i]->worker = std::jthread(
+            [this, i, superToken](std::stop_token own)
+        {
+            // either stop() or the supervisor ends the loop, and wakes it to notice
+            std::stop_source either;
+            auto wake = [this, i, &either]()
+            {
+                either.request_stop();
+                shards[i]->engine.post([](StickyEngine&) {});
+            };
+            std::stop_callback onStop(own, wake);
+            std::stop_callback onSuperStop(superToken, wake);
+            loop(i, either.get_token());
+        }
+        );
+    }
 }
 
 int IonService::setup()
 {
     CONSOLE_TRACE("pass config someday");
+
+    bool empty = true;
+    for (const auto& shard : shards)
+    {
+        empty = empty && shard->endpoints.empty();
+    }
+    if (empty)
+    {
+        addDisplay("127.0.0.1", 5000);
+    }
     return 0;
 }
 
+void IonService::addDisplay(std::string host, uint16_t port)
+{
+    auto& shard = *shards.at(shardOf(host, port));
+    resolver.prefetch(host, port); // under way while the shards start
+    if (shard.worker.joinable())
+    {
+        // endpoints belong to the worker now, let it make the session itself
+        shard.engine.post([&shard, host = std::move(host), port](StickyEngine&)
+        { shard.makeDisplay(host, port); });
+        return;
+    }
+    shard.endpoints.push_back(Endpoint { .host = std::move(host), .port = port });
+}
+
+void IonService::submit(
+    std::string host, uint16_t port, std::function<void(IonSession&)> command
+)
+{
+    auto& shard = *shards.at(shardOf(host, port));
+    shard.engine.post(
+        [&shard, host = std::move(host), port, command = std::move(command)](StickyEngine&)
+    {
+        auto* pSession = shard.findDisplay(host, port);
+        if (pSession == nullptr)
+        {
+            console::warning("No display at {}:{}, command dropped.", host, port);
+            return;
+        }
+        command(*pSession);
+    }
+    );
+}
+
 void IonService::stop()
 {
-    if (worker.joinable())
+    bool stopped = false;
+    for (auto& shard : shards)
+    {
+        if (shard->worker.joinable())
+        {
+            shard->worker.request_stop();
+        }
+    }
+    for (auto& shard : shards)
+    {
+        if (shard->worker.joinable())
+        {
+            shard->worker.join();
+            stopped = true;
+        }
+    }
+
+    if (stopped)
     {
-        worker.request_stop();
-        worker.join();
         console::info("Service stopped gracefully.");
     }
 }
 
-void IonService::onEntry()
+void IonService::onEntry(size_t shard)
 {
-    CONSOLE_TRACE("soon");
+    CONSOLE_TRACE(shard);
 
-    auto& pSession = engine.makeSocket<IonSession>("127.0.0.1", 5000);
-    pSession.connect();
+    auto& current = *shards.at(shard);
+    for (const auto& [host, port] : current.endpoints)
+    {
+        current.makeDisplay(host, port);
+    }
 }
 
-void IonService::onExit() { CONSOLE_TRACE("just now"); }
+void IonService::onExit(size_t shard) { CONSOLE_TRACE(shard); }
 
-void IonService::loop(std::stop_token token)
+void IonService::loop(size_t shard, std::stop_token token)
 {
     CONSOLE_TRACE(token.stop_possible());
 
-    console::info("Enter event loop.");
-    onEntry();
+    if (config.pinThreads)
+    {
+        pinToCpu(shard);
+    }
+
+    if (config.timerSlack.count() > 0)
+    {
+        relaxTimers(config.timerSlack);
+    }
+
+    // tickless loops sleep until a timer, a socket or a posted command needs them
+    const int window = config.tickless ? -1 : EVENT_WINDOW;
+    auto& current = *shards.at(shard);
+    console::info("Enter event loop of shard {}.", shard);
+    onEntry(shard);
 
     int failCount = 0;
     while (!token.stop_requested())
     {
         try
         {
-            healthy = true;
-            engine.poll(EVENT_WINDOW);
+            current.healthy = true;
+            current.engine.poll(window);
 
             if (failCount)
             {
@@ -89,15 +271,70 @@ void IonService::loop(std::stop_token token)
                 break;
             }
         }
-        std::this_thread::sleep_for(std::chrono::milliseconds(CHILL_WINDOW));
     }
 
-    console::info("Exit event loop.");
-    onExit();
+    console::info("Exit event loop of shard {}.", shard);
+    onExit(shard);
 }
 
-void IonService::resetHealth() { healthy.store(false); }
+void IonService::resetHealth()
+{
+    for (auto& shard : shards)
+    {
+        shard->healthy.store(false);
+        if (shard->worker.joinable())
+        {
+            // a tickless worker only proves it is alive when woken up
+            shard->engine.post([](StickyEngine&) {});
+        }
+    }
+}
+
+auto IonService::isHealthy() const -> bool
+{
+    return std::ranges::all_of(shards, [](const auto& shard)
+    { return shard->healthy.load(); });
+}
+
+auto IonService::isRunning() const -> bool
+{
+    return std::ranges::any_of(shards, [](const auto& shard)
+    { return shard->worker.joinable(); });
+}
+
+auto IonService::shardCount() const -> size_t { return shards.size(); }
+
+auto IonService::shardOf(const std::string& host, uint16_t port) const -> size_t
+{
+    return ring.pick(host + ":" + std::to_string(port));
+}
 
-auto IonService::isHealthy() const -> bool { return healthy; }
+auto IonService::getMetrics() const -> EngineMetrics
+{
+    EngineMetrics total;
+    for (const auto& shard : shards)
+    {
+        total += shard->engine.getMetrics();
+    }
+    return total;
+}
 
-auto IonService::isRunning() const -> bool { return worker.joinable(); }
+auto IonService::getLatency() const -> LatencyReport
+{
+    LatencyReport total;
+    for (const auto& shard : shards)
+    {
+        total += shard->engine.getLatency();
+    }
+    return total;
+}
+
+auto IonService::wakeupsPerMinute() const -> uint64_t
+{
+    uint64_t total = 0;
+    for (const auto& shard : shards)
+    {
+        total += shard->engine.getWakeupRate();
+    }
+    return total;
+}
@@ -1,20 +1,323 @@
 #include "console.h"
 #include "ion_session.h"
+#include "reactor.h"
 #include "sticky_socket.h"
+#include <algorithm>
+#include <array>
 #include <cstdint>
 #include <string_view>
+#include <utility>
 
 using namespace std::literals;
 
+namespace
+{
+
+// SICP answers a command with a single status byte in place of data
+constexpr uint8_t SICP_ACK = 0x06;
+constexpr uint8_t SICP_NACK = 0x15;
+constexpr uint8_t SICP_NAV = 0x18;
+constexpr size_t SICP_DATA_OFFSET = 3;
+
+auto classify(std::span<const uint8_t> frame) -> IonSession::ReplyStatus
+{
+    if (frame.size() == sicp::MIN_FRAME + 2)
+    {
+        switch (frame[SICP_DATA_OFFSET])
+        {
+        case SICP_ACK:
+            return IonSession::ReplyStatus::Ack;
+        case SICP_NACK:
+            return IonSession::ReplyStatus::Nack;
+        case SICP_NAV:
+            return IonSession::ReplyStatus::Nav;
+        default:
+            break;
+        }
+    }
+    return IonSession::ReplyStatus::Data;
+}
+
+auto repliesTo(std::span<const uint8_t> frame, uint8_t control, uint8_t group) -> bool
+{
+    // a reply echoes the control and group of the request it answers
+    return frame.size() > SICP_DATA_OFFSET && frame[1] == control && frame[2] == group;
+}
+
+} // anonymous namespace
+
 IonSession::IonSession(const IoIntf& useIo, std::string host, uint16_t port)
     : StickySocket(useIo, host, port)
+    , window(DEFAULT_WINDOW)
+    , requestTimeout(DEFAULT_REQUEST_TIMEOUT)
+    , lastId(NO_REQUEST)
+    , timeoutTimer([this]() { expire(); })
+    , closing(false)
 {
     CONSOLE_TRACE(host);
 }
 
+IonSession::~IonSession()
+{
+    // the base destructor disconnects without reaching our wentOffline() any more
+    closing = true;
+    if (auto* reactor = getReactor())
+    {
+        reactor->cancel(timeoutTimer);
+    }
+    failAll(waiting, ReplyStatus::Dropped);
+    failAll(backlog, ReplyStatus::Dropped);
+
+    // nothing will bring these online any more, let their frames go
+    for (auto handle : onlineWaiters)
+    {
+        handle.destroy();
+    }
+}
+
+auto IonSession::getDecoder() const -> const SicpDecoder& { return decoder; }
+
+auto IonSession::inFlight() const -> size_t { return waiting.size(); }
+
+auto IonSession::queued() const -> size_t { return backlog.size(); }
+
+void IonSession::setWindow(size_t size) { window = std::max<size_t>(size, 1); }
+
+void IonSession::setRequestTimeout(std::chrono::milliseconds timeout)
+{
+    requestTimeout = timeout;
+}
+
+auto IonSession::sendFrame(uint8_t control, uint8_t group, std::span<const uint8_t> data)
+    -> int
+{
+    std::array<uint8_t, sicp::MAX_FRAME> frame {};
+    const size_t length = sicp::encode(frame, control, group, data);
+    if (length == 0)
+    {
+        console::error("{} bytes do not fit in a SICP frame.", data.size());
+        return -1;
+    }
+    return send(std::span(frame).first(length));
+}
+
+auto IonSession::request(
+    uint8_t control, uint8_t group, std::span<const uint8_t> data, ReplyHandler onReply
+) -> RequestId
+{
+    if (state != ConnectionState::Connected || closing)
+    {
+        console::error("Cannot request from {} while not connected.", host);
+        return NO_REQUEST;
+    }
+
+    if (backlog.size() >= BACKLOG_LIMIT)
+    {
+        console::warning("Request backlog of {} is full.", host);
+        return NO_REQUEST;
+    }
+
+    std::vector<uint8_t> frame(sicp::MAX_FRAME);
+    const size_t length = sicp::encode(frame, control, group, data);
+    if (length == 0)
+    {
+        console::error("{} bytes do not fit in a SICP frame.", data.size());
+        return NO_REQUEST;
+    }
+    frame.resize(length);
+    if (auto* book = getLatencyBook())
+    {
+        book->prepare(group);
+    }
+
+    Pending pending {
+        .id = ++lastId,
+        .onReply = std::move(onReply),
+        .frame = std::move(frame),
+        .control = control,
+        .group = group,
+        .sentAt = {},
+        .deadline = {},
+    };
+    const RequestId id = pending.id;
+    if (waiting.size() < window && backlog.empty())
+    {
+        transmit(std::move(pending));
+    }
+    else
+    {
+        backlog.push_back(std::move(pending));
+    }
+    return id;
+}
+
+auto IonSession::connected() -> OnlineAwaiter { return OnlineAwaiter(*this); }
+
+auto IonSession::request(uint8_t control, uint8_t group, std::span<const uint8_t> data)
+    -> ReplyAwaiter
+{
+    return {*this, control, group, data};
+}
+
+auto IonSession::sleepFor(std::chrono::milliseconds delay) -> SleepAwaiter
+{
+    return {getReactor(), delay};
+}
+
+IonSession::OnlineAwaiter::OnlineAwaiter(IonSession& useSession)
+    : session(useSession)
+{
+}
+
+auto IonSession::OnlineAwaiter::await_ready() const -> bool
+{
+    return session.state == ConnectionState::Connected;
+}
+
+void IonSession::OnlineAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    session.onlineWaiters.push_back(handle);
+}
+
+IonSession::ReplyAwaiter::ReplyAwaiter(
+    IonSession& useSession, uint8_t useControl, uint8_t useGroup,
+    std::span<const uint8_t> useData
+)
+    : session(useSession)
+    , control(useControl)
+    , group(useGroup)
+    , data(useData)
+    , reply {.status = ReplyStatus::Dropped, .frame = {}}
+    , suspending(false)
+    , answered(false)
+{
+}
+
+auto IonSession::ReplyAwaiter::await_suspend(std::coroutine_handle<> handle) -> bool
+{
+    // a failed send answers from inside request(), so the coroutine must not suspend
+    suspending = true;
+    const RequestId id = session.request(
+        control, group, data,
+        [this, handle](ReplyStatus status, std::span<const uint8_t> frame)
+        {
+            reply.status = status;
+            reply.frame.assign(frame.begin(), frame.end());
+            answered = true;
+            if (!suspending)
+            {
+                handle.resume();
+            }
+        }
+    );
+    suspending = false;
+    return id != NO_REQUEST && !answered;
+}
+
+auto IonSession::ReplyAwaiter::await_resume() -> Reply { return std::move(reply); }
+
+void IonSession::transmit(Pending pending)
+{
+    if (send(pending.frame) < 0 || state != ConnectionState::Connected)
+    {
+        pending.onReply(ReplyStatus::Dropped, {});
+        return;
+    }
+
+    pending.frame = {};
+    pending.sentAt = Timer::Clock::now();
+    pending.deadline = pending.sentAt + requestTimeout;
+    waiting.push_back(std::move(pending));
+    if (waiting.size() == 1)
+    {
+        armTimeout();
+    }
+}
+
+void IonSession::pump()
+{
+    while (!backlog.empty() && waiting.size() < window &&
+           state == ConnectionState::Connected)
+    {
+        Pending next = std::move(backlog.front());
+        backlog.pop_front();
+        transmit(std::move(next));
+    }
+}
+
+void IonSession::armTimeout()
+{
+    auto* reactor = getReactor();
+    if (reactor == nullptr)
+    {
+        return;
+    }
+
+    // replies come in order, so only the oldest request can be the next to expire
+    if (waiting.empty())
+    {
+        reactor->cancel(timeoutTimer);
+    }
+    else
+    {
+        reactor->schedule(timeoutTimer, waiting.front().deadline);
+    }
+}
+
+void IonSession::expire()
+{
+    if (waiting.empty() || Timer::Clock::now() < waiting.front().deadline)
+    {
+        armTimeout();
+        return;
+    }
+
+    // a missing reply leaves no way to tell which request the next one answers
+    console::warning("{} did not answer in time, resetting the connection.", host);
+    failAll(waiting, ReplyStatus::Timeout);
+    IPv4Socket::disconnect();
+}
+
+void IonSession::failAll(std::deque<Pending>& requests, ReplyStatus status)
+{
+    auto failed = std::move(requests);
+    requests.clear();
+    for (auto& pending : failed)
+    {
+        pending.onReply(status, {});
+    }
+}
+
 void IonSession::didReceived(std::span<const uint8_t> data)
 {
-    console::info("got {} bytes", data.size());
+    decoder.feed(data, [this](std::span<const uint8_t> frame) { onFrame(frame); });
+}
+
+void IonSession::onFrame(std::span<const uint8_t> frame)
+{
+    tally(TrafficCounters::Counter::FramesIn);
+    if (waiting.empty() ||
+        !repliesTo(frame, waiting.front().control, waiting.front().group))
+    {
+        tally(TrafficCounters::Counter::Unsolicited);
+        didReceiveFrame(frame);
+        return;
+    }
+
+    Pending answered = std::move(waiting.front());
+    waiting.pop_front();
+    if (auto* book = getLatencyBook())
+    {
+        book->recordReply(answered.group, Timer::Clock::now() - answered.sentAt);
+    }
+    armTimeout();
+    pump();
+    answered.onReply(classify(frame), frame);
+}
+
+void IonSession::didReceiveFrame(std::span<const uint8_t> frame)
+{
+    console::debug("got frame of {} bytes", frame.size());
 }
 
 void IonSession::wentOnline()
@@ -22,6 +325,30 @@ void IonSession::wentOnline()
     console::info("connected");
     const std::string_view text { "hello"sv };
     send(std::span{reinterpret_cast<const uint8_t *>(text.data()), text.size()});
+
+    // a resumed workflow may drop the connection again, leaving later ones waiting
+    auto resuming = std::move(onlineWaiters);
+    onlineWaiters.clear();
+    for (auto handle : resuming)
+    {
+        if (state != ConnectionState::Connected)
+        {
+            onlineWaiters.push_back(handle);
+            continue;
+        }
+        handle.resume();
+    }
 }
 
-void IonSession::wentOffline() { console::info("disconnected"); }
+void IonSession::wentOffline()
+{
+    // a half frame from the old connection would poison the next one
+    decoder.reset();
+    if (auto* reactor = getReactor())
+    {
+        reactor->cancel(timeoutTimer);
+    }
+    failAll(waiting, ReplyStatus::Dropped);
+    failAll(backlog, ReplyStatus::Dropped);
+    console::info("disconnected");
+}
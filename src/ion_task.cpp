@@ -0,0 +1,59 @@
+#include "console.h"
+#include "frame_pool.h"
+#include "ion_task.h"
+#include "reactor.h"
+#include <chrono>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+
+auto IonTask::promise_type::operator new(size_t size) -> void*
+{
+    return FramePool::local().allocate(size);
+}
+
+void IonTask::promise_type::operator delete(void* frame, size_t size)
+{
+    FramePool::local().release(frame, size);
+}
+
+void IonTask::promise_type::unhandled_exception()
+{
+    // nobody awaits a detached workflow, so the event loop must not see this
+    try
+    {
+        std::rethrow_exception(std::current_exception());
+    }
+    catch (const std::exception& e)
+    {
+        console::error("Workflow failed: {}", e.what());
+    }
+    catch (...)
+    {
+        console::error("Workflow failed.");
+    }
+}
+
+SleepAwaiter::SleepAwaiter(ReactorIntf* useReactor, std::chrono::milliseconds useDelay)
+    : reactor(useReactor)
+    , delay(useDelay)
+    , wake([this]() { waiter.resume(); })
+{
+}
+
+auto SleepAwaiter::await_ready() const -> bool
+{
+    // without a loop there is nothing to wake us up, so just carry on
+    return reactor == nullptr || delay.count() <= 0;
+}
+
+void SleepAwaiter::await_suspend(std::coroutine_handle<> handle)
+{
+    waiter = handle;
+    reactor->schedule(wake, Timer::Clock::now() + delay);
+}
+
+auto sleepFor(ReactorIntf& reactor, std::chrono::milliseconds delay) -> SleepAwaiter
+{
+    return {&reactor, delay};
+}
@@ -1,4 +1,5 @@
 #include "ipv4_socket.h"
+#include "buffer_pool.h"
 #include "console.h"
 #include "easy_socket.h"
 #include "ioi.h"
@@ -10,23 +11,51 @@
 #include <netinet/in.h>
 #include <sys/poll.h>
 #include <sys/socket.h>
+#include <sys/uio.h>
 #include <unistd.h>
 
+#include <algorithm>
+#include <array>
 #include <cerrno>
 #include <cstring>
+#include <utility>
+#include <vector>
 
 IPv4Socket::IPv4Socket(const IoIntf& ioRef, std::string host, uint16_t port)
     : EasySocketIntf(std::move(host), port)
     , io(ioRef)
-    , rxBuffer()
+    , reactor(nullptr)
+    , rxSize(BUFFER_SIZE)
+    , address {}
+    , addressExpires {}
+    , resolved(false)
+    , txOffset(0)
+    , txBytes(0)
+    , txArmed(false)
+    , txInFlight(false)
+    , parentTraffic(nullptr)
+    , latencyBook(nullptr)
 {
-    rxBuffer.fill(0);
 }
 
 IPv4Socket::IPv4Socket(IPv4Socket&& other) noexcept
     : EasySocketIntf(std::move(other.host), other.port)
     , io(other.io)
-    , rxBuffer(other.rxBuffer)
+    , reactor(other.reactor)
+    , rxLease(std::move(other.rxLease))
+    , rxSize(other.rxSize)
+    , address(other.address)
+    , addressExpires(other.addressExpires)
+    , resolved(other.resolved)
+    , txQueue(std::move(other.txQueue))
+    , txOffset(other.txOffset)
+    , txBytes(other.txBytes)
+    , txArmed(other.txArmed)
+    , txInFlight(other.txInFlight)
+    , parentTraffic(other.parentTraffic)
+    , onlineSince(other.onlineSince)
+    , latencyBook(other.latencyBook)
+    , connectStarted(other.connectStarted)
 {
 }
 
@@ -38,6 +67,87 @@ IPv4Socket::~IPv4Socket()
     }
 }
 
+auto IPv4Socket::interest() const -> short
+{
+    switch (state)
+    {
+    case ConnectionState::Connecting:
+        return POLLOUT;
+    case ConnectionState::Connected:
+        // asking for POLLOUT with nothing to write only makes busy wakeups
+        return (txBytes > 0 && !txInFlight) ? (POLLIN | POLLPRI | POLLOUT)
+                                            : (POLLIN | POLLPRI);
+    default:
+        return 0;
+    }
+}
+
+auto IPv4Socket::pendingBytes() const -> size_t { return txBytes; }
+
+auto IPv4Socket::getReceiveSize() const -> size_t { return rxSize; }
+
+void IPv4Socket::attach(ReactorIntf* useReactor) { reactor = useReactor; }
+
+auto IPv4Socket::getMetrics() const -> TrafficMetrics { return traffic.snapshot(); }
+
+void IPv4Socket::linkMetrics(TrafficCounters* parent, LatencyBook* latency)
+{
+    parentTraffic = parent;
+    latencyBook = latency;
+}
+
+auto IPv4Socket::isResolved() const -> bool { return resolved; }
+
+auto IPv4Socket::getAddress() const -> const SocketAddress& { return address; }
+
+void IPv4Socket::useAddresses(const Resolver::Resolution& resolution)
+{
+    const auto found = std::ranges::find_if(
+        resolution.addresses,
+        [](const SocketAddress& candidate) { return candidate.family() == AF_INET; }
+    );
+    if (found == resolution.addresses.end())
+    {
+        if (!resolution.addresses.empty())
+        {
+            console::warning("{} has no IPv4 address.", host);
+        }
+        return;
+    }
+
+    useAddress(*found, resolution.expires);
+}
+
+void IPv4Socket::useAddress(
+    const SocketAddress& chosen, Resolver::Clock::time_point expires
+)
+{
+    address = chosen;
+    addressExpires = expires;
+    resolved = true;
+}
+
+auto IPv4Socket::getLatencyBook() const -> LatencyBook* { return latencyBook; }
+
+void IPv4Socket::tally(TrafficCounters::Counter counter, uint64_t amount)
+{
+    traffic.add(counter, amount);
+    if (parentTraffic != nullptr)
+    {
+        parentTraffic->add(counter, amount);
+    }
+}
+
+void IPv4Socket::setReceiveSize(size_t size)
+{
+    rxSize = std::max<size_t>(size, 1);
+    rxLease.reset();
+}
+
+auto IPv4Socket::getIo() const -> const IoIntf& { return io; }
+
+auto IPv4Socket::getReactor() const -> ReactorIntf* { return reactor; }
+
 auto IPv4Socket::enter(const ConnectionState newState) -> bool
 {
     if (state == newState)
@@ -45,7 +155,36 @@ auto IPv4Socket::enter(const ConnectionState newState) -> bool
         return false;
     }
 
+    const ConnectionState last { state };
     state = newState;
+    if (state == ConnectionState::Disconnected)
+    {
+        dropPending();
+    }
+    track(last);
+    txArmed = (state == ConnectionState::Connected) && txBytes > 0 && !txInFlight;
+    if (reactor)
+    {
+        if (state == ConnectionState::Disconnected)
+        {
+            reactor->forget(*this);
+        }
+        else
+        {
+            reactor->watch(*this);
+        }
+    }
+    if (state == ConnectionState::Disconnected && descriptor != INVALID_SOCKET)
+    {
+        // a dead descriptor keeps reporting POLLERR, and the next connect would leak it
+        io.close(descriptor);
+        descriptor = INVALID_SOCKET;
+        if (reactor)
+        {
+            reactor->refresh(*this);
+        }
+    }
+
     if (state == ConnectionState::Connected)
     {
         wentOnline();
@@ -58,6 +197,36 @@ auto IPv4Socket::enter(const ConnectionState newState) -> bool
     return true;
 }
 
+void IPv4Socket::track(ConnectionState last)
+{
+    const auto now = TrafficCounters::Clock::now();
+    if (state == ConnectionState::Connected)
+    {
+        if (last == ConnectionState::Connecting && latencyBook != nullptr)
+        {
+            latencyBook->recordConnect(now - connectStarted);
+        }
+        onlineSince = now;
+        traffic.wentOnline(now);
+        if (parentTraffic != nullptr)
+        {
+            parentTraffic->wentOnline(now);
+        }
+    }
+    else if (last == ConnectionState::Connected)
+    {
+        traffic.wentOffline(onlineSince, now);
+        if (parentTraffic != nullptr)
+        {
+            parentTraffic->wentOffline(onlineSince, now);
+        }
+    }
+    else if (last == ConnectionState::Connecting)
+    {
+        tally(TrafficCounters::Counter::ConnectFailures);
+    }
+}
+
 auto IPv4Socket::eval(const struct pollfd& response) -> bool
 {
     if (state == ConnectionState::Disconnected)
@@ -72,44 +241,56 @@ auto IPv4Socket::eval(const struct pollfd& response) -> bool
     {
         enter(ConnectionState::Disconnected);
     }
-    else if (response.revents & (POLLIN | POLLPRI))
+    else
+    {
+        if (response.revents & (POLLIN | POLLPRI))
+        {
+            canReceive();
+        }
+        if ((response.revents & POLLOUT) && state != ConnectionState::Disconnected)
+        {
+            canSend();
+        }
+    }
+
+    return (state != last);
+}
+
+auto IPv4Socket::ingest(std::span<const uint8_t> data) -> bool
+{
+    if (state != ConnectionState::Connected)
     {
-        canReceive();
+        return false;
     }
-    else if (response.revents & POLLOUT)
+
+    if (data.empty())
     {
-        canSend();
+        return enter(ConnectionState::Disconnected);
     }
 
-    return (state != last);
+    tally(TrafficCounters::Counter::BytesIn, data.size());
+    didReceived(data);
+    return false;
 }
 
 void IPv4Socket::canReceive()
 {
     if (state == ConnectionState::Connected)
     {
-        auto data = receive();
-        if (data.empty())
-        {
-            enter(ConnectionState::Disconnected);
-        }
-        else
-        {
-            didReceived(data);
-        }
+        ingest(receive());
+        rxLease.reset();
     }
 }
 
 void IPv4Socket::canSend()
 {
-    static int error = 0;
-    static socklen_t len = sizeof(error);
-
     if (state == ConnectionState::Connecting)
     {
-        // WARN: POLLOUT is not enough
-        error = io.getsockopt(descriptor, SOL_SOCKET, SO_ERROR, &error, &len);
-        if (error == 0)
+        // POLLOUT is not enough, a refused connect is writable too
+        int error = 0;
+        socklen_t len = sizeof(error);
+        if (io.getsockopt(descriptor, SOL_SOCKET, SO_ERROR, &error, &len) == 0 &&
+            error == 0)
         {
             enter(ConnectionState::Connected);
         }
@@ -118,6 +299,10 @@ void IPv4Socket::canSend()
             enter(ConnectionState::Disconnected);
         }
     }
+    else if (state == ConnectionState::Connected)
+    {
+        flush();
+    }
 }
 
 auto IPv4Socket::connect() -> bool
@@ -128,47 +313,81 @@ auto IPv4Socket::connect() -> bool
         return false;
     }
 
-    // validate server IP address
-    struct sockaddr_in serverAddr {
-        .sin_family = AF_INET,
-        .sin_port = htons(port),
-        .sin_addr = { .s_addr = INADDR_ANY },
-    };
+    return !awaitsAddress() && dial();
+}
 
-    if (io.inet_pton(AF_INET, host.c_str(), &serverAddr.sin_addr) <= 0)
+auto IPv4Socket::dial() -> bool
+{
+    if (!resolved)
     {
-        console::error("address {} is invalid or not supported.", host);
+        console::error("address {} is invalid or not resolved yet.", host);
         return false;
     }
 
-    // create non-blocking socket
-    descriptor = io.socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+    connectStarted = TrafficCounters::Clock::now();
+    descriptor = openAttempt();
     if (descriptor == INVALID_SOCKET)
     {
-        console::error("Cannot create socket, reason: {}", strerror(errno));
+        tally(TrafficCounters::Counter::ConnectFailures);
         return false;
     }
 
-    // open socket connection
-    int err = io.connect(
-        descriptor, reinterpret_cast<struct sockaddr*>(&serverAddr), sizeof(serverAddr)
-    );
+    enter(ConnectionState::Connecting);
+    return true;
+}
 
-    if (err == -1 && errno != EINPROGRESS)
+auto IPv4Socket::awaitsAddress() -> bool
+{
+    // parse a literal address once, names come from the reactor's resolver
+    SocketAddress literal {};
+    if (!resolved && Resolver::parseNumeric(io, host, port, literal))
     {
-        console::error("failed to connect to {} (code: {}).", host, errno);
-        descriptor = INVALID_SOCKET;
-        return false;
+        useAddresses(Resolver::Resolution {
+            .addresses = { literal }, .expires = Resolver::Clock::time_point::max(),
+        });
+    }
+    else if (reactor && (!resolved || addressExpires <= Resolver::Clock::now()))
+    {
+        // an expired address still serves while the new one is looked up
+        if (reactor->resolve(*this) && !resolved)
+        {
+            console::debug("waiting for the address of {}.", host);
+            return true;
+        }
     }
+    return false;
+}
 
-    enter(ConnectionState::Connecting);
-    return true;
+auto IPv4Socket::openAttempt() -> int { return openTo(address); }
+
+auto IPv4Socket::openTo(const SocketAddress& target) -> int
+{
+    // create non-blocking socket
+    const int fd = io.socket(target.family(), SOCK_STREAM | SOCK_NONBLOCK, 0);
+    if (fd == INVALID_SOCKET)
+    {
+        console::error("Cannot create socket, reason: {}", strerror(errno));
+        return INVALID_SOCKET;
+    }
+
+    // open socket connection
+    if (io.connect(fd, target.get(), target.length) == -1 && errno != EINPROGRESS)
+    {
+        console::error("failed to connect to {} (code: {}).", host, errno);
+        io.close(fd);
+        return INVALID_SOCKET;
+    }
+    return fd;
 }
 
 void IPv4Socket::disconnect()
 {
     if (descriptor != INVALID_SOCKET)
     {
+        if (reactor)
+        {
+            reactor->forget(*this);
+        }
         io.close(descriptor);
         descriptor = INVALID_SOCKET;
         console::debug("(closed)");
@@ -179,22 +398,280 @@ void IPv4Socket::disconnect()
 
 auto IPv4Socket::send(std::span<const uint8_t> buffer) -> int
 {
-    return io.send(descriptor, buffer.data(), buffer.size(), 0);
+    if (buffer.empty())
+    {
+        return 0;
+    }
+    if (state != ConnectionState::Connected || !txQueue.empty())
+    {
+        return send(SharedFrame::make(buffer));
+    }
+
+    // nothing queued, so try the wire first and only copy what it did not take
+    struct iovec single {
+        .iov_base = const_cast<uint8_t*>(buffer.data()), .iov_len = buffer.size(),
+    };
+    const ssize_t written = io.writev(descriptor, &single, 1);
+    if (written < 0)
+    {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            tally(TrafficCounters::Counter::SendStalls);
+        }
+        else if (errno != EINTR)
+        {
+            console::error("Cannot send to {}, reason: {}", host, strerror(errno));
+            enter(ConnectionState::Disconnected);
+            return -1;
+        }
+        // the whole frame waits for POLLOUT
+        const int queued = enqueue(SharedFrame::make(buffer), false);
+        armOutput();
+        return queued;
+    }
+
+    const auto taken = static_cast<size_t>(written);
+    tally(TrafficCounters::Counter::BytesOut, taken);
+    if (taken == buffer.size())
+    {
+        tally(TrafficCounters::Counter::FramesOut);
+        return static_cast<int>(buffer.size());
+    }
+
+    // flush() counts the frame once the rest of it is out
+    if (enqueue(SharedFrame::make(buffer.subspan(taken)), true) < 0)
+    {
+        return -1;
+    }
+    return static_cast<int>(buffer.size());
+}
+
+auto IPv4Socket::send(FrameRef frame) -> int
+{
+    if (state != ConnectionState::Connected)
+    {
+        console::error("Cannot send to {} while not connected.", host);
+        refuse(frame);
+        return -1;
+    }
+    return enqueue(std::move(frame), true);
+}
+
+auto IPv4Socket::enqueue(FrameRef frame, bool writeNow) -> int
+{
+    const size_t size = frame->size();
+    if (txBytes + size > TX_QUEUE_LIMIT)
+    {
+        console::warning("Transmit queue of {} is full, {} bytes dropped.", host, size);
+        refuse(frame);
+        return -1;
+    }
+
+    if (size == 0)
+    {
+        frame->delivered(*this, true);
+        return 0;
+    }
+
+    txQueue.push_back(std::move(frame));
+    txBytes += size;
+
+    // frames queued behind others go out when POLLOUT says so
+    if (writeNow && txQueue.size() == 1)
+    {
+        flush();
+    }
+    return static_cast<int>(size);
+}
+
+void IPv4Socket::refuse(const FrameRef& frame)
+{
+    if (frame)
+    {
+        frame->delivered(*this, false);
+    }
+}
+
+auto IPv4Socket::flush() -> bool
+{
+    if (txInFlight)
+    {
+        return false; // transmitted() goes on with the rest
+    }
+    if (txBytes > 0 && reactor && reactor->transmit(*this, txQueue, txOffset))
+    {
+        txInFlight = true;
+        armOutput();
+        return false;
+    }
+
+    // completions run once the queue is consistent again, they may well send more
+    std::vector<FrameRef> sent;
+    while (txBytes > 0)
+    {
+        std::array<struct iovec, TX_BATCH> batch {};
+        size_t count = 0;
+        size_t offset = txOffset;
+        for (const auto& frame : txQueue)
+        {
+            if (count == batch.size())
+            {
+                break;
+            }
+            // writev does not write through iov_base, the frame stays immutable
+            const auto bytes = frame->bytes().subspan(offset);
+            batch.at(count++) = iovec {
+                .iov_base = const_cast<uint8_t*>(bytes.data()),
+                .iov_len = bytes.size(),
+            };
+            offset = 0;
+        }
+
+        const ssize_t written =
+            io.writev(descriptor, batch.data(), static_cast<int>(count));
+        if (written < 0)
+        {
+            if (errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                tally(TrafficCounters::Counter::SendStalls);
+                break;
+            }
+            if (errno == EINTR)
+            {
+                break;
+            }
+            console::error("Cannot send to {}, reason: {}", host, strerror(errno));
+            enter(ConnectionState::Disconnected);
+            break;
+        }
+
+        retire(static_cast<size_t>(written), sent);
+        if (static_cast<size_t>(written) == 0)
+        {
+            break;
+        }
+    }
+
+    armOutput();
+    const bool done = txBytes == 0 && state == ConnectionState::Connected;
+    for (const auto& frame : sent)
+    {
+        frame->delivered(*this, true);
+    }
+    return done;
+}
+
+auto IPv4Socket::transmitted(int sent) -> bool
+{
+    if (!txInFlight || state != ConnectionState::Connected)
+    {
+        return false;
+    }
+
+    txInFlight = false;
+    if (sent < 0 && sent != -EAGAIN && sent != -EINTR && sent != -ECANCELED)
+    {
+        console::error("Cannot send to {}, reason: {}", host, strerror(-sent));
+        return enter(ConnectionState::Disconnected);
+    }
+
+    std::vector<FrameRef> done;
+    if (sent > 0)
+    {
+        retire(static_cast<size_t>(sent), done);
+    }
+    else if (sent == -EAGAIN)
+    {
+        tally(TrafficCounters::Counter::SendStalls);
+    }
+    flush();
+    for (const auto& frame : done)
+    {
+        frame->delivered(*this, true);
+    }
+    return false;
+}
+
+void IPv4Socket::retire(size_t written, std::vector<FrameRef>& sent)
+{
+    // retire whatever went out, keep the position inside a partial frame
+    auto left = written;
+    txBytes -= left;
+    tally(TrafficCounters::Counter::BytesOut, left);
+    while (left > 0)
+    {
+        const size_t rest = txQueue.front()->size() - txOffset;
+        if (left < rest)
+        {
+            txOffset += left;
+            break;
+        }
+        left -= rest;
+        txOffset = 0;
+        tally(TrafficCounters::Counter::FramesOut);
+        if (txQueue.front()->wantsDelivery())
+        {
+            sent.push_back(std::move(txQueue.front()));
+        }
+        txQueue.pop_front();
+    }
+}
+
+void IPv4Socket::armOutput()
+{
+    // POLLOUT interest follows whether anything is left for the socket to write
+    const bool pending = txBytes > 0 && !txInFlight;
+    if (pending != txArmed && state == ConnectionState::Connected)
+    {
+        txArmed = pending;
+        if (reactor)
+        {
+            reactor->watch(*this);
+        }
+    }
+}
+
+void IPv4Socket::dropPending()
+{
+    if (txBytes > 0)
+    {
+        console::warning("{} bytes for {} dropped on disconnect.", txBytes, host);
+    }
+    auto dropped = std::move(txQueue);
+    txQueue.clear();
+    txOffset = 0;
+    txBytes = 0;
+    txArmed = false;
+    txInFlight = false;
+
+    for (const auto& frame : dropped)
+    {
+        frame->delivered(*this, false);
+    }
 }
 
 auto IPv4Socket::receive() -> std::span<const uint8_t>
 {
-    size_t bytes = io.recv(descriptor, rxBuffer.data(), rxBuffer.size(), 0);
+    if (!rxLease)
+    {
+        rxLease = BufferPool::local().lease(rxSize);
+    }
+
+    const ssize_t bytes = io.recv(descriptor, rxLease.data(), rxSize, 0);
     if (bytes <= 0)
     {
         return {};
     }
-    return { rxBuffer.data(), bytes };
+    return { rxLease.data(), static_cast<size_t>(bytes) };
 }
 
 void IPv4Socket::didReceived(std::span<const uint8_t> data)
 {
-    console::buffer(">>> " + host, data);
+    // the prefix allocates, every received chunk would pay for it otherwise
+    if (console::enabled(console::Level::DEBUG))
+    {
+        console::buffer(">>> " + host, data);
+    }
 }
 
 void IPv4Socket::wentOnline() { CONSOLE_TRACE(host); }
@@ -0,0 +1,272 @@
+#include "latency_histogram.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+namespace
+{
+
+void putVarint(std::vector<uint8_t>& out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<uint8_t>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+auto takeVarint(std::span<const uint8_t>& data, uint64_t& value) -> bool
+{
+    value = 0;
+    for (unsigned shift = 0; shift < 64; shift += 7)
+    {
+        if (data.empty())
+        {
+            return false;
+        }
+        const uint8_t byte = data.front();
+        data = data.subspan(1);
+        value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // anonymous namespace
+
+auto LatencySnapshot::count() const -> uint64_t
+{
+    uint64_t total = 0;
+    for (const auto& bucket : buckets)
+    {
+        total += bucket.count;
+    }
+    return total;
+}
+
+auto LatencySnapshot::percentile(double percent) const -> std::chrono::microseconds
+{
+    const uint64_t total = count();
+    if (total == 0)
+    {
+        return std::chrono::microseconds(0);
+    }
+
+    const double share = std::clamp(percent, 0.0, 100.0) / 100.0;
+    const auto rank = std::max<uint64_t>(
+        static_cast<uint64_t>(std::ceil(share * static_cast<double>(total))), 1
+    );
+    uint64_t seen = 0;
+    for (const auto& bucket : buckets)
+    {
+        seen += bucket.count;
+        if (seen >= rank)
+        {
+            return std::chrono::microseconds(LatencyHistogram::highestOf(bucket.index));
+        }
+    }
+    return max();
+}
+
+auto LatencySnapshot::max() const -> std::chrono::microseconds
+{
+    if (buckets.empty())
+    {
+        return std::chrono::microseconds(0);
+    }
+    return std::chrono::microseconds(LatencyHistogram::highestOf(buckets.back().index));
+}
+
+auto LatencySnapshot::encode() const -> std::vector<uint8_t>
+{
+    // indexes go up, so deltas mostly fit one byte
+    std::vector<uint8_t> out;
+    out.reserve(1 + buckets.size() * 3);
+    putVarint(out, buckets.size());
+    uint16_t previous = 0;
+    for (const auto& bucket : buckets)
+    {
+        putVarint(out, bucket.index - previous);
+        putVarint(out, bucket.count);
+        previous = bucket.index;
+    }
+    return out;
+}
+
+auto LatencySnapshot::decode(std::span<const uint8_t> data, LatencySnapshot& into) -> bool
+{
+    uint64_t size = 0;
+    if (!takeVarint(data, size) || size > LatencyHistogram::BUCKETS)
+    {
+        return false;
+    }
+
+    std::vector<Bucket> decoded;
+    decoded.reserve(size);
+    uint64_t index = 0;
+    for (uint64_t i = 0; i < size; i++)
+    {
+        uint64_t delta = 0;
+        uint64_t amount = 0;
+        if (!takeVarint(data, delta) || !takeVarint(data, amount))
+        {
+            return false;
+        }
+        index += delta;
+        if ((i > 0 && delta == 0) || index >= LatencyHistogram::BUCKETS || amount == 0)
+        {
+            return false;
+        }
+        decoded.push_back(Bucket { static_cast<uint16_t>(index), amount });
+    }
+    if (!data.empty())
+    {
+        return false;
+    }
+
+    into.buckets = std::move(decoded);
+    return true;
+}
+
+auto LatencySnapshot::operator+=(const LatencySnapshot& other) -> LatencySnapshot&
+{
+    std::vector<Bucket> merged;
+    merged.reserve(buckets.size() + other.buckets.size());
+    auto mine = buckets.begin();
+    auto theirs = other.buckets.begin();
+    while (mine != buckets.end() || theirs != other.buckets.end())
+    {
+        if (theirs == other.buckets.end() ||
+            (mine != buckets.end() && mine->index < theirs->index))
+        {
+            merged.push_back(*mine++);
+        }
+        else if (mine == buckets.end() || theirs->index < mine->index)
+        {
+            merged.push_back(*theirs++);
+        }
+        else
+        {
+            merged.push_back(Bucket { mine->index, mine->count + theirs->count });
+            ++mine;
+            ++theirs;
+        }
+    }
+    buckets = std::move(merged);
+    return *this;
+}
+
+auto LatencyHistogram::bucketOf(uint64_t micros) -> size_t
+{
+    const uint64_t value = std::min(micros, HIGHEST);
+    if (value < SUB_COUNT)
+    {
+        return static_cast<size_t>(value);
+    }
+
+    // drop the bits below the precision kept for this power of two
+    const auto shift = static_cast<unsigned>(std::bit_width(value)) - SUB_BITS;
+    return static_cast<size_t>(shift * HALF_COUNT + (value >> shift));
+}
+
+auto LatencyHistogram::highestOf(size_t bucket) -> uint64_t
+{
+    if (bucket < SUB_COUNT)
+    {
+        return bucket;
+    }
+
+    const auto shift = static_cast<unsigned>(bucket / HALF_COUNT - 1);
+    const uint64_t lowest = (bucket - shift * HALF_COUNT) << shift;
+    return lowest + (uint64_t { 1 } << shift) - 1;
+}
+
+void LatencyHistogram::record(std::chrono::nanoseconds elapsed)
+{
+    const auto micros = std::chrono::duration_cast<std::chrono::microseconds>(elapsed);
+    const auto value = static_cast<uint64_t>(std::max<int64_t>(micros.count(), 0));
+    auto& slot = counts[bucketOf(value)];
+
+    // the writer is alone, so a plain load and store beats a locked read-modify-write
+    slot.store(slot.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+auto LatencyHistogram::snapshot() const -> LatencySnapshot
+{
+    LatencySnapshot taken;
+    for (size_t i = 0; i < BUCKETS; i++)
+    {
+        const uint64_t value = counts[i].load(std::memory_order_relaxed);
+        if (value != 0)
+        {
+            taken.buckets.push_back(LatencySnapshot::Bucket {
+                static_cast<uint16_t>(i), value
+            });
+        }
+    }
+    return taken;
+}
+
+auto LatencyReport::operator+=(const LatencyReport& other) -> LatencyReport&
+{
+    connect += other.connect;
+    replies += other.replies;
+    for (const auto& [group, snapshot] : other.groups)
+    {
+        groups[group] += snapshot;
+    }
+    return *this;
+}
+
+void LatencyBook::prepare(uint8_t group)
+{
+    auto& slot = groups.at(group);
+    if (slot.load(std::memory_order_relaxed) != nullptr)
+    {
+        return;
+    }
+
+    owned.push_back(std::make_unique<LatencyHistogram>());
+    slot.store(owned.back().get(), std::memory_order_release);
+}
+
+void LatencyBook::recordConnect(std::chrono::nanoseconds elapsed)
+{
+    connects.record(elapsed);
+}
+
+void LatencyBook::recordReply(uint8_t group, std::chrono::nanoseconds elapsed)
+{
+    if (auto* histogram = groups.at(group).load(std::memory_order_relaxed))
+    {
+        histogram->record(elapsed);
+    }
+}
+
+auto LatencyBook::report() const -> LatencyReport
+{
+    LatencyReport taken { .connect = connects.snapshot(), .replies = {}, .groups = {} };
+    for (size_t group = 0; group < GROUPS; group++)
+    {
+        if (const auto* histogram = groups.at(group).load(std::memory_order_acquire))
+        {
+            auto snapshot = histogram->snapshot();
+            taken.replies += snapshot;
+            taken.groups.emplace(static_cast<uint8_t>(group), std::move(snapshot));
+        }
+    }
+    return taken;
+}
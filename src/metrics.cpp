@@ -0,0 +1,141 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+namespace
+{
+
+constexpr uint64_t MICROS_PER_MILLI = 1000;
+
+// the writer is alone, so a plain load and store beats a locked read-modify-write
+template <typename T> void bump(std::atomic<T>& value, T amount)
+{
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+} // anonymous namespace
+
+auto TrafficMetrics::operator+=(const TrafficMetrics& other) -> TrafficMetrics&
+{
+    bytesIn += other.bytesIn;
+    bytesOut += other.bytesOut;
+    framesIn += other.framesIn;
+    framesOut += other.framesOut;
+    unsolicited += other.unsolicited;
+    sendStalls += other.sendStalls;
+    reconnects += other.reconnects;
+    connectFailures += other.connectFailures;
+    connected += other.connected;
+    return *this;
+}
+
+auto EngineMetrics::operator+=(const EngineMetrics& other) -> EngineMetrics&
+{
+    traffic += other.traffic;
+    sessions += other.sessions;
+    polls += other.polls;
+    events += other.events;
+    commands += other.commands;
+    connectQueue += other.connectQueue;
+    connectsDeferred += other.connectsDeferred;
+    return *this;
+}
+
+auto TrafficCounters::microsOf(Clock::time_point point) const -> int64_t
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(point - origin).count();
+}
+
+void TrafficCounters::beginWrite()
+{
+    bump<uint64_t>(sequence, 1);
+    std::atomic_thread_fence(std::memory_order_release);
+}
+
+void TrafficCounters::endWrite()
+{
+    sequence.store(
+        sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release
+    );
+}
+
+void TrafficCounters::add(Counter counter, uint64_t amount)
+{
+    beginWrite();
+    bump(counters.at(static_cast<size_t>(counter)), amount);
+    endWrite();
+}
+
+void TrafficCounters::wentOnline(Clock::time_point since)
+{
+    beginWrite();
+    const int64_t at = microsOf(since);
+    bump<int64_t>(online, 1);
+    bump(sinceSumUs, static_cast<uint64_t>(at));
+    if (at > latestSinceUs.load(std::memory_order_relaxed))
+    {
+        latestSinceUs.store(at, std::memory_order_relaxed);
+    }
+    endWrite();
+}
+
+void TrafficCounters::wentOffline(Clock::time_point since, Clock::time_point now)
+{
+    beginWrite();
+    bump(connectedUs, static_cast<uint64_t>(microsOf(now) - microsOf(since)));
+    bump<int64_t>(online, -1);
+    bump(sinceSumUs, 0 - static_cast<uint64_t>(microsOf(since)));
+    endWrite();
+}
+
+auto TrafficCounters::snapshot(Clock::time_point now) const -> TrafficMetrics
+{
+    std::array<uint64_t, COUNTERS> values {};
+    uint64_t connectedSoFar = 0;
+    while (true)
+    {
+        const uint64_t before = sequence.load(std::memory_order_acquire);
+        if ((before & 1U) != 0)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < COUNTERS; i++)
+        {
+            values.at(i) = counters.at(i).load(std::memory_order_relaxed);
+        }
+        // never before a since, or the difference below would wrap instead of being small
+        const auto count = static_cast<uint64_t>(online.load(std::memory_order_relaxed));
+        const auto at = static_cast<uint64_t>(
+            std::max(microsOf(now), latestSinceUs.load(std::memory_order_relaxed))
+        );
+        connectedSoFar = connectedUs.load(std::memory_order_relaxed) + (count * at) -
+                         sinceSumUs.load(std::memory_order_relaxed);
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence.load(std::memory_order_relaxed) == before)
+        {
+            break;
+        }
+    }
+
+    const auto valueOf = [&values](Counter counter)
+    { return values.at(static_cast<size_t>(counter)); };
+    return TrafficMetrics {
+        .bytesIn = valueOf(Counter::BytesIn),
+        .bytesOut = valueOf(Counter::BytesOut),
+        .framesIn = valueOf(Counter::FramesIn),
+        .framesOut = valueOf(Counter::FramesOut),
+        .unsolicited = valueOf(Counter::Unsolicited),
+        .sendStalls = valueOf(Counter::SendStalls),
+        .reconnects = valueOf(Counter::Reconnects),
+        .connectFailures = valueOf(Counter::ConnectFailures),
+        .connected = std::chrono::milliseconds(
+            static_cast<int64_t>(connectedSoFar / MICROS_PER_MILLI)
+        ),
+    };
+}
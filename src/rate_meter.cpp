@@ -0,0 +1,51 @@
+#include "rate_meter.h"
+
+#include <chrono>
+#include <cstdint>
+
+namespace
+{
+
+// each bucket packs the second it belongs to above a 24 bit count
+constexpr unsigned COUNT_BITS = 24;
+constexpr uint64_t COUNT_MASK = (uint64_t { 1 } << COUNT_BITS) - 1;
+
+auto toSecond(RateMeter::Clock::time_point now) -> uint64_t
+{
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::seconds>(now.time_since_epoch()).count()
+    );
+}
+
+} // anonymous namespace
+
+void RateMeter::record(Clock::time_point now)
+{
+    const uint64_t second = toSecond(now);
+    auto& bucket = buckets.at(second % WINDOW);
+
+    uint64_t packed = bucket.load(std::memory_order_relaxed);
+    uint64_t count = ((packed >> COUNT_BITS) == second) ? (packed & COUNT_MASK) : 0;
+    if (count < COUNT_MASK)
+    {
+        count++;
+    }
+    bucket.store((second << COUNT_BITS) | count, std::memory_order_relaxed);
+}
+
+auto RateMeter::perMinute(Clock::time_point now) const -> uint64_t
+{
+    const uint64_t second = toSecond(now);
+
+    uint64_t total = 0;
+    for (const auto& bucket : buckets)
+    {
+        const uint64_t packed = bucket.load(std::memory_order_relaxed);
+        const uint64_t stamp = packed >> COUNT_BITS;
+        if (stamp <= second && second - stamp < WINDOW)
+        {
+            total += packed & COUNT_MASK;
+        }
+    }
+    return total;
+}
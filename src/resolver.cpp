@@ -0,0 +1,226 @@
+#include "resolver.h"
+
+#include "console.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <stop_token>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+
+namespace
+{
+
+auto keyOf(const std::string& host, uint16_t port) -> std::string
+{
+    return host + ":" + std::to_string(port);
+}
+
+} // anonymous namespace
+
+Resolver::Resolver(const IoIntf& useIo, size_t workerCount, std::chrono::seconds useTtl)
+    : io(useIo)
+    , ttl(useTtl)
+{
+    for (size_t i = 0; i < std::max<size_t>(workerCount, 1); i++)
+    {
+        workers.emplace_back([this](const std::stop_token& token) { work(token); });
+    }
+}
+
+Resolver::~Resolver()
+{
+    for (auto& worker : workers)
+    {
+        worker.request_stop();
+    }
+    wake.notify_all();
+    workers.clear();
+}
+
+auto Resolver::cached() const -> size_t
+{
+    const std::scoped_lock lock(mutex);
+    return cache.size();
+}
+
+auto Resolver::lookup(
+    const std::string& host, uint16_t port, Resolution& out, Clock::time_point now
+) const -> bool
+{
+    const std::scoped_lock lock(mutex);
+    const auto found = cache.find(keyOf(host, port));
+    if (found == cache.end() || found->second.expires <= now)
+    {
+        return false;
+    }
+    out = found->second;
+    return true;
+}
+
+void Resolver::resolve(
+    const std::string& host, uint16_t port, const void* owner, Callback onResolved
+)
+{
+    auto key = keyOf(host, port);
+    Resolution answer;
+    {
+        const std::scoped_lock lock(mutex);
+        const auto found = cache.find(key);
+        if (found == cache.end() || found->second.expires <= Clock::now())
+        {
+            auto& waiting = inFlight[key];
+            if (waiting.empty())
+            {
+                jobs.push_back(Job { .key = std::move(key), .host = host, .port = port });
+                wake.notify_one();
+            }
+            waiting.push_back(
+                Waiter { .owner = owner, .onResolved = std::move(onResolved) }
+            );
+            return;
+        }
+        answer = found->second;
+    }
+
+    if (onResolved)
+    {
+        onResolved(answer);
+    }
+}
+
+void Resolver::prefetch(const std::string& host, uint16_t port)
+{
+    SocketAddress numeric {};
+    if (!parseNumeric(io, host, port, numeric))
+    {
+        resolve(host, port, nullptr, {});
+    }
+}
+
+void Resolver::forget(const void* owner)
+{
+    {
+        const std::scoped_lock lock(mutex);
+        for (auto& [key, waiting] : inFlight)
+        {
+            std::erase_if(waiting, [owner](const Waiter& w) { return w.owner == owner; });
+        }
+    }
+
+    // whatever was already taken out of the map finishes before we return
+    const std::scoped_lock lock(dispatching);
+}
+
+auto Resolver::parseNumeric(
+    const IoIntf& io, const std::string& host, uint16_t port, SocketAddress& out
+) -> bool
+{
+    out = SocketAddress {};
+    auto& ipv4 = reinterpret_cast<struct sockaddr_in&>(out.storage);
+    if (io.inet_pton(AF_INET, host.c_str(), &ipv4.sin_addr) > 0)
+    {
+        ipv4.sin_family = AF_INET;
+        ipv4.sin_port = htons(port);
+        out.length = sizeof(struct sockaddr_in);
+        return true;
+    }
+
+    // only an IPv6 literal has colons, names need not be tried twice
+    auto& ipv6 = reinterpret_cast<struct sockaddr_in6&>(out.storage);
+    if (host.find(':') != std::string::npos &&
+        io.inet_pton(AF_INET6, host.c_str(), &ipv6.sin6_addr) > 0)
+    {
+        ipv6.sin6_family = AF_INET6;
+        ipv6.sin6_port = htons(port);
+        out.length = sizeof(struct sockaddr_in6);
+        return true;
+    }
+    return false;
+}
+
+void Resolver::work(const std::stop_token& token)
+{
+    while (true)
+    {
+        Job job;
+        {
+            std::unique_lock lock(mutex);
+            if (!wake.wait(lock, token, [this]() { return !jobs.empty(); }))
+            {
+                return;
+            }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+
+        const Resolution answer = query(job);
+        std::vector<Waiter> waiting;
+        {
+            const std::scoped_lock lock(mutex);
+            cache[job.key] = answer;
+            if (auto found = inFlight.find(job.key); found != inFlight.end())
+            {
+                waiting = std::move(found->second);
+                inFlight.erase(found);
+            }
+        }
+
+        const std::scoped_lock lock(dispatching);
+        for (const auto& waiter : waiting)
+        {
+            if (waiter.onResolved)
+            {
+                waiter.onResolved(answer);
+            }
+        }
+    }
+}
+
+auto Resolver::query(const Job& job) const -> Resolution
+{
+    const struct addrinfo hints {
+        .ai_flags = AI_ADDRCONFIG | AI_NUMERICSERV,
+        .ai_family = AF_UNSPEC,
+        .ai_socktype = SOCK_STREAM,
+        .ai_protocol = IPPROTO_TCP,
+    };
+    struct addrinfo* found = nullptr;
+    const std::string service = std::to_string(job.port);
+
+    Resolution answer;
+    const int error = io.getaddrinfo(job.host.c_str(), service.c_str(), &hints, &found);
+    if (error != 0)
+    {
+        console::warning("Cannot resolve {}, reason: {}", job.host, gai_strerror(error));
+        answer.expires = Clock::now() + FAILURE_TTL;
+        return answer;
+    }
+
+    for (const auto* entry = found; entry != nullptr; entry = entry->ai_next)
+    {
+        if (entry->ai_addr == nullptr || entry->ai_addrlen > sizeof(sockaddr_storage))
+        {
+            continue;
+        }
+        SocketAddress address {};
+        std::memcpy(&address.storage, entry->ai_addr, entry->ai_addrlen);
+        address.length = entry->ai_addrlen;
+        answer.addresses.push_back(address);
+    }
+    io.freeaddrinfo(found);
+
+    console::debug("{} resolved to {} addresses", job.host, answer.addresses.size());
+    answer.expires = Clock::now() + (answer.addresses.empty() ? FAILURE_TTL : ttl);
+    return answer;
+}
@@ -0,0 +1,123 @@
+#include "session_store.h"
+#include "sticky_socket.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <unordered_map>
+
+SessionStore::~SessionStore() { clear(); }
+
+auto SessionStore::acquire() -> uint32_t
+{
+    if (freeSlot != NO_SLOT)
+    {
+        const uint32_t index = freeSlot;
+        freeSlot = slots.at(index).position;
+        return index;
+    }
+
+    if (slots.size() == chunks.size() * SLOTS_PER_CHUNK)
+    {
+        // default initialized on purpose, constructors fill the slots
+        chunks.emplace_back(new Cell[SLOTS_PER_CHUNK]); // NOLINT(*-owning-memory)
+    }
+    slots.push_back(Slot { .generation = 1 });
+    return static_cast<uint32_t>(slots.size() - 1);
+}
+
+auto SessionStore::cellAt(uint32_t index) -> void*
+{
+    return &chunks.at(index / SLOTS_PER_CHUNK)[index % SLOTS_PER_CHUNK];
+}
+
+auto SessionStore::slotOf(SessionHandle handle) const -> const Slot*
+{
+    if (handle.index >= slots.size())
+    {
+        return nullptr;
+    }
+
+    const auto& slot = slots[handle.index];
+    if (slot.socket == nullptr || slot.generation != handle.generation)
+    {
+        return nullptr;
+    }
+    return &slot;
+}
+
+auto SessionStore::get(SessionHandle handle) const -> StickySocket*
+{
+    const auto* slot = slotOf(handle);
+    return (slot != nullptr) ? slot->socket : nullptr;
+}
+
+auto SessionStore::isPooled(SessionHandle handle) const -> bool
+{
+    const auto* slot = slotOf(handle);
+    return slot != nullptr && slot->pooled;
+}
+
+auto SessionStore::size() const -> size_t { return live.size(); }
+
+auto SessionStore::capacity() const -> size_t { return chunks.size() * SLOTS_PER_CHUNK; }
+
+auto SessionStore::at(size_t position) const -> StickySocket&
+{
+    return *dense.at(position);
+}
+
+auto SessionStore::handleAt(size_t position) const -> SessionHandle
+{
+    const uint32_t index = live.at(position);
+    return { .index = index, .generation = slots.at(index).generation };
+}
+
+auto SessionStore::positionOf(const EasySocketIntf& skt) const -> size_t
+{
+    auto found = slotOfSocket.find(&skt);
+    return (found != slotOfSocket.end()) ? slots.at(found->second).position : NO_POSITION;
+}
+
+auto SessionStore::erase(SessionHandle handle) -> bool
+{
+    if (slotOf(handle) == nullptr)
+    {
+        return false;
+    }
+
+    auto& slot = slots.at(handle.index);
+    StickySocket* skt = slot.socket;
+
+    // keep the live list dense by moving the last session into the hole
+    const uint32_t position = slot.position;
+    live.at(position) = live.back();
+    dense.at(position) = dense.back();
+    slots.at(live.at(position)).position = position;
+    live.pop_back();
+    dense.pop_back();
+
+    slotOfSocket.erase(skt);
+    slot.socket = nullptr;
+    slot.generation = (slot.generation == UINT32_MAX) ? 1 : slot.generation + 1;
+    slot.position = freeSlot;
+    freeSlot = handle.index;
+
+    if (slot.pooled)
+    {
+        skt->~StickySocket();
+    }
+    else
+    {
+        delete skt; // NOLINT(*-owning-memory)
+    }
+    return true;
+}
+
+void SessionStore::clear()
+{
+    while (!live.empty())
+    {
+        erase(handleAt(live.size() - 1));
+    }
+}
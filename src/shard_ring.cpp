@@ -0,0 +1,64 @@
+#include "shard_ring.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace
+{
+constexpr uint64_t FNV_OFFSET = 0xcbf29ce484222325ULL;
+constexpr uint64_t FNV_PRIME = 0x100000001b3ULL;
+} // namespace
+
+ShardRing::ShardRing(size_t shards, size_t replicas)
+    : shards(std::max<size_t>(shards, 1))
+{
+    points.reserve(this->shards * replicas);
+    for (size_t shard = 0; shard < this->shards; shard++)
+    {
+        for (size_t replica = 0; replica < replicas; replica++)
+        {
+            const std::string label =
+                "shard-" + std::to_string(shard) + "#" + std::to_string(replica);
+            points.emplace_back(hash(label), shard);
+        }
+    }
+    std::ranges::sort(points);
+}
+
+auto ShardRing::size() const -> size_t { return shards; }
+
+auto ShardRing::pick(std::string_view key) const -> size_t
+{
+    if (shards == 1)
+    {
+        return 0;
+    }
+
+    const uint64_t point = hash(key);
+    auto found = std::ranges::lower_bound(
+        points, point, {}, [](const auto& entry) { return entry.first; }
+    );
+    if (found == points.end())
+    {
+        found = points.begin();
+    }
+    return found->second;
+}
+
+auto ShardRing::hash(std::string_view key) -> uint64_t
+{
+    // FNV-1a with a final avalanche, short labels spread poorly otherwise
+    uint64_t value = FNV_OFFSET;
+    for (const char chr : key)
+    {
+        value ^= static_cast<uint8_t>(chr);
+        value *= FNV_PRIME;
+    }
+    value ^= value >> 33U;
+    value *= 0xff51afd7ed558ccdULL;
+    value ^= value >> 33U;
+    return value;
+}
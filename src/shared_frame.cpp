@@ -0,0 +1,29 @@
+#include "shared_frame.h"
+
+#include <memory>
+#include <utility>
+
+SharedFrame::SharedFrame(std::span<const uint8_t> bytes, Delivery onDelivery)
+    : payload(bytes.begin(), bytes.end())
+    , onDelivery(std::move(onDelivery))
+{
+}
+
+auto SharedFrame::make(std::span<const uint8_t> bytes, Delivery onDelivery) -> FrameRef
+{
+    return std::make_shared<const SharedFrame>(bytes, std::move(onDelivery));
+}
+
+auto SharedFrame::bytes() const -> std::span<const uint8_t> { return payload; }
+
+auto SharedFrame::size() const -> size_t { return payload.size(); }
+
+auto SharedFrame::wantsDelivery() const -> bool { return static_cast<bool>(onDelivery); }
+
+void SharedFrame::delivered(EasySocketIntf& skt, bool sent) const
+{
+    if (onDelivery)
+    {
+        onDelivery(skt, sent);
+    }
+}
@@ -0,0 +1,81 @@
+#include "sicp_decoder.h"
+#include "checksum.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace sicp
+{
+
+auto checksum(std::span<const uint8_t> data) -> uint8_t { return checksum::compute(data); }
+
+auto isValid(std::span<const uint8_t> frame) -> bool
+{
+    if (frame.size() < MIN_FRAME || frame.size() != frame[0])
+    {
+        return false;
+    }
+    // the trailing checksum cancels the rest out
+    return checksum::compute(frame) == 0;
+}
+
+auto encode(
+    std::span<uint8_t> out, uint8_t control, uint8_t group, std::span<const uint8_t> data
+) -> size_t
+{
+    // length, control, group, data and checksum
+    const size_t length = 3 + data.size() + 1;
+    if (length > MAX_FRAME || length > out.size())
+    {
+        return 0;
+    }
+
+    out[0] = static_cast<uint8_t>(length);
+    out[1] = control;
+    out[2] = group;
+    std::ranges::copy(data, out.begin() + 3);
+    out[length - 1] = checksum::compute(out.first(length - 1));
+    return length;
+}
+
+} // namespace sicp
+
+SicpDecoder::SicpDecoder()
+    : staging()
+    , staged(0)
+    , frames(0)
+    , errors(0)
+{
+}
+
+auto SicpDecoder::pendingBytes() const -> size_t { return staged; }
+
+auto SicpDecoder::getFrames() const -> uint64_t { return frames; }
+
+auto SicpDecoder::getErrors() const -> uint64_t { return errors; }
+
+void SicpDecoder::reset() { staged = 0; }
+
+auto SicpDecoder::stage(std::span<const uint8_t> chunk) -> size_t
+{
+    // the length byte is the first one staged and was already checked
+    const size_t wanted = (staged > 0) ? staging[0] - staged : chunk.size();
+    const size_t taken = std::min(wanted, chunk.size());
+    std::copy_n(chunk.begin(), taken, staging.begin() + static_cast<ptrdiff_t>(staged));
+    staged += taken;
+    return taken;
+}
+
+auto SicpDecoder::accept(std::span<const uint8_t> frame) -> bool
+{
+    if (!sicp::isValid(frame))
+    {
+        // the length byte still tells where the next frame starts
+        errors++;
+        return false;
+    }
+    frames++;
+    return true;
+}
@@ -1,9 +1,12 @@
 #include "sticky_engine.h"
 #include "console.h"
 #include "easy_socket.h"
+#include "epoll_poller.h"
 #include "ioi.h"
+#include "uring_poller.h"
 
 #include <algorithm>
+#include <cerrno>
 #include <cstddef>
 #include <cstdint>
 #include <cstdio>
@@ -11,69 +14,489 @@
 
 #include <poll.h>
 #include <sys/poll.h>
+#include <sys/eventfd.h>
 #include <sys/socket.h>
 #include <sys/types.h>
 
-StickyEngine::StickyEngine(const IoIntf& useIo)
+StickyEngine::StickyEngine(const IoIntf& useIo, Backend useBackend)
     : io(useIo)
+    , backend(useBackend)
+    , slack(0)
+    , wakeup(io.eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+    , signalled(false)
+    , resolver(nullptr)
+    , admitting(nullptr)
+    , sessionCount(0)
+    , pollCount(0)
+    , eventCount(0)
+    , commandCount(0)
+    , queueDepth(0)
+    , deferCount(0)
 {
+    if (wakeup < 0)
+    {
+        console::error("Cannot create wakeup descriptor, reason: {}", strerror(errno));
+    }
+
+    if (backend == Backend::Uring)
+    {
+        auto uring = std::make_unique<UringPoller>();
+        if (uring->isReady())
+        {
+            poller = std::move(uring);
+        }
+        else
+        {
+            console::warning("Falling back to epoll backend.");
+            backend = Backend::Epoll;
+        }
+    }
+
+    if (backend == Backend::Epoll)
+    {
+        poller = std::make_unique<EpollPoller>(io);
+    }
+
+    if (poller && wakeup >= 0)
+    {
+        poller->wakeOn(wakeup);
+    }
 }
 
 StickyEngine::~StickyEngine()
 {
-    for (auto& skt : connections)
+    if (resolver != nullptr)
+    {
+        resolver->forget(this);
+    }
+    for (auto* skt : sessions)
     {
         skt->disconnect();
     }
+    sessions.clear();
+    hot.clear();
+    poller.reset();
+
+    if (wakeup >= 0)
+    {
+        io.close(wakeup);
+    }
+}
+
+auto StickyEngine::getBackend() const -> Backend { return backend; }
+
+auto StickyEngine::find(const std::string& host, uint16_t port) const -> StickySocket*
+{
+    auto found = std::ranges::find_if(sessions, [&host, port](const auto* skt)
+    { return skt->getPort() == port && skt->getHost() == host; });
+    return (found != sessions.end()) ? *found : nullptr;
+}
+
+auto StickyEngine::lookup(SessionHandle handle) const -> StickySocket*
+{
+    return sessions.get(handle);
+}
+
+auto StickyEngine::getSessions() const -> const SessionStore& { return sessions; }
+
+auto StickyEngine::getHotState() const -> const HotState& { return hot; }
+
+auto StickyEngine::remove(SessionHandle handle) -> bool
+{
+    auto* skt = sessions.get(handle);
+    if (skt == nullptr)
+    {
+        return false;
+    }
+
+    // unregister while the socket is still whole, pollers only hold raw pointers
+    skt->disconnect();
+    const size_t row = sessions.positionOf(*skt);
+    sessions.erase(handle);
+    hot.removeAt(row);
+    sessionCount.store(sessions.size(), std::memory_order_relaxed);
+    return true;
+}
+
+auto StickyEngine::getTimerSlack() const -> std::chrono::milliseconds { return slack; }
+
+auto StickyEngine::getWakeupRate() const -> uint64_t { return wakeups.perMinute(); }
+
+auto StickyEngine::getMetrics() const -> EngineMetrics
+{
+    return EngineMetrics {
+        .traffic = traffic.snapshot(),
+        .sessions = sessionCount.load(std::memory_order_relaxed),
+        .polls = pollCount.load(std::memory_order_relaxed),
+        .events = eventCount.load(std::memory_order_relaxed),
+        .commands = commandCount.load(std::memory_order_relaxed),
+        .connectQueue = queueDepth.load(std::memory_order_relaxed),
+        .connectsDeferred = deferCount.load(std::memory_order_relaxed),
+    };
+}
+
+auto StickyEngine::getLatency() const -> LatencyReport { return latency.report(); }
+
+void StickyEngine::setResolver(Resolver* useResolver) { resolver = useResolver; }
+
+void StickyEngine::setConnectLimits(ConnectGate::Limits limits) { gate.configure(limits); }
+
+void StickyEngine::setTimerSlack(std::chrono::milliseconds useSlack)
+{
+    slack = std::max(useSlack, std::chrono::milliseconds(0));
+}
+
+auto StickyEngine::broadcast(
+    std::span<const uint8_t> frame,
+    std::span<StickySocket* const> targets,
+    SharedFrame::Delivery onDelivery
+) -> size_t
+{
+    // one copy of the bytes no matter how many sockets carry it
+    const auto shared = SharedFrame::make(frame, std::move(onDelivery));
+
+    size_t queued = 0;
+    for (auto* skt : targets)
+    {
+        if (skt->send(shared) >= 0)
+        {
+            queued++;
+        }
+    }
+    return queued;
+}
+
+auto StickyEngine::broadcast(
+    std::span<const uint8_t> frame, SharedFrame::Delivery onDelivery
+) -> size_t
+{
+    std::vector<StickySocket*> targets;
+    targets.reserve(sessions.size());
+    for (size_t row = 0; row < hot.size(); row++)
+    {
+        if (hot.stateAt(row) == EasySocketIntf::ConnectionState::Connected)
+        {
+            targets.push_back(&sessions.at(row));
+        }
+    }
+    return broadcast(frame, targets, std::move(onDelivery));
+}
+
+void StickyEngine::post(Command command)
+{
+    commands.push(std::move(command));
+
+    // only the first post after a drain pays for the syscall
+    if (!signalled.exchange(true, std::memory_order_acq_rel) && wakeup >= 0)
+    {
+        const uint64_t one = 1;
+        io.write(wakeup, &one, sizeof(one));
+    }
+}
+
+void StickyEngine::watch(EasySocketIntf& skt)
+{
+    if (poller)
+    {
+        poller->watch(skt);
+    }
+    refresh(skt);
+}
+
+void StickyEngine::forget(EasySocketIntf& skt)
+{
+    if (poller)
+    {
+        poller->forget(skt);
+    }
+    refresh(skt);
+}
+
+void StickyEngine::refresh(EasySocketIntf& skt)
+{
+    const size_t row = sessions.positionOf(skt);
+    if (row != SessionStore::NO_POSITION)
+    {
+        hot.update(row, sessions.at(row));
+    }
+}
+
+auto StickyEngine::resolve(EasySocketIntf& skt) -> bool
+{
+    const size_t row = sessions.positionOf(skt);
+    SocketAddress numeric {};
+    if (resolver == nullptr || row == SessionStore::NO_POSITION ||
+        Resolver::parseNumeric(io, skt.getHost(), skt.getPort(), numeric))
+    {
+        return false;
+    }
+
+    Resolver::Resolution known;
+    if (resolver->lookup(skt.getHost(), skt.getPort(), known))
+    {
+        sessions.at(row).useAddresses(known);
+        return false;
+    }
+
+    // the answer comes back on a resolver thread and is handed over like any command
+    const auto handle = sessions.handleAt(row);
+    resolver->resolve(
+        skt.getHost(), skt.getPort(), this,
+        [this, handle](const Resolver::Resolution& resolution)
+    {
+        post([handle, resolution](StickyEngine& engine)
+        {
+            if (auto* session = engine.lookup(handle))
+            {
+                // a failed lookup is cached too, the attempt then backs off as usual
+                session->useAddresses(resolution);
+                session->retryNow();
+            }
+        });
+    }
+    );
+    return true;
+}
+
+auto StickyEngine::admit(EasySocketIntf& skt) -> bool
+{
+    if (&skt == admitting || !gate.isLimited())
+    {
+        return true;
+    }
+
+    // nobody gets ahead of those already waiting in line
+    if (gate.waiting() == 0 && gate.tryAdmit(Timer::Clock::now(), hot.connecting()))
+    {
+        return true;
+    }
+
+    const size_t row = sessions.positionOf(skt);
+    if (row == SessionStore::NO_POSITION)
+    {
+        return true;
+    }
+    if (gate.enqueue(sessions.handleAt(row)))
+    {
+        deferCount.store(
+            deferCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed
+        );
+        queueDepth.store(gate.waiting(), std::memory_order_relaxed);
+    }
+    return false;
+}
+
+void StickyEngine::schedule(Timer& timer, Timer::Clock::time_point deadline)
+{
+    timers.schedule(timer, deadline);
+}
+
+void StickyEngine::cancel(Timer& timer) { timers.cancel(timer); }
+
+auto StickyEngine::transmit(
+    EasySocketIntf& skt, const std::deque<FrameRef>& queue, size_t offset
+) -> bool
+{
+    return poller && poller->transmit(skt, queue, offset);
+}
+
+void StickyEngine::drain(bool woken)
+{
+    if (woken && wakeup >= 0)
+    {
+        uint64_t count = 0;
+        io.read(wakeup, &count, sizeof(count));
+    }
+
+    // pairs with post, every command pushed before the flag was raised is visible
+    if (!signalled.load(std::memory_order_relaxed) ||
+        !signalled.exchange(false, std::memory_order_acq_rel))
+    {
+        return;
+    }
+
+    while (auto command = commands.pop())
+    {
+        (*command)(*this);
+        commandCount.store(
+            commandCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed
+        );
+    }
+}
+
+void StickyEngine::admitWaiting(Timer::Clock::time_point now)
+{
+    while (gate.waiting() > 0)
+    {
+        auto* skt = sessions.get(gate.front());
+        if (skt == nullptr || !skt->isTrying() ||
+            skt->getState() != EasySocketIntf::ConnectionState::Disconnected)
+        {
+            gate.pop(); // removed, stopped or connected meanwhile
+            continue;
+        }
+        if (!gate.tryAdmit(now, hot.connecting()))
+        {
+            break;
+        }
+
+        gate.pop();
+        admitting = skt;
+        skt->retryNow();
+        admitting = nullptr;
+    }
+    queueDepth.store(gate.waiting(), std::memory_order_relaxed);
 }
 
 void StickyEngine::rebuild_poll_params()
 {
     // TODO: someday call this only when sockets are reconnected
     responses.clear();
-    std::ranges::transform(
-        connections, std::back_inserter(responses),
-        [](const auto& skt)
+    for (size_t row = 0; row < hot.size(); row++)
     {
-        return pollfd {
-            .fd = skt->getDescriptor(),
-            .events = POLLIN | POLLPRI | POLLOUT,
+        responses.push_back(pollfd {
+            .fd = hot.descriptorAt(row),
+            .events = hot.interestAt(row),
             .revents = 0,
-        };
+        });
+    }
+
+    if (wakeup >= 0)
+    {
+        responses.push_back(pollfd { .fd = wakeup, .events = POLLIN, .revents = 0 });
     }
+}
+
+void StickyEngine::dispatch(StickySocket& skt, const struct pollfd& response)
+{
+    if (skt.getState() != EasySocketIntf::ConnectionState::Disconnected)
+    {
+        if (!skt.eval(response))
+        {
+            skt.step();
+        }
+    }
+}
+
+void StickyEngine::deliver(StickySocket& skt, std::span<const uint8_t> data)
+{
+    if (!skt.ingest(data))
+    {
+        skt.step();
+    }
+}
+
+void StickyEngine::complete(StickySocket& skt, int sent)
+{
+    if (!skt.transmitted(sent))
+    {
+        skt.step();
+    }
+}
+
+auto StickyEngine::coalesce(Timer::Clock::time_point now, int until) const -> int
+{
+    // wake on a shared slack grid, so nearby deadlines of every engine fire together
+    const auto since = std::chrono::duration_cast<std::chrono::milliseconds>(
+        now.time_since_epoch()
     );
+    const auto deadline = since.count() + until;
+    const auto grid = slack.count();
+    const auto aligned = ((deadline + grid - 1) / grid) * grid;
+    return static_cast<int>(aligned - since.count());
 }
 
 int StickyEngine::poll(int duration)
 {
-    for (auto& skt : connections)
+    // never sleep past the nearest deadline
+    const auto now = Timer::Clock::now();
+    int until = timers.timeout(now);
+    if (gate.waiting() > 0 && !gate.isFull(hot.connecting()))
+    {
+        // the next in line goes as soon as the bucket has a token for it
+        const auto token = static_cast<int>(gate.untilToken(now).count());
+        until = (until < 0) ? token : std::min(until, token);
+    }
+    if (until > 0 && slack.count() > 0)
+    {
+        until = coalesce(now, until);
+    }
+    if (until >= 0 && (duration < 0 || until < duration))
     {
-        if (skt->getState() == EasySocketIntf::ConnectionState::Disconnected)
+        duration = until;
+    }
+
+    int events = 0;
+    bool woken = false;
+    if (poller)
+    {
+        events = poller->wait(ready, duration);
+        for (const auto& [socket, revents, data, sent] : ready)
         {
-            skt->reconnect();
+            if (socket == nullptr)
+            {
+                woken = true;
+                continue;
+            }
+
+            auto& skt = *static_cast<StickySocket*>(socket);
+            if (sent)
+            {
+                complete(skt, *sent);
+            }
+            else if (data.empty())
+            {
+                const struct pollfd response {
+                    .fd = skt.getDescriptor(), .events = 0, .revents = revents,
+                };
+                dispatch(skt, response);
+            }
+            else
+            {
+                deliver(skt, data);
+            }
         }
     }
-
-    rebuild_poll_params();
-    int events = io.poll(responses.data(), responses.size(), duration);
-    if (events > 0)
+    else
     {
-        for (size_t i = 0; i < responses.size(); i++)
+        rebuild_poll_params();
+        events = io.poll(responses.data(), responses.size(), duration);
+        if (events > 0)
         {
-            const auto& response = responses.at(i);
-            auto& skt = connections.at(i);
-            if (skt->getState() != EasySocketIntf::ConnectionState::Disconnected)
+            for (size_t row = 0; row < hot.size(); row++)
             {
-                if (!skt->eval(response))
+                if (hot.stateAt(row) != EasySocketIntf::ConnectionState::Disconnected)
                 {
-                    skt->step();
+                    dispatch(sessions.at(row), responses.at(row));
                 }
             }
+            woken = (responses.size() > sessions.size()) &&
+                    (responses.back().revents & POLLIN);
         }
     }
-    else if (events < 0)
+
+    if (events < 0)
     {
         console::error("Polling error: {}.", events);
     }
+
+    wakeups.record();
+    pollCount.store(
+        pollCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed
+    );
+    if (events > 0)
+    {
+        eventCount.store(
+            eventCount.load(std::memory_order_relaxed) + static_cast<uint64_t>(events),
+            std::memory_order_relaxed
+        );
+    }
+    drain(woken);
+
+    timers.advance(Timer::Clock::now());
+    if (gate.waiting() > 0)
+    {
+        admitWaiting(Timer::Clock::now());
+    }
     return events;
 }
@@ -2,7 +2,10 @@
 #include "console.h"
 #include "easy_socket.h"
 #include "ipv4_socket.h"
+#include "reactor.h"
+#include "timer_wheel.h"
 
+#include <algorithm>
 #include <cerrno>
 #include <chrono>
 #include <cstddef>
@@ -10,6 +13,8 @@
 #include <cstring>
 #include <string>
 #include <iomanip>
+#include <random>
+#include <utility>
 
 #include <netinet/in.h>
 #include <sys/poll.h>
@@ -33,6 +38,19 @@ std::string get_current_time()
     return oss.str();
 }
 
+namespace
+{
+
+// half of every backoff is random, so sockets that dropped together retry apart
+auto jitter(std::chrono::milliseconds upTo) -> std::chrono::milliseconds
+{
+    thread_local std::minstd_rand random { std::random_device {}() };
+    std::uniform_int_distribution<int64_t> spread(0, upTo.count());
+    return std::chrono::milliseconds(spread(random));
+}
+
+} // anonymous namespace
+
 StickySocket::StickySocket(
     const IoIntf& useIo,
     std::string host,
@@ -40,21 +58,39 @@ StickySocket::StickySocket(
     size_t retries
 )
     : IPv4Socket(useIo, std::move(host), port)
+    , keepTrying(false)
+    , firstAttempt(false)
     , maxRetries(retries)
     , attempts(0)
     , backOff(0)
-    , keepTrying(false)
+    , retryTimer([this]() { reconnect(); })
 {
     CONSOLE_TRACE(this->host);
 }
 
+auto StickySocket::getNextAttempt() const -> Timer::Clock::time_point
+{
+    return nextAttempt;
+}
+
+auto StickySocket::getAttempts() const -> size_t { return attempts; }
+
+auto StickySocket::isTrying() const -> bool { return keepTrying; }
+
 auto StickySocket::connect() -> bool
 {
     CONSOLE_TRACE(host);
     console::debug("{}", host);
 
     keepTrying = true;
+    firstAttempt = true;
     attempts = 0;
+    nextAttempt = Timer::Clock::now();
+    if (auto* reactor = getReactor())
+    {
+        reactor->cancel(retryTimer);
+        reactor->refresh(*this);
+    }
     return reconnect();
 }
 
@@ -64,51 +100,130 @@ void StickySocket::disconnect()
     console::debug("{}", host);
 
     keepTrying = false;
+    if (auto* reactor = getReactor())
+    {
+        reactor->cancel(retryTimer);
+    }
     IPv4Socket::disconnect();
 }
 
 auto StickySocket::reconnect() -> bool
 {
-    bool willConnect = false;
+    if (!keepTrying || state != ConnectionState::Disconnected)
+    {
+        return false;
+    }
 
-    if (keepTrying && state == ConnectionState::Disconnected)
+    if (Timer::Clock::now() < nextAttempt)
     {
-        if (backOff)
-        {
-            backOff--;
-        }
-        else
+        auto* reactor = getReactor();
+        if (reactor && !retryTimer.isArmed())
         {
-            willConnect = IPv4Socket::connect();
+            reactor->schedule(retryTimer, nextAttempt);
         }
+        return false;
+    }
+
+    // no attempt, no backoff and no gate token until the resolver calls retryNow()
+    if (awaitsAddress())
+    {
+        return false;
+    }
+
+    // a reactor that holds the attempt back calls retryNow() once it is its turn
+    auto* reactor = getReactor();
+    if (reactor && !reactor->admit(*this))
+    {
+        return false;
+    }
+
+    if (!std::exchange(firstAttempt, false))
+    {
+        tally(TrafficCounters::Counter::Reconnects);
+    }
+    if (dial())
+    {
+        return true;
     }
 
-    return willConnect;
+    backOffMore();
+    retryIn(backOff);
+    return false;
 }
 
-auto StickySocket::eval(const struct pollfd& response) -> bool
+auto StickySocket::retryNow() -> bool
 {
-    ConnectionState last { state };
-    auto hasChanged = IPv4Socket::eval(response);
-    if (last == ConnectionState::Connecting && state == ConnectionState::Disconnected)
+    if (!keepTrying || state != ConnectionState::Disconnected)
     {
-        attempts++;
-        if (keepTrying)
-        {
-            backOff = (1 << (std::min(attempts, maxRetries) + 1)) * BACKOFF_MULTIPLIER;
-            console::warning(
-                "{} => {} connection timeout // next connection attempt in {} cycles.",
-                get_current_time(), host, backOff
-            );
-        }
+        return false;
+    }
+
+    nextAttempt = Timer::Clock::now();
+    if (auto* reactor = getReactor())
+    {
+        reactor->cancel(retryTimer);
+        reactor->refresh(*this);
+    }
+    return reconnect();
+}
+
+auto StickySocket::enter(ConnectionState newState) -> bool
+{
+    const ConnectionState last { state };
+    if (!IPv4Socket::enter(newState))
+    {
+        return false;
     }
-    else if (last == ConnectionState::Connecting && state == ConnectionState::Connected)
+
+    if (newState == ConnectionState::Connected)
     {
         attempts = 0;
         keepTrying = true;
-        backOff = 0;
+        backOff = std::chrono::milliseconds(0);
+    }
+    else if (newState == ConnectionState::Disconnected && keepTrying)
+    {
+        if (last == ConnectionState::Connecting)
+        {
+            backOffMore();
+        }
+        else if (last == ConnectionState::Connected)
+        {
+            // sessions dropped by one switch reboot must not all come back at once
+            backOff = jitter(BACKOFF_MULTIPLIER);
+        }
+        retryIn(backOff);
+    }
+
+    if (auto* reactor = getReactor())
+    {
+        reactor->refresh(*this);
+    }
+    return true;
+}
+
+void StickySocket::backOffMore()
+{
+    attempts++;
+    const auto ceiling = (1 << (std::min(attempts, maxRetries) + 1)) * BACKOFF_MULTIPLIER;
+    backOff = ceiling / 2 + jitter(ceiling / 2);
+    if (console::enabled(console::Level::WARNING))
+    {
+        console::warning(
+            "{} => {} connection timeout // next connection attempt in {} ms.",
+            get_current_time(), host, backOff.count()
+        );
+    }
+}
+
+void StickySocket::retryIn(std::chrono::milliseconds delay)
+{
+    nextAttempt = Timer::Clock::now() + delay;
+    if (auto* reactor = getReactor())
+    {
+        reactor->schedule(retryTimer, nextAttempt);
+        reactor->refresh(*this);
     }
-    return hasChanged;
 }
 
 auto StickySocket::step() -> bool { return false; }
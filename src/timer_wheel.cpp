@@ -0,0 +1,308 @@
+#include "timer_wheel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace
+{
+
+auto isEmpty(const TimerLink& list) -> bool { return list.next == &list; }
+
+void unlink(TimerLink& node)
+{
+    node.prev->next = node.next;
+    node.next->prev = node.prev;
+    node.prev = &node;
+    node.next = &node;
+}
+
+void append(TimerLink& list, TimerLink& node)
+{
+    node.prev = list.prev;
+    node.next = &list;
+    list.prev->next = &node;
+    list.prev = &node;
+}
+
+void splice(TimerLink& from, TimerLink& into)
+{
+    if (isEmpty(from))
+    {
+        return;
+    }
+    into.next = from.next;
+    into.prev = from.prev;
+    into.next->prev = &into;
+    into.prev->next = &into;
+    from.next = &from;
+    from.prev = &from;
+}
+
+} // anonymous namespace
+
+Timer::Timer(std::function<void()> action)
+    : action(std::move(action))
+    , wheel(nullptr)
+    , tick(0)
+    , level(0)
+{
+}
+
+Timer::~Timer()
+{
+    if (wheel != nullptr)
+    {
+        wheel->cancel(*this);
+    }
+}
+
+auto Timer::isArmed() const -> bool { return wheel != nullptr; }
+
+auto Timer::getDeadline() const -> Clock::time_point { return deadline; }
+
+TimerWheel::TimerWheel(Clock::time_point origin)
+    : origin(origin)
+    , current(0)
+    , armed(0)
+    , counts()
+{
+}
+
+TimerWheel::~TimerWheel()
+{
+    auto release = [](TimerLink& list)
+    {
+        while (!isEmpty(list))
+        {
+            auto* timer = static_cast<Timer*>(list.next);
+            unlink(*timer);
+            timer->wheel = nullptr;
+        }
+    };
+
+    for (auto& slots : levels)
+    {
+        std::ranges::for_each(slots, release);
+    }
+    release(due);
+}
+
+auto TimerWheel::toTick(Clock::time_point deadline) const -> uint64_t
+{
+    if (deadline <= origin)
+    {
+        return 0;
+    }
+    return static_cast<uint64_t>(
+        std::chrono::ceil<std::chrono::milliseconds>(deadline - origin) / RESOLUTION
+    );
+}
+
+void TimerWheel::schedule(Timer& timer, Clock::time_point deadline)
+{
+    if (timer.wheel != nullptr)
+    {
+        timer.wheel->cancel(timer);
+    }
+
+    timer.deadline = deadline;
+    timer.tick = toTick(deadline);
+    timer.wheel = this;
+    armed++;
+    place(timer);
+}
+
+void TimerWheel::place(Timer& timer)
+{
+    if (timer.tick <= current)
+    {
+        timer.level = LEVELS;
+        append(due, timer);
+        return;
+    }
+
+    // lowest level where the timer still shares the enclosing block with now
+    size_t level = 0;
+    while (level + 1 < LEVELS)
+    {
+        const size_t shift = SLOT_BITS * (level + 1);
+        if ((timer.tick >> shift) == (current >> shift))
+        {
+            break;
+        }
+        level++;
+    }
+
+    const size_t slot = (timer.tick >> (SLOT_BITS * level)) & (SLOTS - 1);
+    timer.level = level;
+    counts.at(level)++;
+    append(levels.at(level).at(slot), timer);
+}
+
+void TimerWheel::detach(Timer& timer)
+{
+    unlink(timer);
+    if (timer.level < LEVELS)
+    {
+        counts.at(timer.level)--;
+    }
+    armed--;
+    timer.wheel = nullptr;
+}
+
+void TimerWheel::cancel(Timer& timer)
+{
+    if (timer.wheel == this)
+    {
+        detach(timer);
+    }
+}
+
+void TimerWheel::cascade(size_t level)
+{
+    const size_t slot = (current >> (SLOT_BITS * level)) & (SLOTS - 1);
+    TimerLink pending;
+    splice(levels.at(level).at(slot), pending);
+
+    while (!isEmpty(pending))
+    {
+        auto* timer = static_cast<Timer*>(pending.next);
+        unlink(*timer);
+        counts.at(level)--;
+        place(*timer);
+    }
+}
+
+auto TimerWheel::fire(TimerLink& list) -> size_t
+{
+    // callbacks may schedule or cancel freely, we only walk our own copy
+    TimerLink pending;
+    splice(list, pending);
+
+    size_t fired = 0;
+    while (!isEmpty(pending))
+    {
+        auto* timer = static_cast<Timer*>(pending.next);
+        detach(*timer);
+        if (timer->action)
+        {
+            timer->action();
+        }
+        fired++;
+    }
+    return fired;
+}
+
+auto TimerWheel::advance(Clock::time_point now) -> size_t
+{
+    const uint64_t target =
+        (now <= origin) ? 0
+                        : static_cast<uint64_t>(
+                              std::chrono::floor<std::chrono::milliseconds>(now - origin) /
+                              RESOLUTION
+                          );
+
+    size_t fired = fire(due);
+    while (current < target)
+    {
+        if (armed == 0)
+        {
+            current = target;
+            break;
+        }
+
+        // jump over ticks that cannot fire or cascade anything
+        uint64_t mask = 0;
+        for (size_t level = 0; level < LEVELS && counts.at(level) == 0; level++)
+        {
+            mask = (mask << SLOT_BITS) | (SLOTS - 1);
+        }
+        current = std::min(current | mask, target);
+        if (current == target)
+        {
+            break;
+        }
+
+        current++;
+        for (size_t level = 1; level < LEVELS; level++)
+        {
+            if ((current & ((1ULL << (SLOT_BITS * level)) - 1)) != 0)
+            {
+                break;
+            }
+            cascade(level);
+        }
+
+        fired += fire(levels.front().at(current & (SLOTS - 1)));
+        fired += fire(due);
+    }
+    return fired;
+}
+
+auto TimerWheel::size() const -> size_t { return armed; }
+
+auto TimerWheel::earliest() const -> uint64_t
+{
+    uint64_t best = UINT64_MAX;
+    auto scan = [&best](const TimerLink& list)
+    {
+        for (const TimerLink* node = list.next; node != &list; node = node->next)
+        {
+            best = std::min(best, static_cast<const Timer*>(node)->tick);
+        }
+    };
+
+    for (size_t level = 0; level < LEVELS; level++)
+    {
+        if (counts.at(level) == 0)
+        {
+            continue;
+        }
+
+        const auto& slots = levels.at(level);
+        if (level + 1 == LEVELS)
+        {
+            // the top level may wrap around, no shortcut there
+            std::ranges::for_each(slots, scan);
+            return best;
+        }
+
+        // lower levels only hold timers ahead of now, in slot order
+        const size_t start = (current >> (SLOT_BITS * level)) & (SLOTS - 1);
+        for (size_t i = 0; i < SLOTS; i++)
+        {
+            const auto& list = slots.at((start + i) & (SLOTS - 1));
+            if (!isEmpty(list))
+            {
+                scan(list);
+                return best;
+            }
+        }
+    }
+    return best;
+}
+
+auto TimerWheel::timeout(Clock::time_point now) const -> int
+{
+    if (armed == 0)
+    {
+        return -1;
+    }
+    if (!isEmpty(due))
+    {
+        return 0;
+    }
+
+    const auto wakeAt = origin + (RESOLUTION * earliest());
+    if (wakeAt <= now)
+    {
+        return 0;
+    }
+
+    const auto left = std::chrono::ceil<std::chrono::milliseconds>(wakeAt - now).count();
+    return static_cast<int>(std::min<int64_t>(left, INT_MAX));
+}
@@ -0,0 +1,616 @@
+#include "uring_poller.h"
+#include "console.h"
+#include "easy_socket.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/poll.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace
+{
+
+constexpr uint64_t CANCEL_TAG = UINT64_MAX;
+constexpr uint64_t WAKEUP_TAG = UINT64_MAX - 1;
+constexpr uint32_t SEND_FLAG = 1U << 31U; // in the slot half of a send's user data
+constexpr long NANOS_PER_MILLI = 1000000;
+constexpr int MILLIS_PER_SECOND = 1000;
+
+auto toUserData(uint32_t slot, uint32_t generation) -> uint64_t
+{
+    return (static_cast<uint64_t>(generation) << 32U) | slot;
+}
+
+auto loadAcquire(unsigned* value) -> unsigned
+{
+    return std::atomic_ref<unsigned>(*value).load(std::memory_order_acquire);
+}
+
+void storeRelease(unsigned* target, unsigned value)
+{
+    std::atomic_ref<unsigned>(*target).store(value, std::memory_order_release);
+}
+
+auto mapRing(size_t size, int ring, off_t offset) -> void*
+{
+    const int flags = MAP_SHARED | MAP_POPULATE;
+    void* area = mmap(nullptr, size, PROT_READ | PROT_WRITE, flags, ring, offset);
+    return (area == MAP_FAILED) ? nullptr : area;
+}
+
+} // anonymous namespace
+
+UringPoller::UringPoller()
+    : ring(-1)
+    , params()
+    , sqMap(nullptr)
+    , sqMapSize(0)
+    , sqHead(nullptr)
+    , sqTail(nullptr)
+    , sqMask(nullptr)
+    , sqArray(nullptr)
+    , sqes(nullptr)
+    , sqesSize(0)
+    , prepared(0)
+    , published(0)
+    , cqMap(nullptr)
+    , cqMapSize(0)
+    , cqHead(nullptr)
+    , cqTail(nullptr)
+    , cqMask(nullptr)
+    , cqes(nullptr)
+    , bufRing(nullptr)
+    , bufRingSize(0)
+    , multishot(true)
+    , wakeup(-1)
+{
+    if (!setupRing())
+    {
+        console::warning("io_uring is not available, reason: {}", strerror(errno));
+        return;
+    }
+
+    if (!setupBuffers())
+    {
+        console::warning("io_uring buffer ring is not available, polling for input.");
+    }
+}
+
+UringPoller::~UringPoller()
+{
+    if (bufRing != nullptr)
+    {
+        munmap(bufRing, bufRingSize);
+    }
+    if (sqes != nullptr)
+    {
+        munmap(sqes, sqesSize);
+    }
+    if (cqMap != nullptr && cqMap != sqMap)
+    {
+        munmap(cqMap, cqMapSize);
+    }
+    if (sqMap != nullptr)
+    {
+        munmap(sqMap, sqMapSize);
+    }
+    if (ring >= 0)
+    {
+        close(ring);
+    }
+}
+
+auto UringPoller::setupRing() -> bool
+{
+    ring = static_cast<int>(syscall(__NR_io_uring_setup, QUEUE_DEPTH, &params));
+    if (ring < 0)
+    {
+        return false;
+    }
+
+    if (!(params.features & IORING_FEAT_EXT_ARG))
+    {
+        // cannot wait with a timeout, not worth it
+        errno = ENOTSUP;
+        return false;
+    }
+
+    sqMapSize = params.sq_off.array + (params.sq_entries * sizeof(unsigned));
+    cqMapSize = params.cq_off.cqes + (params.cq_entries * sizeof(struct io_uring_cqe));
+    const bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+    if (single)
+    {
+        sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+    }
+
+    sqMap = mapRing(sqMapSize, ring, IORING_OFF_SQ_RING);
+    cqMap = single ? sqMap : mapRing(cqMapSize, ring, IORING_OFF_CQ_RING);
+    sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+    sqes = static_cast<struct io_uring_sqe*>(mapRing(sqesSize, ring, IORING_OFF_SQES));
+    if (sqMap == nullptr || cqMap == nullptr || sqes == nullptr)
+    {
+        return false;
+    }
+
+    auto* sqBase = static_cast<uint8_t*>(sqMap);
+    sqHead = reinterpret_cast<unsigned*>(sqBase + params.sq_off.head);
+    sqTail = reinterpret_cast<unsigned*>(sqBase + params.sq_off.tail);
+    sqMask = reinterpret_cast<unsigned*>(sqBase + params.sq_off.ring_mask);
+    sqArray = reinterpret_cast<unsigned*>(sqBase + params.sq_off.array);
+
+    auto* cqBase = static_cast<uint8_t*>(cqMap);
+    cqHead = reinterpret_cast<unsigned*>(cqBase + params.cq_off.head);
+    cqTail = reinterpret_cast<unsigned*>(cqBase + params.cq_off.tail);
+    cqMask = reinterpret_cast<unsigned*>(cqBase + params.cq_off.ring_mask);
+    cqes = reinterpret_cast<struct io_uring_cqe*>(cqBase + params.cq_off.cqes);
+    return true;
+}
+
+auto UringPoller::setupBuffers() -> bool
+{
+    bufRingSize = BUFFER_COUNT * sizeof(struct io_uring_buf);
+    const int flags = MAP_ANONYMOUS | MAP_PRIVATE;
+    void* area = mmap(nullptr, bufRingSize, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (area == MAP_FAILED)
+    {
+        return false;
+    }
+    bufRing = static_cast<struct io_uring_buf_ring*>(area);
+
+    struct io_uring_buf_reg reg {
+        .ring_addr = reinterpret_cast<uint64_t>(bufRing), .ring_entries = BUFFER_COUNT,
+        .bgid = BUFFER_GROUP,
+    };
+    if (syscall(__NR_io_uring_register, ring, IORING_REGISTER_PBUF_RING, &reg, 1) < 0)
+    {
+        munmap(bufRing, bufRingSize);
+        bufRing = nullptr;
+        return false;
+    }
+
+    arena.resize(static_cast<size_t>(BUFFER_COUNT) * BUFFER_LENGTH);
+    lent.reserve(BUFFER_COUNT);
+    for (unsigned bid = 0; bid < BUFFER_COUNT; bid++)
+    {
+        lent.push_back(static_cast<uint16_t>(bid));
+    }
+    recycle();
+    return true;
+}
+
+auto UringPoller::isReady() const -> bool { return sqes != nullptr && cqes != nullptr; }
+
+auto UringPoller::hasBufferRing() const -> bool { return bufRing != nullptr; }
+
+auto UringPoller::nextSqe() -> struct io_uring_sqe*
+{
+    if (published + prepared >= params.sq_entries)
+    {
+        submit(0, 0);
+    }
+    if (published + prepared >= params.sq_entries)
+    {
+        return nullptr;
+    }
+
+    const unsigned tail = *sqTail + prepared;
+    const unsigned index = tail & *sqMask;
+    sqArray[index] = index;
+    prepared++;
+
+    auto* sqe = &sqes[index];
+    std::memset(sqe, 0, sizeof(*sqe));
+    return sqe;
+}
+
+auto UringPoller::submit(unsigned waitFor, int timeout) -> int
+{
+    // publish once, entries the kernel leaves behind stay published
+    storeRelease(sqTail, *sqTail + prepared);
+    published += prepared;
+    prepared = 0;
+
+    struct __kernel_timespec span {
+        .tv_sec = timeout / MILLIS_PER_SECOND,
+        .tv_nsec = (timeout % MILLIS_PER_SECOND) * NANOS_PER_MILLI,
+    };
+    struct io_uring_getevents_arg arg {
+        .sigmask = 0, .sigmask_sz = _NSIG / 8,
+        .ts = (timeout >= 0) ? reinterpret_cast<uint64_t>(&span) : 0,
+    };
+
+    const unsigned flags = waitFor ? (IORING_ENTER_GETEVENTS | IORING_ENTER_EXT_ARG) : 0;
+    long done = syscall(
+        __NR_io_uring_enter, ring, published, waitFor, flags, waitFor ? &arg : nullptr,
+        waitFor ? sizeof(arg) : 0
+    );
+
+    if (done >= 0)
+    {
+        published -= std::min(published, static_cast<unsigned>(done));
+    }
+    else if (errno == ETIME || errno == EINTR || errno == EBUSY)
+    {
+        done = 0;
+    }
+    return static_cast<int>(done);
+}
+
+void UringPoller::arm(uint32_t index)
+{
+    auto& slot = slots.at(index);
+    const short events = slot.socket->interest();
+    if (events == 0)
+    {
+        return;
+    }
+
+    auto* sqe = nextSqe();
+    if (sqe == nullptr)
+    {
+        console::error("io_uring submission queue is full, dropping {}", slot.fd);
+        return;
+    }
+
+    sqe->fd = slot.fd;
+    sqe->user_data = toUserData(index, slot.generation);
+    // pending output needs a plain poll, receives go back to the buffer ring after
+    if ((events & POLLIN) && !(events & POLLOUT) && hasBufferRing() && multishot)
+    {
+        sqe->opcode = IORING_OP_RECV;
+        sqe->flags = IOSQE_BUFFER_SELECT;
+        sqe->buf_group = BUFFER_GROUP;
+        sqe->ioprio = IORING_RECV_MULTISHOT;
+        slot.op = Op::Receive;
+    }
+    else
+    {
+        sqe->opcode = IORING_OP_POLL_ADD;
+        sqe->poll32_events = static_cast<uint16_t>(events);
+        sqe->len = (events & POLLOUT) ? 0 : IORING_POLL_ADD_MULTI;
+        slot.op = Op::Poll;
+    }
+}
+
+void UringPoller::armWakeup()
+{
+    auto* sqe = nextSqe();
+    if (sqe == nullptr)
+    {
+        console::error("io_uring submission queue is full, dropping wakeup {}", wakeup);
+        return;
+    }
+
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = wakeup;
+    sqe->poll32_events = POLLIN;
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = WAKEUP_TAG;
+}
+
+void UringPoller::cancel(uint32_t index)
+{
+    auto& slot = slots.at(index);
+    if (slot.op != Op::None)
+    {
+        auto* sqe = nextSqe();
+        if (sqe != nullptr)
+        {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = toUserData(index, slot.generation);
+            sqe->user_data = CANCEL_TAG;
+        }
+        slot.op = Op::None;
+    }
+
+    // late completions of the old operation are recognized as stale
+    slot.generation++;
+}
+
+void UringPoller::watch(EasySocketIntf& skt)
+{
+    const int fd = skt.getDescriptor();
+    if (!isReady() || fd == EasySocketIntf::INVALID_SOCKET)
+    {
+        return;
+    }
+
+    uint32_t index = 0;
+    auto found = registered.find(&skt);
+    if (found != registered.end())
+    {
+        index = found->second;
+        cancel(index);
+    }
+    else if (!freeSlots.empty())
+    {
+        index = freeSlots.back();
+        freeSlots.pop_back();
+        registered[&skt] = index;
+    }
+    else
+    {
+        index = static_cast<uint32_t>(slots.size());
+        slots.push_back(Slot {
+            .socket = nullptr, .fd = -1, .generation = 0, .op = Op::None, .outbox = {},
+        });
+        registered[&skt] = index;
+    }
+
+    auto& slot = slots.at(index);
+    slot.socket = &skt;
+    slot.fd = fd;
+    arm(index);
+}
+
+void UringPoller::forget(EasySocketIntf& skt)
+{
+    auto found = registered.find(&skt);
+    if (found == registered.end())
+    {
+        return;
+    }
+
+    const uint32_t index = found->second;
+    auto& outbox = slots.at(index).outbox;
+    if (outbox && !outbox->frames.empty())
+    {
+        // its frames are let go once the cancellation completes it
+        auto* sqe = nextSqe();
+        if (sqe != nullptr)
+        {
+            sqe->opcode = IORING_OP_ASYNC_CANCEL;
+            sqe->addr = toUserData(index | SEND_FLAG, slots.at(index).generation);
+            sqe->user_data = CANCEL_TAG;
+        }
+    }
+    cancel(index);
+    slots.at(index).socket = nullptr;
+    slots.at(index).fd = -1;
+    freeSlots.push_back(index);
+    registered.erase(found);
+
+    // make sure nothing is left reading into a descriptor about to be closed
+    submit(0, 0);
+}
+
+void UringPoller::wakeOn(int fd)
+{
+    if (!isReady())
+    {
+        return;
+    }
+
+    wakeup = fd;
+    armWakeup();
+}
+
+auto UringPoller::transmit(
+    EasySocketIntf& skt, const std::deque<FrameRef>& queue, size_t offset
+) -> bool
+{
+    auto found = registered.find(&skt);
+    if (found == registered.end() || queue.empty())
+    {
+        return false;
+    }
+
+    const uint32_t index = found->second;
+    auto& slot = slots.at(index);
+    if (!slot.outbox)
+    {
+        slot.outbox = std::make_unique<Outbox>();
+    }
+    auto& outbox = *slot.outbox;
+    if (!outbox.frames.empty())
+    {
+        // a cancelled send of the slot's last owner still holds it
+        return false;
+    }
+
+    auto* sqe = nextSqe();
+    if (sqe == nullptr)
+    {
+        return false;
+    }
+
+    size_t count = 0;
+    for (const auto& frame : queue)
+    {
+        if (count == outbox.iov.size())
+        {
+            break;
+        }
+        // the kernel does not write through iov_base, the frame stays immutable
+        const auto bytes = frame->bytes().subspan((count == 0) ? offset : 0);
+        outbox.iov.at(count++) = iovec {
+            .iov_base = const_cast<uint8_t*>(bytes.data()), .iov_len = bytes.size(),
+        };
+        outbox.frames.push_back(frame);
+    }
+    outbox.msg = msghdr {};
+    outbox.msg.msg_iov = outbox.iov.data();
+    outbox.msg.msg_iovlen = count;
+
+    sqe->opcode = IORING_OP_SENDMSG;
+    sqe->fd = slot.fd;
+    sqe->addr = reinterpret_cast<uint64_t>(&outbox.msg);
+    sqe->len = 1;
+    sqe->msg_flags = MSG_NOSIGNAL;
+    sqe->user_data = toUserData(index | SEND_FLAG, slot.generation);
+    return true;
+}
+
+void UringPoller::recycle()
+{
+    if (bufRing == nullptr || lent.empty())
+    {
+        return;
+    }
+
+    // the flexible bufs[] member is padded differently in C++, index the ring directly
+    auto* bufs = reinterpret_cast<struct io_uring_buf*>(bufRing);
+    std::atomic_ref<uint16_t> ringTail(bufRing->tail);
+    uint16_t tail = ringTail.load(std::memory_order_relaxed);
+    for (const auto bid : lent)
+    {
+        auto& buf = bufs[tail & (BUFFER_COUNT - 1)];
+        buf.addr = reinterpret_cast<uint64_t>(arena.data() + (bid * BUFFER_LENGTH));
+        buf.len = BUFFER_LENGTH;
+        buf.bid = bid;
+        tail++;
+    }
+    ringTail.store(tail, std::memory_order_release);
+    lent.clear();
+}
+
+auto UringPoller::reap(const struct io_uring_cqe& cqe, std::vector<Readiness>& ready)
+    -> bool
+{
+    if (cqe.user_data == CANCEL_TAG)
+    {
+        return false;
+    }
+
+    if (cqe.user_data == WAKEUP_TAG)
+    {
+        if (!(cqe.flags & IORING_CQE_F_MORE) && cqe.res >= 0)
+        {
+            armWakeup();
+        }
+        ready.push_back(Readiness {
+            .socket = nullptr, .revents = POLLIN, .data = {}, .sent = {},
+        });
+        return true;
+    }
+
+    const bool hasBuffer = (cqe.flags & IORING_CQE_F_BUFFER) != 0;
+    const auto bid = static_cast<uint16_t>(cqe.flags >> IORING_CQE_BUFFER_SHIFT);
+    const bool sending = (cqe.user_data & SEND_FLAG) != 0;
+    const auto index = static_cast<uint32_t>(cqe.user_data & UINT32_MAX & ~SEND_FLAG);
+    const auto generation = static_cast<uint32_t>(cqe.user_data >> 32U);
+
+    if (sending && index < slots.size() && slots[index].outbox)
+    {
+        // done with the frames, whoever owns the slot by now
+        slots[index].outbox->frames.clear();
+    }
+
+    if (index >= slots.size() || slots[index].generation != generation ||
+        slots[index].socket == nullptr)
+    {
+        if (hasBuffer)
+        {
+            lent.push_back(bid);
+        }
+        return false;
+    }
+
+    auto& slot = slots[index];
+    if (sending)
+    {
+        ready.push_back(Readiness {
+            .socket = slot.socket, .revents = 0, .data = {}, .sent = cqe.res,
+        });
+        return true;
+    }
+
+    const bool more = (cqe.flags & IORING_CQE_F_MORE) != 0;
+    bool rearm = false;
+    Readiness event { .socket = slot.socket, .revents = 0, .data = {}, .sent = {} };
+
+    if (cqe.res == -ECANCELED)
+    {
+        // nothing to report
+    }
+    else if (slot.op == Op::Receive)
+    {
+        if (cqe.res > 0 && hasBuffer)
+        {
+            event.revents = POLLIN;
+            event.data = {
+                arena.data() + (bid * BUFFER_LENGTH), static_cast<size_t>(cqe.res),
+            };
+            lent.push_back(bid);
+            rearm = true;
+        }
+        else if (cqe.res == 0)
+        {
+            event.revents = POLLHUP;
+        }
+        else if (cqe.res == -ENOBUFS)
+        {
+            // ran dry, buffers come back with the next wait
+            rearm = true;
+        }
+        else if (cqe.res == -EINVAL && multishot)
+        {
+            // the buffer ring registered but multishot receives did not (5.19)
+            console::warning("io_uring multishot receive is not available, polling.");
+            multishot = false;
+            rearm = true;
+        }
+        else
+        {
+            event.revents = POLLERR;
+        }
+    }
+    else if (slot.op == Op::Poll)
+    {
+        event.revents = (cqe.res < 0) ? static_cast<short>(POLLERR)
+                                      : static_cast<short>(cqe.res);
+        rearm = (cqe.res == 0 || (cqe.res > 0 && (slot.socket->interest() & POLLIN)));
+    }
+
+    if (!more)
+    {
+        slot.op = Op::None;
+        if (rearm)
+        {
+            arm(index);
+        }
+    }
+
+    if (event.revents != 0)
+    {
+        ready.push_back(event);
+        return true;
+    }
+    return false;
+}
+
+auto UringPoller::wait(std::vector<Readiness>& ready, int timeout) -> int
+{
+    ready.clear();
+    if (!isReady())
+    {
+        return -1;
+    }
+
+    recycle();
+    const unsigned waitFor = (timeout == 0) ? 0 : 1;
+    if ((prepared || published || waitFor) && submit(waitFor, timeout) < 0)
+    {
+        console::error("io_uring_enter failed, reason: {}", strerror(errno));
+        return -1;
+    }
+
+    unsigned head = *cqHead;
+    const unsigned tail = loadAcquire(cqTail);
+    for (; head != tail; head++)
+    {
+        reap(cqes[head & *cqMask], ready);
+    }
+    storeRelease(cqHead, head);
+
+    return static_cast<int>(ready.size());
+}
@@ -1,6 +1,8 @@
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <sys/epoll.h>
 #include <sys/poll.h>
+#include <sys/uio.h>
 
 #include "ioi.h"
 
@@ -15,4 +17,17 @@ class IoMockAdapter : public IoIntf
     MOCK_METHOD(size_t, recv, (int, void*, size_t, int), (const, override));
     MOCK_METHOD(int, getsockopt, (int, int, int, void*, socklen_t*), (const, override));
     MOCK_METHOD(int, poll, (struct pollfd*, nfds_t, int), (const, override));
+    MOCK_METHOD(int, epoll_create1, (int), (const, override));
+    MOCK_METHOD(int, epoll_ctl, (int, int, int, struct epoll_event*), (const, override));
+    MOCK_METHOD(int, epoll_wait, (int, struct epoll_event*, int, int), (const, override));
+    MOCK_METHOD(int, eventfd, (unsigned int, int), (const, override));
+    MOCK_METHOD(ssize_t, read, (int, void*, size_t), (const, override));
+    MOCK_METHOD(ssize_t, write, (int, const void*, size_t), (const, override));
+    MOCK_METHOD(ssize_t, writev, (int, const struct iovec*, int), (const, override));
+    MOCK_METHOD(
+        int, getaddrinfo,
+        (const char*, const char*, const struct addrinfo*, struct addrinfo**),
+        (const, override)
+    );
+    MOCK_METHOD(void, freeaddrinfo, (struct addrinfo*), (const, override));
 };
@@ -0,0 +1,62 @@
+#include "buffer_pool.h"
+
+#include <cstddef>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+TEST(BufferPool, leases_round_up_to_the_next_class)
+{
+    BufferPool pool(BufferPoolConfig { .sizes = { 4096, 512 }, .keep = 4 });
+
+    const auto small = pool.lease(100);
+    const auto large = pool.lease(513);
+
+    EXPECT_EQ(small.size(), 512);
+    EXPECT_EQ(large.size(), 4096);
+    EXPECT_EQ(pool.outstanding(), 2);
+}
+
+TEST(BufferPool, returned_buffers_are_reused)
+{
+    BufferPool pool;
+    const uint8_t* first = nullptr;
+    {
+        const auto lease = pool.lease(512);
+        first = lease.data();
+    }
+    EXPECT_EQ(pool.outstanding(), 0);
+    EXPECT_EQ(pool.idleBytes(), 512);
+
+    const auto again = pool.lease(512);
+    EXPECT_EQ(again.data(), first);
+    EXPECT_EQ(pool.idleBytes(), 0);
+}
+
+TEST(BufferPool, keeps_only_so_many_idle_buffers)
+{
+    BufferPool pool(BufferPoolConfig { .sizes = { 64 }, .keep = 1 });
+    {
+        const auto one = pool.lease(64);
+        const auto two = pool.lease(64);
+    }
+
+    EXPECT_EQ(pool.idleBytes(), 64);
+    pool.trim();
+    EXPECT_EQ(pool.idleBytes(), 0);
+}
+
+TEST(BufferPool, oversized_leases_are_served_but_not_kept)
+{
+    BufferPool pool(BufferPoolConfig { .sizes = { 64 }, .keep = 4 });
+    {
+        auto lease = pool.lease(1000);
+        EXPECT_EQ(lease.size(), 1000);
+        auto moved = std::move(lease);
+        EXPECT_FALSE(lease); // NOLINT(bugprone-use-after-move)
+        EXPECT_TRUE(moved);
+    }
+
+    EXPECT_EQ(pool.outstanding(), 0);
+    EXPECT_EQ(pool.idleBytes(), 0);
+}
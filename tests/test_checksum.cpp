@@ -0,0 +1,117 @@
+#include "checksum.h"
+#include "sicp_decoder.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using checksum::Kernel;
+
+namespace
+{
+
+auto reference(std::span<const uint8_t> data) -> uint8_t
+{
+    uint8_t sum = 0;
+    for (const auto byte : data)
+    {
+        sum ^= byte;
+    }
+    return sum;
+}
+
+auto randomBytes(size_t size, uint32_t seed) -> std::vector<uint8_t>
+{
+    std::mt19937 gen(seed);
+    std::uniform_int_distribution<int> dist(0, 255);
+    std::vector<uint8_t> bytes(size);
+    for (auto& byte : bytes)
+    {
+        byte = static_cast<uint8_t>(dist(gen));
+    }
+    return bytes;
+}
+
+} // anonymous namespace
+
+class ChecksumKernelTest : public ::testing::TestWithParam<Kernel>
+{
+};
+
+TEST_P(ChecksumKernelTest, matches_scalar_reference_for_any_size_and_alignment)
+{
+    if (!checksum::isSupported(GetParam()))
+    {
+        GTEST_SKIP() << "kernel is not supported by this CPU.";
+    }
+
+    const auto bytes = randomBytes(1100, 42);
+    for (size_t offset = 0; offset < 33; offset++)
+    {
+        for (size_t size = 0; size + offset <= bytes.size(); size += 7)
+        {
+            const auto view = std::span(bytes).subspan(offset, size);
+            ASSERT_EQ(checksum::compute(view, GetParam()), reference(view))
+                << "offset " << offset << ", size " << size;
+        }
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    Kernels,
+    ChecksumKernelTest,
+    ::testing::Values(Kernel::Scalar, Kernel::Sse2, Kernel::Avx2)
+);
+
+TEST(Checksum, default_kernel_is_the_best_supported)
+{
+    const auto bytes = randomBytes(300, 7);
+
+    EXPECT_TRUE(checksum::isSupported(checksum::bestKernel()));
+    EXPECT_EQ(checksum::compute(bytes), reference(bytes));
+}
+
+TEST(Checksum, batch_verifies_frames_laid_out_back_to_back)
+{
+    std::vector<uint8_t> buffer;
+    std::array<uint8_t, sicp::MAX_FRAME> frame {};
+    for (uint8_t i = 0; i < 10; i++)
+    {
+        const auto data = randomBytes(i * 20, i);
+        const size_t length = sicp::encode(frame, 0x01, 0x01, data);
+        ASSERT_GT(length, 0);
+        if (i == 4)
+        {
+            frame[length - 1] ^= 0x5a;
+        }
+        buffer.insert(buffer.end(), frame.begin(), frame.begin() + length);
+    }
+    const size_t complete = buffer.size();
+    buffer.push_back(200); // truncated frame at the end
+
+    std::vector<uint8_t> verdicts(10, 2);
+    const auto result = checksum::verifyFrames(buffer, verdicts);
+
+    EXPECT_EQ(result.frames, 10);
+    EXPECT_EQ(result.valid, 9);
+    EXPECT_EQ(result.consumed, complete);
+    EXPECT_EQ(verdicts, (std::vector<uint8_t> { 1, 1, 1, 1, 0, 1, 1, 1, 1, 1 }));
+}
+
+TEST(Checksum, encoded_frame_passes_decoder_validation)
+{
+    std::array<uint8_t, sicp::MAX_FRAME> frame {};
+    const std::vector<uint8_t> data { 0x19, 0x20 };
+
+    const size_t length = sicp::encode(frame, 0x01, 0x02, data);
+
+    ASSERT_EQ(length, 6);
+    EXPECT_EQ(frame[0], 6);
+    EXPECT_TRUE(sicp::isValid(std::span(frame).first(length)));
+    EXPECT_EQ(sicp::encode(frame, 0x01, 0x02, std::vector<uint8_t>(252)), 0);
+}
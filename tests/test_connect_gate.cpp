@@ -0,0 +1,178 @@
+#include "connect_gate.h"
+#include "easy_socket.h"
+#include "iomock.h"
+#include "session_store.h"
+#include "sticky_engine.h"
+#include "sticky_socket.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/poll.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr std::string A_HOST = "127.0.0.1";
+constexpr uint16_t FIRST_PORT = 9000;
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_ADDRESS = 1;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+
+using namespace std::chrono_literals;
+
+TEST(ConnectGate, opens_wide_without_limits)
+{
+    ConnectGate gate;
+    const auto now = ConnectGate::Clock::now();
+
+    EXPECT_FALSE(gate.isLimited());
+    for (size_t i = 0; i < 100; i++)
+    {
+        EXPECT_TRUE(gate.tryAdmit(now, i));
+    }
+    EXPECT_EQ(gate.untilToken(now), 0ms);
+}
+
+TEST(ConnectGate, bucket_paces_attempts_after_burst)
+{
+    ConnectGate gate;
+    gate.configure(ConnectGate::Limits { .perSecond = 10.0, .burst = 2 });
+    const auto now = ConnectGate::Clock::now();
+
+    EXPECT_TRUE(gate.tryAdmit(now, 0));
+    EXPECT_TRUE(gate.tryAdmit(now, 0));
+    EXPECT_FALSE(gate.tryAdmit(now, 0));
+    EXPECT_EQ(gate.untilToken(now), 100ms);
+
+    EXPECT_FALSE(gate.tryAdmit(now + 50ms, 0));
+    EXPECT_TRUE(gate.tryAdmit(now + 100ms, 0));
+    EXPECT_FALSE(gate.tryAdmit(now + 100ms, 0));
+
+    // an idle bucket fills up to its burst, not beyond
+    EXPECT_TRUE(gate.tryAdmit(now + 10s, 0));
+    EXPECT_TRUE(gate.tryAdmit(now + 10s, 0));
+    EXPECT_FALSE(gate.tryAdmit(now + 10s, 0));
+}
+
+TEST(ConnectGate, caps_attempts_in_flight)
+{
+    ConnectGate gate;
+    gate.configure(ConnectGate::Limits { .maxConnecting = 2 });
+    const auto now = ConnectGate::Clock::now();
+
+    EXPECT_TRUE(gate.tryAdmit(now, 1));
+    EXPECT_FALSE(gate.tryAdmit(now, 2));
+    EXPECT_TRUE(gate.isFull(2));
+    EXPECT_EQ(gate.untilToken(now), 0ms);
+}
+
+TEST(ConnectGate, line_keeps_order_and_each_session_once)
+{
+    ConnectGate gate;
+    const SessionHandle first { .index = 4, .generation = 1 };
+    const SessionHandle second { .index = 2, .generation = 1 };
+    const SessionHandle reused { .index = 4, .generation = 2 };
+
+    EXPECT_TRUE(gate.enqueue(first));
+    EXPECT_TRUE(gate.enqueue(second));
+    EXPECT_FALSE(gate.enqueue(first));
+    EXPECT_TRUE(gate.enqueue(reused)); // the slot's new session is no duplicate
+
+    EXPECT_EQ(gate.waiting(), 3);
+    EXPECT_EQ(gate.front(), first);
+    gate.pop();
+    EXPECT_EQ(gate.front(), second);
+    gate.pop();
+    EXPECT_FALSE(gate.enqueue(reused));
+    gate.pop();
+    EXPECT_EQ(gate.waiting(), 0);
+    EXPECT_FALSE(gate.front().isValid());
+}
+
+class ConnectStormTest : public ::testing::Test
+{
+  protected:
+    static constexpr size_t FLEET = 10;
+    static constexpr size_t MAX_CONNECTING = 3;
+
+    IoMockAdapter iomock;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, eventfd(_, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _))
+            .WillRepeatedly(Return(GOOD_ADDRESS));
+        EXPECT_CALL(iomock, socket(_, _, _)).WillRepeatedly(Return(GOOD_DESCRIPTOR));
+        EXPECT_CALL(iomock, connect(_, _, _))
+            .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+        EXPECT_CALL(iomock, getsockopt(_, _, _, _, _)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, poll(_, _, _)).WillRepeatedly(Return(0));
+    }
+
+    static auto connecting(const StickyEngine& engine) -> size_t
+    {
+        return engine.getHotState().count(EasySocketIntf::ConnectionState::Connecting);
+    }
+};
+
+TEST_F(ConnectStormTest, gate_holds_back_the_wave_and_lets_it_in_order)
+{
+    StickyEngine engine(iomock);
+    engine.setConnectLimits(ConnectGate::Limits { .maxConnecting = MAX_CONNECTING });
+    std::vector<StickySocket*> fleet;
+    for (size_t i = 0; i < FLEET; i++)
+    {
+        auto port = static_cast<uint16_t>(FIRST_PORT + i);
+        fleet.push_back(&engine.makeSocket<StickySocket>(A_HOST, port));
+    }
+
+    for (auto* skt : fleet)
+    {
+        skt->connect();
+    }
+    EXPECT_EQ(connecting(engine), MAX_CONNECTING);
+    EXPECT_EQ(engine.getHotState().connecting(), MAX_CONNECTING);
+    EXPECT_EQ(engine.getMetrics().connectQueue, FLEET - MAX_CONNECTING);
+    EXPECT_EQ(engine.getMetrics().connectsDeferred, FLEET - MAX_CONNECTING);
+
+    // one attempt completes, the first in line takes its place
+    using State = EasySocketIntf::ConnectionState;
+    fleet.front()->eval(pollfd { .fd = GOOD_DESCRIPTOR, .events = 0, .revents = POLLOUT });
+    EXPECT_EQ(fleet.front()->getState(), State::Connected);
+    engine.poll(0);
+
+    EXPECT_EQ(connecting(engine), MAX_CONNECTING);
+    EXPECT_EQ(fleet.at(MAX_CONNECTING)->getState(), State::Connecting);
+    EXPECT_EQ(fleet.at(MAX_CONNECTING + 1)->getState(), State::Disconnected);
+    EXPECT_EQ(engine.getMetrics().connectQueue, FLEET - MAX_CONNECTING - 1);
+}
+
+TEST_F(ConnectStormTest, stopped_session_gives_up_its_place_in_line)
+{
+    StickyEngine engine(iomock);
+    engine.setConnectLimits(ConnectGate::Limits { .maxConnecting = 1 });
+    auto& busy = engine.makeSocket<StickySocket>(A_HOST, FIRST_PORT);
+    auto& stopped = engine.makeSocket<StickySocket>(A_HOST, FIRST_PORT + 1);
+    auto& next = engine.makeSocket<StickySocket>(A_HOST, FIRST_PORT + 2);
+
+    busy.connect();
+    stopped.connect();
+    next.connect();
+    stopped.disconnect();
+    busy.disconnect();
+    engine.poll(0);
+
+    EXPECT_EQ(stopped.getState(), EasySocketIntf::ConnectionState::Disconnected);
+    EXPECT_EQ(next.getState(), EasySocketIntf::ConnectionState::Connecting);
+    EXPECT_EQ(engine.getMetrics().connectQueue, 0);
+}
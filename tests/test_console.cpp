@@ -1,6 +1,56 @@
 #include "console.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
 #include <gtest/gtest.h>
 
+namespace
+{
+
+// the writer thread prints to std::cout, so swap its buffer while it runs
+class CaptureOutput
+{
+  public:
+    CaptureOutput()
+        : saved(std::cout.rdbuf(captured.rdbuf()))
+    {
+    }
+
+    ~CaptureOutput() { std::cout.rdbuf(saved); }
+
+    // bad luck
+    CaptureOutput(const CaptureOutput&) = delete;
+    CaptureOutput& operator=(const CaptureOutput&) = delete;
+    CaptureOutput(CaptureOutput&&) = delete;
+    CaptureOutput& operator=(CaptureOutput&&) = delete;
+
+    auto lines() const -> std::vector<std::string>
+    {
+        std::vector<std::string> all;
+        std::istringstream in(captured.str());
+        for (std::string line; std::getline(in, line);)
+        {
+            all.push_back(line);
+        }
+        return all;
+    }
+
+  private:
+    std::ostringstream captured;
+    std::streambuf* saved;
+};
+
+} // anonymous namespace
+
 TEST(ConsoleTest, can_call_functions_without_format_args)
 {
     console::debug("anything");
@@ -16,3 +66,121 @@ TEST(Console, can_call_functions_with_format_args)
     console::warning("anything over {} goes dangerously {}", 10, "fast");
     console::error("if you don't make {} your thing what are you doing?", "templates");
 }
+
+TEST(Console, async_writer_keeps_each_threads_order)
+{
+    constexpr int THREADS = 4;
+    constexpr int MESSAGES = 200;
+    CaptureOutput output;
+
+    console::startAsync(
+        { .capacity = MESSAGES * THREADS, .overflow = console::Overflow::Drop }
+    );
+    std::vector<std::thread> loggers;
+    for (int t = 0; t < THREADS; t++)
+    {
+        loggers.emplace_back([t]()
+        {
+            for (int i = 0; i < MESSAGES; i++)
+            {
+                console::info("{} {}", t, i);
+            }
+        });
+    }
+    for (auto& logger : loggers)
+    {
+        logger.join();
+    }
+    console::flush();
+    console::stopAsync();
+
+    std::vector<int> next(THREADS, 0);
+    for (const auto& line : output.lines())
+    {
+        int thread = 0;
+        int seq = 0;
+        ASSERT_EQ(std::sscanf(line.c_str(), "[INFO] %d %d", &thread, &seq), 2) << line;
+        EXPECT_EQ(seq, next.at(thread)++);
+    }
+    EXPECT_EQ(next, std::vector<int>(THREADS, MESSAGES));
+}
+
+TEST(Console, full_ring_counts_what_it_dropped)
+{
+    constexpr int MESSAGES = 5000;
+    CaptureOutput output;
+    const uint64_t before = console::dropped();
+
+    console::startAsync({ .capacity = 2, .overflow = console::Overflow::Count });
+    for (int i = 0; i < MESSAGES; i++)
+    {
+        console::debug("burst {}", i);
+    }
+    console::flush();
+    console::stopAsync();
+
+    const uint64_t lost = console::dropped() - before;
+    size_t written = 0;
+    bool reported = false;
+    for (const auto& line : output.lines())
+    {
+        written += line.starts_with("[DEBUG] burst") ? 1 : 0;
+        reported |= line.ends_with("log messages dropped.");
+    }
+    EXPECT_EQ(written + lost, MESSAGES);
+    EXPECT_EQ(reported, lost > 0);
+}
+
+TEST(Console, runtime_level_filters_before_formatting)
+{
+    const auto saved = console::getLevel();
+    CaptureOutput output;
+
+    console::setLevel(console::Level::WARNING);
+    console::debug("hidden {}", 1);
+    console::info("hidden {}", 2);
+    const std::array<uint8_t, 2> bytes { 0xAB, 0xCD };
+    console::buffer("hidden", bytes);
+    console::warning("shown {}", 3);
+    EXPECT_FALSE(console::enabled(console::Level::INFO));
+    console::setLevel(saved);
+
+    EXPECT_EQ(output.lines(), std::vector<std::string> { "[WARNING] shown 3" });
+}
+
+TEST(Console, hex_dump_keeps_the_classic_single_line_format)
+{
+    const std::array<uint8_t, 4> bytes { 0x00, 0x0F, 0xA5, 0xFF };
+    std::string out { ">" };
+
+    console::hexDump(out, bytes);
+
+    EXPECT_EQ(out, ">00 0f a5 ff ");
+}
+
+TEST(Console, hex_dump_breaks_lines_with_offsets_and_ascii)
+{
+    const std::string_view text { "Hello\nSICP" };
+    std::string out;
+
+    console::hexDump(
+        out, { reinterpret_cast<const uint8_t*>(text.data()), text.size() },
+        { .perLine = 8, .ascii = true, .limit = 0 }
+    );
+
+    EXPECT_EQ(
+        out,
+        "\n00000000: 48 65 6c 6c 6f 0a 53 49 |Hello.SI|"
+        "\n00000008: 43 50                   |CP|"
+    );
+}
+
+TEST(Console, hex_dump_truncates_large_payloads)
+{
+    const std::vector<uint8_t> bytes(100, 0x42);
+    std::string out;
+
+    console::hexDump(out, bytes, { .perLine = 0, .ascii = false, .limit = 2 });
+
+    EXPECT_EQ(out, "42 42 ... (98 more)");
+}
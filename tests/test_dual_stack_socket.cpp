@@ -0,0 +1,333 @@
+#include "dual_stack_socket.h"
+#include "easy_socket.h"
+#include "iomock.h"
+#include "resolver.h"
+#include "sticky_engine.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr std::string A_NAME = "display.local";
+constexpr std::string AN_IPV6_LITERAL = "fd00::7";
+constexpr uint16_t ANY_PORT = 9999;
+
+constexpr int IPV6_DESCRIPTOR = 3;
+constexpr int IPV4_DESCRIPTOR = 4;
+constexpr int WAKE_DESCRIPTOR = 8;
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+
+namespace
+{
+
+auto addressOf(int family, const char* text) -> SocketAddress
+{
+    SocketAddress address {};
+    if (family == AF_INET6)
+    {
+        auto& ipv6 = reinterpret_cast<struct sockaddr_in6&>(address.storage);
+        ipv6.sin6_family = AF_INET6;
+        ipv6.sin6_port = htons(ANY_PORT);
+        ::inet_pton(AF_INET6, text, &ipv6.sin6_addr);
+        address.length = sizeof(ipv6);
+    }
+    else
+    {
+        auto& ipv4 = reinterpret_cast<struct sockaddr_in&>(address.storage);
+        ipv4.sin_family = AF_INET;
+        ipv4.sin_port = htons(ANY_PORT);
+        ::inet_pton(AF_INET, text, &ipv4.sin_addr);
+        address.length = sizeof(ipv4);
+    }
+    return address;
+}
+
+auto dualStack() -> Resolver::Resolution
+{
+    return Resolver::Resolution {
+        .addresses = { addressOf(AF_INET, "10.0.0.7"), addressOf(AF_INET6, "fd00::7") },
+        .expires = Resolver::Clock::time_point::max(),
+    };
+}
+
+// only the descriptor given counts as connected, whoever polls for it
+auto readyOnly(int ready)
+{
+    return [ready](struct pollfd* fds, nfds_t count, int)
+    {
+        int events = 0;
+        for (nfds_t i = 0; i < count; i++)
+        {
+            fds[i].revents = (fds[i].fd == ready) ? POLLOUT : 0;
+            events += (fds[i].fd == ready) ? 1 : 0;
+        }
+        return events;
+    };
+}
+
+} // anonymous namespace
+
+class DualStackSocketTest : public ::testing::Test
+{
+  protected:
+    NiceMock<IoMockAdapter> iomock;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        ON_CALL(iomock, eventfd(_, _)).WillByDefault(Return(WAKE_DESCRIPTOR));
+        ON_CALL(iomock, getsockopt(_, SOL_SOCKET, SO_ERROR, _, _))
+            .WillByDefault(Return(0));
+        ON_CALL(iomock, socket(AF_INET6, _, _)).WillByDefault(Return(IPV6_DESCRIPTOR));
+        ON_CALL(iomock, socket(AF_INET, _, _)).WillByDefault(Return(IPV4_DESCRIPTOR));
+        ON_CALL(iomock, connect(_, _, _))
+            .WillByDefault(SetErrnoAndReturn(EINPROGRESS, -1));
+    }
+
+    // runs the engine until the socket is online, or gives up after a while
+    static void settle(StickyEngine& engine, DualStackSocket& skt)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        while (skt.getState() != EasySocketIntf::ConnectionState::Connected &&
+               std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+        {
+            engine.poll(10);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }
+};
+
+TEST_F(DualStackSocketTest, families_take_turns_starting_with_ipv6)
+{
+    DualStackSocket skt(iomock, A_NAME, ANY_PORT);
+    auto resolution = dualStack();
+    resolution.addresses.push_back(addressOf(AF_INET, "10.0.0.8"));
+    skt.useAddresses(resolution);
+
+    const auto& candidates = skt.getCandidates();
+    ASSERT_EQ(candidates.size(), 3);
+    EXPECT_EQ(candidates.at(0).family(), AF_INET6);
+    EXPECT_EQ(candidates.at(1).family(), AF_INET);
+    EXPECT_EQ(candidates.at(2).family(), AF_INET);
+    EXPECT_EQ(skt.getAddress().family(), AF_INET6);
+    EXPECT_TRUE(skt.isResolved());
+}
+
+TEST_F(DualStackSocketTest, ipv6_literal_connects_over_ipv6)
+{
+    EXPECT_CALL(iomock, inet_pton(_, _, _))
+        .WillRepeatedly([](int family, const char* text, void* out)
+    { return ::inet_pton(family, text, out); });
+    EXPECT_CALL(iomock, socket(AF_INET6, SOCK_STREAM | SOCK_NONBLOCK, 0))
+        .WillOnce(Return(IPV6_DESCRIPTOR));
+    EXPECT_CALL(iomock, connect(IPV6_DESCRIPTOR, _, sizeof(struct sockaddr_in6)))
+        .WillOnce(SetErrnoAndReturn(EINPROGRESS, -1));
+
+    DualStackSocket skt(iomock, AN_IPV6_LITERAL, ANY_PORT);
+
+    EXPECT_TRUE(skt.connect());
+    EXPECT_EQ(skt.getDescriptor(), IPV6_DESCRIPTOR);
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connecting);
+}
+
+TEST_F(DualStackSocketTest, unreachable_family_hands_over_on_the_spot)
+{
+    EXPECT_CALL(iomock, connect(IPV6_DESCRIPTOR, _, _))
+        .WillOnce(SetErrnoAndReturn(ENETUNREACH, -1));
+    EXPECT_CALL(iomock, close(IPV6_DESCRIPTOR)).WillOnce(Return(0));
+    EXPECT_CALL(iomock, connect(IPV4_DESCRIPTOR, _, sizeof(struct sockaddr_in)))
+        .WillOnce(SetErrnoAndReturn(EINPROGRESS, -1));
+
+    DualStackSocket skt(iomock, A_NAME, ANY_PORT);
+    skt.useAddresses(dualStack());
+
+    EXPECT_TRUE(skt.connect());
+    EXPECT_EQ(skt.getDescriptor(), IPV4_DESCRIPTOR);
+    EXPECT_EQ(skt.racing(), 0);
+}
+
+TEST_F(DualStackSocketTest, silent_family_is_raced_after_attempt_delay)
+{
+    EXPECT_CALL(iomock, poll(_, _, _)).WillRepeatedly(readyOnly(IPV4_DESCRIPTOR));
+    EXPECT_CALL(iomock, close(IPV6_DESCRIPTOR)).WillOnce(Return(0));
+
+    StickyEngine engine(iomock);
+    auto& skt = engine.makeSocket<DualStackSocket>(A_NAME, ANY_PORT);
+    auto& dual = static_cast<DualStackSocket&>(skt);
+    dual.useAddresses(dualStack());
+    const auto start = std::chrono::steady_clock::now();
+    ASSERT_TRUE(skt.connect());
+    EXPECT_EQ(skt.getDescriptor(), IPV6_DESCRIPTOR);
+
+    settle(engine, dual);
+
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connected);
+    EXPECT_EQ(skt.getDescriptor(), IPV4_DESCRIPTOR);
+    EXPECT_GE(std::chrono::steady_clock::now() - start, DualStackSocket::ATTEMPT_DELAY);
+    EXPECT_EQ(dual.racing(), 0);
+}
+
+TEST_F(DualStackSocketTest, earlier_attempt_still_wins_the_race)
+{
+    // the loop polls the watched attempt and its wakeup, IPv6 answers only once parked
+    auto lateIpv6 = readyOnly(IPV6_DESCRIPTOR);
+    EXPECT_CALL(iomock, poll(_, _, _))
+        .WillRepeatedly([&lateIpv6](struct pollfd* fds, nfds_t count, int timeout)
+    { return (count == 1) ? lateIpv6(fds, count, timeout) : 0; });
+    EXPECT_CALL(iomock, close(IPV4_DESCRIPTOR)).WillOnce(Return(0));
+
+    StickyEngine engine(iomock);
+    auto& skt = engine.makeSocket<DualStackSocket>(A_NAME, ANY_PORT);
+    auto& dual = static_cast<DualStackSocket&>(skt);
+    dual.useAddresses(dualStack());
+    ASSERT_TRUE(skt.connect());
+
+    settle(engine, dual);
+
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connected);
+    EXPECT_EQ(skt.getDescriptor(), IPV6_DESCRIPTOR);
+    EXPECT_EQ(dual.racing(), 0);
+}
+
+TEST_F(DualStackSocketTest, parked_attempt_wins_without_waiting_for_the_next_delay)
+{
+    // IPv6 answers a little after IPv4 joined the race, and only to the probes
+    std::chrono::steady_clock::time_point raced {};
+    EXPECT_CALL(iomock, poll(_, _, _))
+        .WillRepeatedly([&raced](struct pollfd* fds, nfds_t count, int timeout)
+    {
+        const bool late = raced != std::chrono::steady_clock::time_point {} &&
+                          std::chrono::steady_clock::now() - raced >
+                              DualStackSocket::PROBE_INTERVAL * 3;
+        return (count == 1 && late) ? readyOnly(IPV6_DESCRIPTOR)(fds, count, timeout) : 0;
+    });
+    EXPECT_CALL(iomock, close(IPV4_DESCRIPTOR)).WillOnce(Return(0));
+
+    StickyEngine engine(iomock);
+    auto& skt = engine.makeSocket<DualStackSocket>(A_NAME, ANY_PORT);
+    auto& dual = static_cast<DualStackSocket&>(skt);
+    dual.useAddresses(dualStack());
+    ASSERT_TRUE(skt.connect());
+
+    const auto start = std::chrono::steady_clock::now();
+    while (dual.racing() == 0 &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+    {
+        engine.poll(1);
+    }
+    ASSERT_EQ(dual.racing(), 1);
+    raced = std::chrono::steady_clock::now();
+
+    settle(engine, dual);
+
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connected);
+    EXPECT_EQ(skt.getDescriptor(), IPV6_DESCRIPTOR);
+    EXPECT_LT(std::chrono::steady_clock::now() - raced, DualStackSocket::ATTEMPT_DELAY);
+}
+
+TEST_F(DualStackSocketTest, silent_parked_attempt_is_probed_less_and_less)
+{
+    // neither family answers, the loop polls two descriptors and a probe polls one
+    size_t probes = 0;
+    std::chrono::steady_clock::time_point lastProbe {};
+    EXPECT_CALL(iomock, poll(_, _, _))
+        .WillRepeatedly([&probes, &lastProbe](struct pollfd*, nfds_t count, int)
+    {
+        if (count == 1)
+        {
+            probes++;
+            lastProbe = std::chrono::steady_clock::now();
+        }
+        return 0;
+    });
+
+    StickyEngine engine(iomock);
+    auto& skt = engine.makeSocket<DualStackSocket>(A_NAME, ANY_PORT);
+    auto& dual = static_cast<DualStackSocket&>(skt);
+    dual.useAddresses(dualStack());
+    ASSERT_TRUE(skt.connect());
+
+    // the race starts after one delay, the window closes, one more delay goes by quietly
+    const auto until = std::chrono::steady_clock::now() + DualStackSocket::PROBE_WINDOW +
+                       DualStackSocket::ATTEMPT_DELAY * 2;
+    while (std::chrono::steady_clock::now() < until)
+    {
+        engine.poll(10);
+    }
+
+    // a fixed interval would have probed a hundred times by now
+    EXPECT_EQ(dual.racing(), 1);
+    EXPECT_GT(probes, 0);
+    EXPECT_LE(probes, 10);
+    EXPECT_LT(lastProbe, until - DualStackSocket::ATTEMPT_DELAY);
+}
+
+TEST_F(DualStackSocketTest, failed_attempt_hands_over_to_parked_one)
+{
+    // IPv4 is refused once it joined the race, IPv6 comes through after all
+    bool raced = false;
+    EXPECT_CALL(iomock, poll(_, _, _))
+        .WillRepeatedly([&raced](struct pollfd* fds, nfds_t, int)
+    {
+        raced = raced || fds[0].fd == IPV4_DESCRIPTOR;
+        if (!raced)
+        {
+            return 0;
+        }
+        fds[0].revents = (fds[0].fd == IPV4_DESCRIPTOR) ? POLLERR : POLLOUT;
+        return 1;
+    });
+    EXPECT_CALL(iomock, close(IPV4_DESCRIPTOR)).WillOnce(Return(0));
+
+    StickyEngine engine(iomock);
+    auto& skt = engine.makeSocket<DualStackSocket>(A_NAME, ANY_PORT);
+    auto& dual = static_cast<DualStackSocket&>(skt);
+    dual.useAddresses(dualStack());
+    ASSERT_TRUE(skt.connect());
+
+    settle(engine, dual);
+
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connected);
+    EXPECT_EQ(skt.getDescriptor(), IPV6_DESCRIPTOR);
+    EXPECT_EQ(dual.getAttempts(), 0);
+}
+
+TEST_F(DualStackSocketTest, disconnect_closes_every_attempt)
+{
+    EXPECT_CALL(iomock, poll(_, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(iomock, close(IPV6_DESCRIPTOR)).WillOnce(Return(0));
+    EXPECT_CALL(iomock, close(IPV4_DESCRIPTOR)).WillOnce(Return(0));
+
+    StickyEngine engine(iomock);
+    auto& skt = engine.makeSocket<DualStackSocket>(A_NAME, ANY_PORT);
+    auto& dual = static_cast<DualStackSocket&>(skt);
+    dual.useAddresses(dualStack());
+    ASSERT_TRUE(skt.connect());
+
+    const auto start = std::chrono::steady_clock::now();
+    while (dual.racing() == 0 &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(2))
+    {
+        engine.poll(10);
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    ASSERT_EQ(dual.racing(), 1);
+
+    skt.disconnect();
+    EXPECT_EQ(dual.racing(), 0);
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Disconnected);
+}
@@ -0,0 +1,99 @@
+#include "hot_state.h"
+#include "iomock.h"
+#include "sticky_engine.h"
+#include "sticky_socket.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include <sys/poll.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr uint16_t ANY_PORT = 9999;
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_ADDRESS = 1;
+constexpr int GOOD_SOCK_OPT = 0;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+
+using State = EasySocketIntf::ConnectionState;
+
+class HotStateTest : public ::testing::Test
+{
+  protected:
+    IoMockAdapter iomock;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, eventfd(_, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+        EXPECT_CALL(iomock, connect(_, _, _))
+            .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+        EXPECT_CALL(iomock, getsockopt(_, _, _, _, _))
+            .WillRepeatedly(Return(GOOD_SOCK_OPT));
+    }
+};
+
+TEST_F(HotStateTest, scans_find_sessions_due_for_reconnect)
+{
+    EXPECT_CALL(iomock, socket(_, _, _)).WillRepeatedly(Return(-1));
+    StickySocket idle(iomock, "127.0.0.1", ANY_PORT);
+    StickySocket failing(iomock, "127.0.0.2", ANY_PORT);
+    failing.connect();
+
+    HotState hot;
+    hot.append(idle);
+    hot.append(failing);
+
+    std::vector<size_t> rows;
+    const auto now = HotState::Clock::now();
+    EXPECT_EQ(hot.dueForReconnect(now, rows), 1);
+    EXPECT_EQ(rows, (std::vector<size_t> { 0 }));
+    EXPECT_EQ(hot.dueForReconnect(now + std::chrono::hours(1), rows), 2);
+    EXPECT_EQ(hot.attemptsAt(1), 1);
+    EXPECT_EQ(hot.count(State::Disconnected), 2);
+
+    hot.removeAt(0);
+    EXPECT_EQ(hot.size(), 1);
+    EXPECT_EQ(hot.deadlineAt(0), failing.getNextAttempt());
+}
+
+TEST_F(HotStateTest, engine_rows_follow_their_sessions)
+{
+    EXPECT_CALL(iomock, socket(_, _, _)).WillRepeatedly(Return(GOOD_DESCRIPTOR));
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, _))
+        .WillRepeatedly(SetErrnoAndReturn(EAGAIN, -1));
+    StickyEngine engine(iomock);
+    const auto first = engine.makeSession<StickySocket>("127.0.0.1", ANY_PORT);
+    const auto second = engine.makeSession<StickySocket>("127.0.0.2", ANY_PORT);
+    const auto& hot = engine.getHotState();
+
+    auto& skt = *engine.lookup(second);
+    skt.connect();
+    EXPECT_EQ(hot.stateAt(1), State::Connecting);
+    EXPECT_EQ(hot.descriptorAt(1), GOOD_DESCRIPTOR);
+    EXPECT_EQ(hot.interestAt(1), POLLOUT);
+
+    skt.eval(pollfd { .fd = GOOD_DESCRIPTOR, .events = 0, .revents = POLLOUT });
+    EXPECT_EQ(hot.stateAt(1), State::Connected);
+    EXPECT_FALSE(hot.hasPendingOutput(1));
+
+    const std::vector<uint8_t> bytes { 1, 2, 3 };
+    skt.send(bytes);
+    std::vector<size_t> rows;
+    EXPECT_EQ(hot.withPendingOutput(rows), 1);
+    EXPECT_TRUE(hot.interestAt(1) & POLLOUT);
+
+    engine.remove(first);
+    EXPECT_EQ(hot.size(), 1);
+    EXPECT_EQ(hot.stateAt(0), State::Connected);
+    EXPECT_TRUE(hot.hasPendingOutput(0));
+}
@@ -0,0 +1,112 @@
+#include "io_access.h"
+#include "ion_service.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <stop_token>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+namespace
+{
+
+template <typename Predicate> auto eventually(Predicate done) -> bool
+{
+    const auto start = std::chrono::steady_clock::now();
+    while (!done())
+    {
+        if (std::chrono::steady_clock::now() - start > 2s)
+        {
+            return false;
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+TEST(IonService, tickless_worker_sleeps_until_woken)
+{
+    IoAdapter io;
+    IonService service(io, IonServiceConfig { .tickless = true });
+    std::stop_source super;
+
+    service.start(super.get_token());
+    std::this_thread::sleep_for(200ms);
+    EXPECT_EQ(service.wakeupsPerMinute(), 0);
+
+    service.resetHealth();
+    EXPECT_TRUE(eventually([&service]() { return service.isHealthy(); }));
+    EXPECT_GE(service.wakeupsPerMinute(), 1);
+    EXPECT_LE(service.wakeupsPerMinute(), 2);
+
+    service.stop();
+    EXPECT_FALSE(service.isRunning());
+}
+
+TEST(IonService, ticking_worker_wakes_on_its_event_window)
+{
+    IoAdapter io;
+    IonService service(io, IonServiceConfig { .tickless = false });
+    std::stop_source super;
+
+    service.start(super.get_token());
+    std::this_thread::sleep_for(200ms);
+    service.stop();
+
+    EXPECT_GE(service.wakeupsPerMinute(), 2);
+}
+
+TEST(IonService, displays_land_on_their_shard_before_and_after_start)
+{
+    IoAdapter io;
+    IonService service(io, IonServiceConfig { .shards = 4, .tickless = true });
+    std::stop_source super;
+    std::atomic<int> found = 0;
+
+    for (uint16_t port = 5101; port <= 5108; port++)
+    {
+        service.addDisplay("127.0.0.1", port);
+    }
+    service.start(super.get_token());
+    service.addDisplay("127.0.0.1", 5109);
+
+    // commands are routed by shardOf(), so each one only finds a well placed session
+    for (uint16_t port = 5101; port <= 5109; port++)
+    {
+        EXPECT_LT(service.shardOf("127.0.0.1", port), service.shardCount());
+        service.submit(
+            "127.0.0.1", port,
+            [&found, port](IonSession& session) { found += (session.getPort() == port); }
+        );
+    }
+    EXPECT_TRUE(eventually([&found]() { return found == 9; }));
+    EXPECT_EQ(service.getMetrics().sessions, 9);
+
+    service.stop();
+}
+
+TEST(IonService, restart_does_not_duplicate_sessions)
+{
+    IoAdapter io;
+    IonService service(io, IonServiceConfig { .shards = 2, .tickless = true });
+    std::stop_source super;
+
+    service.addDisplay("127.0.0.1", 5201);
+    service.addDisplay("127.0.0.1", 5202);
+    service.start(super.get_token());
+    EXPECT_TRUE(eventually([&service]() { return service.getMetrics().sessions == 2; }));
+
+    service.stop();
+    service.start(super.get_token());
+    service.resetHealth();
+    EXPECT_TRUE(eventually([&service]() { return service.isHealthy(); }));
+    EXPECT_EQ(service.getMetrics().sessions, 2);
+
+    service.stop();
+}
@@ -0,0 +1,235 @@
+#include "ion_session.h"
+#include "iomock.h"
+#include "sicp_decoder.h"
+#include "sticky_engine.h"
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_ADDRESS = 1;
+constexpr int GOOD_SOCK_OPT = 0;
+constexpr uint8_t CONTROL = 0x01;
+constexpr uint8_t GROUP = 0x00;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+
+using Status = IonSession::ReplyStatus;
+using Bytes = std::vector<uint8_t>;
+
+namespace
+{
+
+auto reply(std::vector<uint8_t> data) -> Bytes
+{
+    std::array<uint8_t, sicp::MAX_FRAME> frame {};
+    const size_t length = sicp::encode(frame, CONTROL, GROUP, data);
+    return { frame.begin(), frame.begin() + static_cast<ptrdiff_t>(length) };
+}
+
+auto writtenBytes(int, const struct iovec* iov, int count) -> ssize_t
+{
+    ssize_t total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        total += static_cast<ssize_t>(iov[i].iov_len);
+    }
+    return total;
+}
+
+} // anonymous namespace
+
+class IonSessionTest : public ::testing::Test
+{
+  protected:
+    IoMockAdapter iomock;
+    std::vector<std::pair<size_t, Status>> replies;
+    size_t asked = 0;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, eventfd(_, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+        EXPECT_CALL(iomock, socket(_, _, _)).WillRepeatedly(Return(GOOD_DESCRIPTOR));
+        EXPECT_CALL(iomock, connect(GOOD_DESCRIPTOR, _, _))
+            .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+        EXPECT_CALL(iomock, getsockopt(GOOD_DESCRIPTOR, _, _, _, _))
+            .WillRepeatedly(Return(GOOD_SOCK_OPT));
+        EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, _)).WillRepeatedly(writtenBytes);
+    }
+
+    void bringOnline(IonSession& session)
+    {
+        session.connect();
+        struct pollfd canSendResponse { .revents = POLLOUT };
+        session.eval(canSendResponse);
+        ASSERT_TRUE(session.isOnline());
+    }
+
+    auto ask(IonSession& session) -> IonSession::RequestId
+    {
+        const std::array<uint8_t, 1> data { 0x19 };
+        return session.request(
+            CONTROL, GROUP, data, [this, nth = asked++](Status status, auto)
+        { replies.emplace_back(nth, status); }
+        );
+    }
+};
+
+TEST_F(IonSessionTest, request_needs_a_connection)
+{
+    IonSession session(iomock, "127.0.0.1", 5000);
+
+    EXPECT_EQ(ask(session), IonSession::NO_REQUEST);
+}
+
+TEST_F(IonSessionTest, window_limits_requests_on_the_wire)
+{
+    IonSession session(iomock, "127.0.0.1", 5000);
+    bringOnline(session);
+    session.setWindow(2);
+
+    ask(session);
+    ask(session);
+    ask(session);
+
+    EXPECT_EQ(session.inFlight(), 2);
+    EXPECT_EQ(session.queued(), 1);
+}
+
+TEST_F(IonSessionTest, replies_are_matched_in_order_and_refill_the_window)
+{
+    IonSession session(iomock, "127.0.0.1", 5000);
+    bringOnline(session);
+    session.setWindow(2);
+
+    std::vector<IonSession::RequestId> ids;
+    std::vector<std::pair<IonSession::RequestId, Status>> seen;
+    const std::array<uint8_t, 1> data { 0x19 };
+    for (int i = 0; i < 3; i++)
+    {
+        ids.push_back(session.request(
+            CONTROL, GROUP, data,
+            [&seen, &ids, i](Status status, auto) { seen.emplace_back(ids.at(i), status); }
+        ));
+    }
+
+    const auto stream = [&]()
+    {
+        Bytes all = reply({ 0x06 });
+        for (const auto& next : { reply({ 0x15 }), reply({ 0x42, 0x43 }) })
+        {
+            all.insert(all.end(), next.begin(), next.end());
+        }
+        return all;
+    }();
+    session.didReceived(std::span(stream).first(7));
+    EXPECT_EQ(session.inFlight(), 2);
+    EXPECT_EQ(session.queued(), 0);
+    session.didReceived(std::span(stream).subspan(7));
+
+    const std::vector<std::pair<IonSession::RequestId, Status>> expected {
+        { ids[0], Status::Ack },
+        { ids[1], Status::Nack },
+        { ids[2], Status::Data },
+    };
+    EXPECT_EQ(seen, expected);
+    EXPECT_EQ(session.inFlight(), 0);
+}
+
+TEST_F(IonSessionTest, unsolicited_frames_reach_the_session)
+{
+    class RecordingSession : public IonSession
+    {
+      public:
+        using IonSession::IonSession;
+        size_t notices = 0;
+
+        void didReceiveFrame(std::span<const uint8_t>) override { notices++; }
+    };
+
+    RecordingSession session(iomock, "127.0.0.1", 5000);
+    bringOnline(session);
+
+    session.didReceived(reply({ 0x06 }));
+
+    EXPECT_EQ(session.notices, 1);
+}
+
+TEST_F(IonSessionTest, frames_for_another_group_do_not_answer_a_request)
+{
+    class RecordingSession : public IonSession
+    {
+      public:
+        using IonSession::IonSession;
+        size_t notices = 0;
+
+        void didReceiveFrame(std::span<const uint8_t>) override { notices++; }
+    };
+
+    RecordingSession session(iomock, "127.0.0.1", 5000);
+    bringOnline(session);
+    ask(session);
+
+    std::array<uint8_t, sicp::MAX_FRAME> frame {};
+    const std::array<uint8_t, 1> ack { 0x06 };
+    const size_t length = sicp::encode(frame, CONTROL, GROUP + 1, ack);
+    session.didReceived(std::span(frame).first(length));
+
+    EXPECT_EQ(session.notices, 1);
+    EXPECT_EQ(session.inFlight(), 1);
+    EXPECT_TRUE(replies.empty());
+}
+
+TEST_F(IonSessionTest, removed_session_drops_what_it_still_owes)
+{
+    {
+        IonSession session(iomock, "127.0.0.1", 5000);
+        bringOnline(session);
+        session.setWindow(1);
+        ask(session);
+        ask(session);
+    }
+
+    const std::vector<std::pair<size_t, Status>> expected {
+        { 0, Status::Dropped },
+        { 1, Status::Dropped },
+    };
+    EXPECT_EQ(replies, expected);
+}
+
+TEST_F(IonSessionTest, straggler_times_out_and_resets_the_connection)
+{
+    EXPECT_CALL(iomock, poll(_, _, _)).WillRepeatedly(Return(0));
+    StickyEngine engine(iomock);
+    auto& session = dynamic_cast<IonSession&>(
+        engine.makeSocket<IonSession>("127.0.0.1", 5000)
+    );
+    bringOnline(session);
+    session.setWindow(1);
+    session.setRequestTimeout(std::chrono::milliseconds(5));
+
+    ask(session);
+    ask(session);
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    engine.poll(0);
+
+    const std::vector<std::pair<size_t, Status>> expected {
+        { 0, Status::Timeout },
+        { 1, Status::Dropped },
+    };
+    EXPECT_EQ(replies, expected);
+    EXPECT_FALSE(session.isOnline());
+}
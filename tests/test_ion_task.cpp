@@ -0,0 +1,201 @@
+#include "frame_pool.h"
+#include "ion_session.h"
+#include "ion_task.h"
+#include "iomock.h"
+#include "sicp_decoder.h"
+#include "sticky_engine.h"
+
+#include <array>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <thread>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_ADDRESS = 1;
+constexpr int GOOD_SOCK_OPT = 0;
+constexpr uint8_t CONTROL = 0x01;
+constexpr uint8_t GROUP = 0x00;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+
+using Status = IonSession::ReplyStatus;
+using Bytes = std::vector<uint8_t>;
+
+namespace
+{
+
+auto reply(std::vector<uint8_t> data) -> Bytes
+{
+    std::array<uint8_t, sicp::MAX_FRAME> frame {};
+    const size_t length = sicp::encode(frame, CONTROL, GROUP, data);
+    return { frame.begin(), frame.begin() + static_cast<ptrdiff_t>(length) };
+}
+
+auto writtenBytes(int, const struct iovec* iov, int count) -> ssize_t
+{
+    ssize_t total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        total += static_cast<ssize_t>(iov[i].iov_len);
+    }
+    return total;
+}
+
+auto askOnce(IonSession& session, std::optional<IonSession::Reply>& answer) -> IonTask
+{
+    const std::array<uint8_t, 1> data { 0x19 };
+    answer = co_await session.request(CONTROL, GROUP, data);
+}
+
+auto waitThenAsk(IonSession& session, std::optional<IonSession::Reply>& answer)
+    -> IonTask
+{
+    co_await session.connected();
+    const std::array<uint8_t, 1> data { 0x19 };
+    answer = co_await session.request(CONTROL, GROUP, data);
+}
+
+auto nap(ReactorIntf& reactor, bool& woke) -> IonTask
+{
+    co_await sleepFor(reactor, std::chrono::milliseconds(5));
+    woke = true;
+}
+
+auto nothing() -> IonTask { co_return; }
+
+} // anonymous namespace
+
+class IonTaskTest : public ::testing::Test
+{
+  protected:
+    IoMockAdapter iomock;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, eventfd(_, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+        EXPECT_CALL(iomock, socket(_, _, _)).WillRepeatedly(Return(GOOD_DESCRIPTOR));
+        EXPECT_CALL(iomock, connect(GOOD_DESCRIPTOR, _, _))
+            .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+        EXPECT_CALL(iomock, getsockopt(GOOD_DESCRIPTOR, _, _, _, _))
+            .WillRepeatedly(Return(GOOD_SOCK_OPT));
+        EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, _)).WillRepeatedly(writtenBytes);
+    }
+
+    static void bringOnline(IonSession& session)
+    {
+        session.connect();
+        struct pollfd canSendResponse { .revents = POLLOUT };
+        session.eval(canSendResponse);
+        ASSERT_TRUE(session.isOnline());
+    }
+};
+
+TEST_F(IonTaskTest, workflow_resumes_once_online_and_again_on_reply)
+{
+    IonSession session(iomock, "127.0.0.1", 5000);
+    std::optional<IonSession::Reply> answer;
+
+    waitThenAsk(session, answer);
+    EXPECT_EQ(session.inFlight(), 0);
+
+    bringOnline(session);
+    EXPECT_EQ(session.inFlight(), 1);
+    EXPECT_FALSE(answer.has_value());
+
+    session.didReceived(reply({ 0x42, 0x43 }));
+    ASSERT_TRUE(answer.has_value());
+    EXPECT_EQ(answer->status, Status::Data);
+    EXPECT_EQ(answer->frame, reply({ 0x42, 0x43 }));
+}
+
+TEST_F(IonTaskTest, refused_request_does_not_suspend)
+{
+    IonSession session(iomock, "127.0.0.1", 5000);
+    std::optional<IonSession::Reply> answer;
+
+    askOnce(session, answer);
+
+    ASSERT_TRUE(answer.has_value());
+    EXPECT_EQ(answer->status, Status::Dropped);
+    EXPECT_TRUE(answer->frame.empty());
+}
+
+TEST_F(IonTaskTest, lost_connection_drops_awaited_request)
+{
+    IonSession session(iomock, "127.0.0.1", 5000);
+    bringOnline(session);
+    std::optional<IonSession::Reply> answer;
+
+    askOnce(session, answer);
+    session.disconnect();
+
+    ASSERT_TRUE(answer.has_value());
+    EXPECT_EQ(answer->status, Status::Dropped);
+}
+
+TEST_F(IonTaskTest, sleep_resumes_from_the_timer_wheel)
+{
+    EXPECT_CALL(iomock, poll(_, _, _)).WillRepeatedly(Return(0));
+    StickyEngine engine(iomock);
+    bool woke = false;
+
+    nap(engine, woke);
+    engine.poll(0);
+    EXPECT_FALSE(woke);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    engine.poll(0);
+    EXPECT_TRUE(woke);
+}
+
+TEST_F(IonTaskTest, finished_frames_are_reused)
+{
+    auto& pool = FramePool::local();
+
+    nothing();
+    const auto hits = pool.getHits();
+    nothing();
+
+    EXPECT_EQ(pool.getHits(), hits + 1);
+}
+
+TEST_F(IonTaskTest, closing_session_releases_waiting_frames)
+{
+    auto& pool = FramePool::local();
+    std::optional<IonSession::Reply> answer;
+    size_t cached = 0;
+    {
+        IonSession session(iomock, "127.0.0.1", 5000);
+        waitThenAsk(session, answer);
+        cached = pool.cached();
+    }
+
+    EXPECT_EQ(pool.cached(), cached + 1);
+    EXPECT_FALSE(answer.has_value());
+}
+
+TEST(FramePool, rounds_up_to_size_classes)
+{
+    FramePool pool;
+
+    void* small = pool.allocate(40);
+    pool.release(small, 40);
+    EXPECT_EQ(pool.allocate(FramePool::MIN_BLOCK), small);
+
+    void* huge = pool.allocate(1 << 16);
+    pool.release(huge, 1 << 16);
+    EXPECT_EQ(pool.cached(), 0);
+    EXPECT_EQ(pool.getMisses(), 2);
+    pool.release(small, FramePool::MIN_BLOCK);
+}
@@ -1,3 +1,4 @@
+#include "buffer_pool.h"
 #include "easy_socket.h"
 #include "iomock.h"
 #include "ipv4_socket.h"
@@ -9,6 +10,8 @@
 #include <asm-generic/socket.h>
 #include <string_view>
 #include <sys/poll.h>
+#include <sys/uio.h>
+#include <vector>
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
@@ -40,8 +43,44 @@ class IPv4SocketTest : public ::testing::Test
     void SetUp() override { EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0)); }
 
     void TearDown() override {}
+
+    void connectSocket(IPv4Socket& skt)
+    {
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillOnce(Return(GOOD_ADDRESS));
+        EXPECT_CALL(iomock, socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0))
+            .WillOnce(Return(GOOD_DESCRIPTOR));
+        EXPECT_CALL(iomock, connect(GOOD_DESCRIPTOR, _, sizeof(sockaddr_in)))
+            .WillOnce(SetErrnoAndReturn(EINPROGRESS, -1));
+        EXPECT_CALL(iomock, getsockopt(GOOD_DESCRIPTOR, SOL_SOCKET, SO_ERROR, _, _))
+            .WillOnce(Return(GOOD_SOCK_OPT));
+
+        skt.connect();
+        struct pollfd canSendResponse { .revents = POLLOUT };
+        skt.eval(canSendResponse);
+        ASSERT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connected);
+    }
 };
 
+namespace
+{
+
+auto bytesOf(std::string_view text) -> std::span<const uint8_t>
+{
+    return { reinterpret_cast<const uint8_t*>(text.data()), text.size() };
+}
+
+auto iovLengths(const struct iovec* iov, int count) -> std::vector<size_t>
+{
+    std::vector<size_t> lengths;
+    for (int i = 0; i < count; i++)
+    {
+        lengths.push_back(iov[i].iov_len);
+    }
+    return lengths;
+}
+
+} // anonymous namespace
+
 TEST_F(IPv4SocketTest, new_socket_has_invalid_descriptor)
 {
     IPv4Socket skt(iomock, A_HOST, ANY_PORT);
@@ -219,6 +258,31 @@ TEST_F(IPv4SocketTest, eval_connecting_without_access_moves_to_disconnected)
     EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Disconnected);
 }
 
+TEST_F(IPv4SocketTest, eval_refused_connect_moves_to_disconnected)
+{
+    EXPECT_CALL(iomock, inet_pton(AF_INET, ::testing::StrEq(A_HOST.c_str()), _))
+        .WillOnce(Return(GOOD_ADDRESS));
+    EXPECT_CALL(iomock, socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0))
+        .WillOnce(Return(GOOD_DESCRIPTOR));
+    EXPECT_CALL(iomock, connect(GOOD_DESCRIPTOR, _, sizeof(sockaddr_in)))
+        .WillOnce(SetErrnoAndReturn(EINPROGRESS, -1));
+    // the call itself succeeds, the pending error is what it reports
+    EXPECT_CALL(iomock, getsockopt(GOOD_DESCRIPTOR, SOL_SOCKET, SO_ERROR, _, _))
+        .WillOnce(WithArg<3>([](void* value)
+    {
+        *static_cast<int*>(value) = ECONNREFUSED;
+        return GOOD_SOCK_OPT;
+    }));
+
+    IPv4Socket skt(iomock, A_HOST, ANY_PORT);
+    skt.connect();
+    struct pollfd canSendResponse { .revents = POLLOUT };
+
+    skt.eval(canSendResponse);
+
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Disconnected);
+}
+
 TEST_F(IPv4SocketTest, eval_on_disconnected_socket_is_tolerated)
 {
     IPv4Socket skt(iomock, A_HOST, ANY_PORT);
@@ -341,12 +405,13 @@ TEST_F(IPv4SocketTest, send_while_connected_does_send)
         .WillOnce(Return(GOOD_SOCK_OPT));
 
     // Capture the sent buffer and verify its content
-    EXPECT_CALL(iomock, send(GOOD_DESCRIPTOR, _, TEST_DATA_SIZE, 0))
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, 1))
         .WillOnce(DoAll(
             WithArg<1>(
-                [&](const void* buffer)
+                [&](const struct iovec* iov)
     {
-        const char* sentData = static_cast<const char*>(buffer);
+        ASSERT_EQ(iov[0].iov_len, TEST_DATA_SIZE);
+        const char* sentData = static_cast<const char*>(iov[0].iov_base);
         ASSERT_EQ(std::string_view(sentData), std::string_view(TEST_DATA));
     }
             ),
@@ -365,3 +430,120 @@ TEST_F(IPv4SocketTest, send_while_connected_does_send)
     );
     skt.send(textBuf);
 }
+
+TEST_F(IPv4SocketTest, connected_socket_wants_pollout_only_while_bytes_pending)
+{
+    IPv4Socket skt(iomock, A_HOST, ANY_PORT);
+    connectSocket(skt);
+    EXPECT_EQ(skt.interest(), POLLIN | POLLPRI);
+
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, 1))
+        .WillOnce(Return(2))
+        .WillOnce(SetErrnoAndReturn(EAGAIN, -1));
+    EXPECT_EQ(skt.send(bytesOf("Hello!")), 6);
+
+    EXPECT_EQ(skt.pendingBytes(), 4);
+    EXPECT_EQ(skt.interest(), POLLIN | POLLPRI | POLLOUT);
+
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, 1))
+        .WillOnce(
+            [](int, const struct iovec* iov, int)
+    {
+        const auto* sent = static_cast<const char*>(iov[0].iov_base);
+        EXPECT_EQ(std::string_view(sent, iov[0].iov_len), "llo!");
+        return 4;
+    }
+        );
+    struct pollfd canSendResponse { .revents = POLLOUT };
+    skt.eval(canSendResponse);
+
+    EXPECT_EQ(skt.pendingBytes(), 0);
+    EXPECT_EQ(skt.interest(), POLLIN | POLLPRI);
+}
+
+TEST_F(IPv4SocketTest, queued_frames_leave_in_one_writev)
+{
+    IPv4Socket skt(iomock, A_HOST, ANY_PORT);
+    connectSocket(skt);
+
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, 1))
+        .WillOnce(SetErrnoAndReturn(EAGAIN, -1));
+    skt.send(bytesOf("one"));
+    skt.send(bytesOf("three"));
+    skt.send(bytesOf("five5"));
+    EXPECT_EQ(skt.pendingBytes(), 13);
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connected);
+
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, 3))
+        .WillOnce(
+            [](int, const struct iovec* iov, int count)
+    {
+        EXPECT_EQ(iovLengths(iov, count), (std::vector<size_t> { 3, 5, 5 }));
+        return 13;
+    }
+        );
+    struct pollfd canSendResponse { .revents = POLLOUT };
+    skt.eval(canSendResponse);
+
+    EXPECT_EQ(skt.pendingBytes(), 0);
+}
+
+TEST_F(IPv4SocketTest, send_beyond_queue_limit_is_refused)
+{
+    IPv4Socket skt(iomock, A_HOST, ANY_PORT);
+    connectSocket(skt);
+
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, _))
+        .WillRepeatedly(SetErrnoAndReturn(EAGAIN, -1));
+    const std::vector<uint8_t> chunk(IPv4Socket::TX_QUEUE_LIMIT - 1, 0x55);
+    EXPECT_EQ(skt.send(chunk), static_cast<int>(chunk.size()));
+
+    EXPECT_EQ(skt.send(bytesOf("no room")), -1);
+    EXPECT_EQ(skt.pendingBytes(), chunk.size());
+}
+
+TEST_F(IPv4SocketTest, send_error_disconnects_and_drops_queue)
+{
+    IPv4Socket skt(iomock, A_HOST, ANY_PORT);
+    connectSocket(skt);
+
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, 1))
+        .WillOnce(SetErrnoAndReturn(EPIPE, -1));
+    skt.send(bytesOf("Hello"));
+
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Disconnected);
+    EXPECT_EQ(skt.pendingBytes(), 0);
+}
+
+TEST_F(IPv4SocketTest, send_while_disconnected_is_refused)
+{
+    EXPECT_CALL(iomock, writev(_, _, _)).Times(0);
+    IPv4Socket skt(iomock, A_HOST, ANY_PORT);
+
+    EXPECT_EQ(skt.send(bytesOf("Hello")), -1);
+}
+
+TEST_F(IPv4SocketTest, receive_buffer_is_leased_only_for_the_read)
+{
+    constexpr size_t RECEIVE_SIZE = 512;
+    auto& pool = BufferPool::local();
+    const size_t before = pool.outstanding();
+
+    IPv4Socket skt(iomock, A_HOST, ANY_PORT);
+    skt.setReceiveSize(RECEIVE_SIZE);
+    connectSocket(skt);
+    EXPECT_CALL(iomock, recv(GOOD_DESCRIPTOR, _, RECEIVE_SIZE, 0))
+        .WillOnce(
+            [&pool, before](int, void*, size_t, int)
+    {
+        EXPECT_EQ(pool.outstanding(), before + 1);
+        return 3;
+    }
+        );
+
+    struct pollfd canReadResponse { .revents = POLLIN };
+    skt.eval(canReadResponse);
+
+    EXPECT_EQ(pool.outstanding(), before);
+    EXPECT_GE(pool.idleBytes(), RECEIVE_SIZE);
+}
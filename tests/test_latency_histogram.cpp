@@ -0,0 +1,179 @@
+#include "iomock.h"
+#include "ion_session.h"
+#include "latency_histogram.h"
+#include "sicp_decoder.h"
+#include "sticky_engine.h"
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <sys/poll.h>
+#include <sys/uio.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_ADDRESS = 1;
+constexpr int GOOD_SOCK_OPT = 0;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+
+using namespace std::chrono_literals;
+
+namespace {
+
+auto writtenBytes(int, const struct iovec* iov, int count) -> ssize_t
+{
+    ssize_t total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        total += static_cast<ssize_t>(iov[i].iov_len);
+    }
+    return total;
+}
+
+} // anonymous namespace
+
+TEST(LatencyHistogram, buckets_stay_within_one_percent)
+{
+    size_t previous = 0;
+    for (uint64_t micros = 1; micros < LatencyHistogram::HIGHEST; micros = micros * 3 + 1)
+    {
+        const size_t bucket = LatencyHistogram::bucketOf(micros);
+        const uint64_t highest = LatencyHistogram::highestOf(bucket);
+        EXPECT_LT(bucket, LatencyHistogram::BUCKETS);
+        EXPECT_GE(bucket, previous);
+        EXPECT_GE(highest, micros);
+        EXPECT_LE(highest - micros, micros / 64);
+        previous = bucket;
+    }
+    EXPECT_EQ(
+        LatencyHistogram::bucketOf(LatencyHistogram::HIGHEST * 2),
+        LatencyHistogram::BUCKETS - 1
+    );
+}
+
+TEST(LatencyHistogram, percentiles_follow_the_samples)
+{
+    LatencyHistogram histogram;
+    for (int i = 1; i <= 1000; i++)
+    {
+        histogram.record(std::chrono::microseconds(i * 10));
+    }
+
+    const auto snapshot = histogram.snapshot();
+    EXPECT_EQ(snapshot.count(), 1000);
+    // reported values are the top of their bucket, never more than 1/64 above
+    EXPECT_NEAR(snapshot.percentile(50).count(), 5000 + 39, 40);
+    EXPECT_NEAR(snapshot.percentile(99).count(), 9900 + 77, 78);
+    EXPECT_NEAR(snapshot.percentile(99.9).count(), 9990 + 78, 79);
+    EXPECT_NEAR(snapshot.max().count(), 10000 + 78, 79);
+    EXPECT_EQ(LatencySnapshot {}.percentile(50), 0us);
+}
+
+TEST(LatencyHistogram, merged_snapshots_match_one_histogram)
+{
+    LatencyHistogram left;
+    LatencyHistogram right;
+    LatencyHistogram both;
+    for (int i = 0; i < 500; i++)
+    {
+        left.record(std::chrono::microseconds(i));
+        right.record(std::chrono::milliseconds(i));
+        both.record(std::chrono::microseconds(i));
+        both.record(std::chrono::milliseconds(i));
+    }
+
+    auto merged = left.snapshot();
+    merged += right.snapshot();
+    const auto expected = both.snapshot();
+    ASSERT_EQ(merged.buckets.size(), expected.buckets.size());
+    for (size_t i = 0; i < merged.buckets.size(); i++)
+    {
+        EXPECT_EQ(merged.buckets[i].index, expected.buckets[i].index);
+        EXPECT_EQ(merged.buckets[i].count, expected.buckets[i].count);
+    }
+}
+
+TEST(LatencyHistogram, encoded_snapshot_decodes_back)
+{
+    LatencyHistogram histogram;
+    for (int i = 0; i < 200; i++)
+    {
+        histogram.record(std::chrono::microseconds(i * i * 37));
+    }
+    const auto snapshot = histogram.snapshot();
+
+    const auto bytes = snapshot.encode();
+    EXPECT_LT(bytes.size(), snapshot.buckets.size() * 3);
+
+    LatencySnapshot decoded;
+    ASSERT_TRUE(LatencySnapshot::decode(bytes, decoded));
+    EXPECT_EQ(decoded.count(), snapshot.count());
+    EXPECT_EQ(decoded.percentile(99), snapshot.percentile(99));
+
+    const std::vector<uint8_t> truncated(bytes.begin(), bytes.end() - 1);
+    EXPECT_FALSE(LatencySnapshot::decode(truncated, decoded));
+    EXPECT_EQ(decoded.count(), snapshot.count());
+}
+
+class LatencyTest : public ::testing::Test
+{
+  protected:
+    IoMockAdapter iomock;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, eventfd(_, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+        EXPECT_CALL(iomock, socket(_, _, _)).WillRepeatedly(Return(GOOD_DESCRIPTOR));
+        EXPECT_CALL(iomock, connect(GOOD_DESCRIPTOR, _, _))
+            .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+        EXPECT_CALL(iomock, getsockopt(GOOD_DESCRIPTOR, _, _, _, _))
+            .WillRepeatedly(Return(GOOD_SOCK_OPT));
+        EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, _)).WillRepeatedly(writtenBytes);
+    }
+};
+
+TEST_F(LatencyTest, engine_reports_connect_and_reply_times_per_group)
+{
+    StickyEngine engine(iomock);
+    auto& session = dynamic_cast<IonSession&>(
+        engine.makeSocket<IonSession>("127.0.0.1", 5000)
+    );
+    session.connect();
+    session.eval(pollfd { .fd = GOOD_DESCRIPTOR, .events = 0, .revents = POLLOUT });
+
+    const std::array<uint8_t, 1> data { 0x19 };
+    size_t replies = 0;
+    const auto onReply = [&replies](IonSession::ReplyStatus, std::span<const uint8_t>)
+    { replies++; };
+    session.request(0x01, 0x00, data, onReply);
+    session.request(0x01, 0x02, data, onReply);
+    session.request(0x01, 0x02, data, onReply);
+
+    std::array<uint8_t, sicp::MAX_FRAME> frame {};
+    for (const uint8_t group : { 0x00, 0x02, 0x02 })
+    {
+        const size_t length =
+            sicp::encode(frame, 0x01, group, std::array<uint8_t, 1> { 0x06 });
+        session.ingest(std::span(frame).first(length));
+    }
+    ASSERT_EQ(replies, 3);
+
+    const auto report = engine.getLatency();
+    EXPECT_EQ(report.connect.count(), 1);
+    EXPECT_EQ(report.replies.count(), 3);
+    ASSERT_EQ(report.groups.size(), 2);
+    EXPECT_EQ(report.groups.at(0x00).count(), 1);
+    EXPECT_EQ(report.groups.at(0x02).count(), 2);
+    EXPECT_LT(report.replies.percentile(99), 1s);
+}
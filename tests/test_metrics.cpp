@@ -0,0 +1,186 @@
+#include "iomock.h"
+#include "ion_session.h"
+#include "metrics.h"
+#include "sicp_decoder.h"
+#include "sticky_engine.h"
+
+#include <array>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include <sys/poll.h>
+#include <sys/uio.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_ADDRESS = 1;
+constexpr int GOOD_SOCK_OPT = 0;
+
+using ::testing::_;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+
+using Counter = TrafficCounters::Counter;
+using namespace std::chrono_literals;
+
+namespace {
+
+auto writtenBytes(int, const struct iovec* iov, int count) -> ssize_t
+{
+    ssize_t total = 0;
+    for (int i = 0; i < count; i++)
+    {
+        total += static_cast<ssize_t>(iov[i].iov_len);
+    }
+    return total;
+}
+
+} // anonymous namespace
+
+TEST(TrafficCounters, connected_time_counts_sessions_still_online)
+{
+    TrafficCounters counters;
+    const TrafficCounters::Clock::time_point start {};
+
+    counters.wentOnline(start);
+    counters.wentOnline(start + 10ms);
+    counters.wentOffline(start, start + 30ms);
+    counters.add(Counter::BytesIn, 5);
+    counters.add(Counter::BytesIn, 7);
+
+    const auto metrics = counters.snapshot(start + 50ms);
+    EXPECT_EQ(metrics.connected, 70ms);
+    EXPECT_EQ(metrics.bytesIn, 12);
+    EXPECT_EQ(metrics.bytesOut, 0);
+}
+
+TEST(TrafficCounters, connected_time_of_a_large_fleet_does_not_overflow)
+{
+    constexpr int SESSIONS = 100000;
+    TrafficCounters counters;
+    const auto start = TrafficCounters::Clock::now();
+
+    for (int i = 0; i < SESSIONS; i++)
+    {
+        counters.wentOnline(start + 48h);
+    }
+
+    const auto metrics = counters.snapshot(start + 96h);
+    EXPECT_EQ(metrics.connected, std::chrono::milliseconds(48h) * SESSIONS);
+}
+
+TEST(TrafficCounters, snapshots_from_another_thread_never_see_half_an_update)
+{
+    constexpr int ROUNDS = 20000;
+    TrafficCounters counters;
+    const TrafficCounters::Clock::time_point start {};
+    std::atomic<bool> done { false };
+
+    std::thread loop([&]()
+    {
+        for (int i = 0; i < ROUNDS; i++)
+        {
+            counters.wentOnline(start);
+            counters.wentOffline(start, start + 1ms);
+        }
+        done = true;
+    });
+
+    // with now at the start an online session adds nothing, torn reads would
+    auto last = 0ms;
+    while (!done)
+    {
+        const auto connected = counters.snapshot(start).connected;
+        EXPECT_GE(connected, last);
+        EXPECT_LE(connected, std::chrono::milliseconds(ROUNDS));
+        last = connected;
+        std::this_thread::yield();
+    }
+    loop.join();
+
+    EXPECT_EQ(counters.snapshot(start).connected, std::chrono::milliseconds(ROUNDS));
+}
+
+class MetricsTest : public ::testing::Test
+{
+  protected:
+    IoMockAdapter iomock;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, eventfd(_, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+        EXPECT_CALL(iomock, socket(_, _, _)).WillRepeatedly(Return(GOOD_DESCRIPTOR));
+        EXPECT_CALL(iomock, connect(GOOD_DESCRIPTOR, _, _))
+            .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+    }
+};
+
+TEST_F(MetricsTest, session_traffic_adds_up_in_its_engine)
+{
+    EXPECT_CALL(iomock, getsockopt(GOOD_DESCRIPTOR, _, _, _, _))
+        .WillRepeatedly(Return(GOOD_SOCK_OPT));
+    ssize_t written = 0;
+    const auto countBytes = [&written](int fd, const struct iovec* iov, int count)
+    {
+        const ssize_t total = writtenBytes(fd, iov, count);
+        written += total;
+        return total;
+    };
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, _))
+        .WillOnce(countBytes) // hello
+        .WillOnce(SetErrnoAndReturn(EAGAIN, -1))
+        .WillOnce(countBytes);
+
+    StickyEngine engine(iomock);
+    auto& session = dynamic_cast<IonSession&>(
+        engine.makeSocket<IonSession>("127.0.0.1", 5000)
+    );
+    session.connect();
+    session.eval(pollfd { .fd = GOOD_DESCRIPTOR, .events = 0, .revents = POLLOUT });
+
+    const std::array<uint8_t, 2> data { 0x19, 0x20 };
+    session.sendFrame(0x01, 0x00, data);
+    session.flush();
+    session.flush();
+
+    std::array<uint8_t, sicp::MAX_FRAME> frame {};
+    const size_t length = sicp::encode(frame, 0x01, 0x00, std::array<uint8_t, 1> { 0x06 });
+    session.ingest(std::span(frame).first(length));
+
+    const auto own = session.getMetrics();
+    EXPECT_EQ(own.bytesOut, static_cast<uint64_t>(written));
+    EXPECT_EQ(own.framesOut, 2);
+    EXPECT_EQ(own.sendStalls, 1);
+    EXPECT_EQ(own.bytesIn, length);
+    EXPECT_EQ(own.framesIn, 1);
+    EXPECT_EQ(own.connectFailures, 0);
+
+    const auto total = engine.getMetrics();
+    EXPECT_EQ(total.sessions, 1);
+    EXPECT_EQ(total.traffic.bytesOut, own.bytesOut);
+    EXPECT_EQ(total.traffic.framesIn, own.framesIn);
+}
+
+TEST_F(MetricsTest, refused_connection_counts_as_failure)
+{
+    EXPECT_CALL(iomock, getsockopt(GOOD_DESCRIPTOR, _, _, _, _))
+        .WillRepeatedly(Return(ECONNREFUSED));
+
+    StickyEngine engine(iomock);
+    auto& skt = engine.makeSocket<StickySocket>("127.0.0.1", 5000);
+    skt.connect();
+    skt.eval(pollfd { .fd = GOOD_DESCRIPTOR, .events = 0, .revents = POLLOUT });
+
+    EXPECT_EQ(skt.getMetrics().connectFailures, 1);
+    EXPECT_EQ(skt.getMetrics().connected, 0ms);
+    EXPECT_EQ(engine.getMetrics().traffic.connectFailures, 1);
+}
@@ -0,0 +1,72 @@
+#include "mpsc_queue.h"
+
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+TEST(MpscQueue, pops_in_push_order)
+{
+    MpscQueue<int> queue;
+    EXPECT_FALSE(queue.pop().has_value());
+
+    queue.push(1);
+    queue.push(2);
+    EXPECT_EQ(queue.pop(), 1);
+    queue.push(3);
+    EXPECT_EQ(queue.pop(), 2);
+    EXPECT_EQ(queue.pop(), 3);
+    EXPECT_FALSE(queue.pop().has_value());
+}
+
+TEST(MpscQueue, releases_pending_values_on_destruction)
+{
+    auto value = std::make_shared<int>(42);
+    {
+        MpscQueue<std::shared_ptr<int>> queue;
+        queue.push(value);
+        queue.push(value);
+        EXPECT_EQ(value.use_count(), 3);
+    }
+    EXPECT_EQ(value.use_count(), 1);
+}
+
+TEST(MpscQueue, keeps_per_producer_order_across_threads)
+{
+    constexpr size_t PRODUCERS = 4;
+    constexpr size_t PER_PRODUCER = 20000;
+    MpscQueue<size_t> queue;
+
+    std::vector<std::jthread> producers;
+    for (size_t p = 0; p < PRODUCERS; p++)
+    {
+        producers.emplace_back(
+            [&queue, p]()
+        {
+            for (size_t i = 0; i < PER_PRODUCER; i++)
+            {
+                queue.push((p * PER_PRODUCER) + i);
+            }
+        }
+        );
+    }
+
+    std::vector<size_t> next(PRODUCERS, 0);
+    size_t received = 0;
+    while (received < PRODUCERS * PER_PRODUCER)
+    {
+        auto value = queue.pop();
+        if (!value)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        const size_t producer = *value / PER_PRODUCER;
+        ASSERT_EQ(*value % PER_PRODUCER, next[producer]);
+        next[producer]++;
+        received++;
+    }
+    EXPECT_FALSE(queue.pop().has_value());
+}
@@ -0,0 +1,35 @@
+#include "rate_meter.h"
+
+#include <chrono>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+
+TEST(RateMeter, counts_events_of_the_last_minute)
+{
+    RateMeter meter;
+    const auto start = RateMeter::Clock::time_point(1h);
+
+    EXPECT_EQ(meter.perMinute(start), 0);
+    meter.record(start);
+    meter.record(start + 100ms);
+    meter.record(start + 30s);
+
+    EXPECT_EQ(meter.perMinute(start + 30s), 3);
+    EXPECT_EQ(meter.perMinute(start + 59s), 3);
+    EXPECT_EQ(meter.perMinute(start + 60s), 1);
+    EXPECT_EQ(meter.perMinute(start + 90s), 0);
+}
+
+TEST(RateMeter, reused_bucket_starts_from_zero)
+{
+    RateMeter meter;
+    const auto start = RateMeter::Clock::time_point(1h);
+
+    meter.record(start);
+    meter.record(start);
+    meter.record(start + 60s);
+
+    EXPECT_EQ(meter.perMinute(start + 60s), 1);
+}
@@ -0,0 +1,314 @@
+#include "io_access.h"
+#include "iomock.h"
+#include "resolver.h"
+#include "sticky_engine.h"
+#include "sticky_socket.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/poll.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr std::string A_NAME = "display.local";
+constexpr std::string A_LITERAL = "192.168.1.20";
+constexpr uint16_t ANY_PORT = 5000;
+constexpr in_addr_t RESOLVED_ADDRESS = 0x0A000007; // 10.0.0.7
+
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int OWNER = 0;
+constexpr int OTHER_OWNER = 1;
+
+using ::testing::_;
+using ::testing::NiceMock;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+using ::testing::StrEq;
+using ::testing::Truly;
+
+namespace
+{
+
+/***
+ * One addrinfo entry, as getaddrinfo() would hand it out
+ */
+struct Answer
+{
+    struct sockaddr_in address;
+    struct addrinfo entry;
+
+    // the entry points into the object itself
+    Answer(const Answer&) = delete;
+    Answer& operator=(const Answer&) = delete;
+
+    explicit Answer(in_addr_t ipv4)
+        : address { .sin_family = AF_INET,
+                    .sin_port = htons(ANY_PORT),
+                    .sin_addr = { .s_addr = htonl(ipv4) } }
+        , entry { .ai_family = AF_INET,
+                  .ai_socktype = SOCK_STREAM,
+                  .ai_addrlen = sizeof(address),
+                  .ai_addr = reinterpret_cast<struct sockaddr*>(&address) }
+    {
+    }
+
+    auto operator()(
+        const char*, const char*, const struct addrinfo*, struct addrinfo** out
+    )
+    {
+        *out = &entry;
+        return 0;
+    }
+};
+
+auto ipv4Of(const SocketAddress& address) -> in_addr_t
+{
+    const auto& ipv4 = reinterpret_cast<const struct sockaddr_in&>(address.storage);
+    return ntohl(ipv4.sin_addr.s_addr);
+}
+
+auto pointsTo(in_addr_t ipv4)
+{
+    return Truly([ipv4](const struct sockaddr* target)
+    {
+        const auto* in = reinterpret_cast<const struct sockaddr_in*>(target);
+        return in->sin_family == AF_INET && ntohl(in->sin_addr.s_addr) == ipv4 &&
+               ntohs(in->sin_port) == ANY_PORT;
+    });
+}
+
+// a lookup that takes as long as the test wants it to
+auto heldUntil(std::shared_future<void> released, Answer& answer)
+{
+    return [released, &answer](auto node, auto service, auto hints, auto out)
+    {
+        released.wait();
+        return answer(node, service, hints, out);
+    };
+}
+
+} // anonymous namespace
+
+TEST(Resolver, parses_numeric_address_without_a_lookup)
+{
+    IoAdapter io;
+    SocketAddress address {};
+
+    EXPECT_TRUE(Resolver::parseNumeric(io, A_LITERAL, ANY_PORT, address));
+    EXPECT_EQ(address.family(), AF_INET);
+    EXPECT_EQ(address.length, sizeof(struct sockaddr_in));
+    EXPECT_EQ(ipv4Of(address), 0xC0A80114);
+    EXPECT_FALSE(Resolver::parseNumeric(io, A_NAME, ANY_PORT, address));
+}
+
+TEST(Resolver, concurrent_requests_share_one_lookup)
+{
+    NiceMock<IoMockAdapter> iomock;
+    Answer answer(RESOLVED_ADDRESS);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    EXPECT_CALL(iomock, getaddrinfo(StrEq(A_NAME), StrEq("5000"), _, _))
+        .WillOnce(heldUntil(released, answer));
+    EXPECT_CALL(iomock, freeaddrinfo(&answer.entry)).Times(1);
+
+    std::atomic<int> answered = 0;
+    std::atomic<in_addr_t> seen = 0;
+    auto onResolved = [&answered, &seen](const Resolver::Resolution& resolution)
+    {
+        seen = ipv4Of(resolution.addresses.at(0));
+        answered++;
+    };
+    {
+        Resolver resolver(iomock, 2);
+        resolver.resolve(A_NAME, ANY_PORT, &OWNER, onResolved);
+        resolver.resolve(A_NAME, ANY_PORT, &OTHER_OWNER, onResolved);
+        release.set_value();
+
+        const auto start = std::chrono::steady_clock::now();
+        while (answered < 2 &&
+               std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        // the cached answer comes back right away, on this thread
+        resolver.resolve(A_NAME, ANY_PORT, &OWNER, onResolved);
+        EXPECT_EQ(answered, 3);
+        EXPECT_EQ(resolver.cached(), 1);
+    }
+    EXPECT_EQ(seen, RESOLVED_ADDRESS);
+}
+
+TEST(Resolver, answers_expire_after_their_time_to_live)
+{
+    NiceMock<IoMockAdapter> iomock;
+    Answer answer(RESOLVED_ADDRESS);
+    EXPECT_CALL(iomock, getaddrinfo(_, _, _, _)).WillOnce(std::ref(answer));
+
+    constexpr std::chrono::seconds TTL { 30 };
+    Resolver resolver(iomock, 1, TTL);
+    std::promise<Resolver::Resolution> done;
+    resolver.resolve(
+        A_NAME, ANY_PORT, &OWNER,
+        [&done](const Resolver::Resolution& resolution) { done.set_value(resolution); }
+    );
+    const auto resolution = done.get_future().get();
+    const auto now = Resolver::Clock::now();
+
+    Resolver::Resolution cached;
+    EXPECT_TRUE(resolver.lookup(A_NAME, ANY_PORT, cached, now));
+    EXPECT_EQ(ipv4Of(cached.addresses.at(0)), RESOLVED_ADDRESS);
+    EXPECT_FALSE(resolver.lookup(A_NAME, ANY_PORT + 1, cached, now));
+    EXPECT_FALSE(resolver.lookup(A_NAME, ANY_PORT, cached, resolution.expires));
+    EXPECT_LE(resolution.expires, now + TTL);
+}
+
+TEST(Resolver, failures_are_remembered_briefly)
+{
+    NiceMock<IoMockAdapter> iomock;
+    EXPECT_CALL(iomock, getaddrinfo(_, _, _, _)).WillOnce(Return(EAI_NONAME));
+    EXPECT_CALL(iomock, freeaddrinfo(_)).Times(0);
+
+    Resolver resolver(iomock, 1);
+    std::promise<Resolver::Resolution> done;
+    resolver.resolve(
+        A_NAME, ANY_PORT, &OWNER,
+        [&done](const Resolver::Resolution& resolution) { done.set_value(resolution); }
+    );
+    const auto resolution = done.get_future().get();
+
+    EXPECT_TRUE(resolution.addresses.empty());
+    EXPECT_LE(resolution.expires, Resolver::Clock::now() + Resolver::FAILURE_TTL);
+}
+
+TEST(Resolver, forgotten_owner_is_not_called_back)
+{
+    NiceMock<IoMockAdapter> iomock;
+    Answer answer(RESOLVED_ADDRESS);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    EXPECT_CALL(iomock, getaddrinfo(_, _, _, _))
+        .WillOnce(heldUntil(released, answer));
+
+    std::atomic<bool> forgotten = false;
+    std::promise<void> done;
+    Resolver resolver(iomock, 1);
+    resolver.resolve(
+        A_NAME, ANY_PORT, &OWNER, [&forgotten](const auto&) { forgotten = true; }
+    );
+    resolver.resolve(
+        A_NAME, ANY_PORT, &OTHER_OWNER, [&done](const auto&) { done.set_value(); }
+    );
+    resolver.forget(&OWNER);
+    release.set_value();
+    done.get_future().wait();
+
+    EXPECT_FALSE(forgotten);
+}
+
+TEST(Resolver, engine_connects_once_the_name_resolves)
+{
+    NiceMock<IoMockAdapter> iomock;
+    Answer answer(RESOLVED_ADDRESS);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    EXPECT_CALL(iomock, getaddrinfo(StrEq(A_NAME), _, _, _))
+        .WillOnce(heldUntil(released, answer));
+    EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(iomock, eventfd(0, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+    EXPECT_CALL(iomock, write(WAKE_DESCRIPTOR, _, _))
+        .WillRepeatedly(Return(sizeof(uint64_t)));
+    EXPECT_CALL(iomock, read(WAKE_DESCRIPTOR, _, _))
+        .WillRepeatedly(Return(sizeof(uint64_t)));
+    EXPECT_CALL(iomock, poll(_, _, _))
+        .WillRepeatedly(
+            [](struct pollfd* fds, nfds_t count, int)
+    {
+        fds[count - 1].revents = POLLIN;
+        return 1;
+    }
+        );
+    EXPECT_CALL(iomock, socket(AF_INET, _, _)).WillOnce(Return(GOOD_DESCRIPTOR));
+    EXPECT_CALL(iomock, connect(GOOD_DESCRIPTOR, pointsTo(RESOLVED_ADDRESS), _))
+        .WillOnce(SetErrnoAndReturn(EINPROGRESS, -1));
+
+    Resolver resolver(iomock, 1);
+    StickyEngine engine(iomock);
+    engine.setResolver(&resolver);
+    auto& skt = engine.makeSocket<StickySocket>(A_NAME, ANY_PORT);
+    EXPECT_FALSE(skt.connect()); // nothing to connect to before the answer is in
+    release.set_value();
+
+    const auto start = std::chrono::steady_clock::now();
+    while (skt.getState() != EasySocketIntf::ConnectionState::Connecting &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+        engine.poll(0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_TRUE(skt.isResolved());
+    EXPECT_EQ(ipv4Of(skt.getAddress()), RESOLVED_ADDRESS);
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connecting);
+}
+
+TEST(Resolver, pending_name_spends_no_attempt)
+{
+    NiceMock<IoMockAdapter> iomock;
+    Answer answer(RESOLVED_ADDRESS);
+    std::promise<void> release;
+    auto released = release.get_future().share();
+    EXPECT_CALL(iomock, getaddrinfo(StrEq(A_NAME), _, _, _))
+        .WillOnce(heldUntil(released, answer));
+    EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(0));
+    EXPECT_CALL(iomock, eventfd(0, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+    EXPECT_CALL(iomock, write(WAKE_DESCRIPTOR, _, _))
+        .WillRepeatedly(Return(sizeof(uint64_t)));
+    EXPECT_CALL(iomock, read(WAKE_DESCRIPTOR, _, _))
+        .WillRepeatedly(Return(sizeof(uint64_t)));
+    EXPECT_CALL(iomock, poll(_, _, _))
+        .WillRepeatedly(
+            [](struct pollfd* fds, nfds_t count, int)
+    {
+        fds[count - 1].revents = POLLIN;
+        return 1;
+    }
+        );
+    EXPECT_CALL(iomock, socket(AF_INET, _, _)).WillOnce(Return(GOOD_DESCRIPTOR));
+    EXPECT_CALL(iomock, connect(GOOD_DESCRIPTOR, _, _))
+        .WillOnce(SetErrnoAndReturn(EINPROGRESS, -1));
+
+    Resolver resolver(iomock, 1);
+    StickyEngine engine(iomock);
+    engine.setResolver(&resolver);
+    // one token, the next one takes minutes: a wasted token would stall the test
+    engine.setConnectLimits(ConnectGate::Limits { .perSecond = 0.001, .burst = 1 });
+    auto& skt = engine.makeSocket<StickySocket>(A_NAME, ANY_PORT);
+    EXPECT_FALSE(skt.connect());
+    EXPECT_FALSE(skt.connect()); // asked again while the lookup still runs
+    EXPECT_EQ(skt.getAttempts(), 0);
+    EXPECT_LE(skt.getNextAttempt(), Timer::Clock::now());
+    release.set_value();
+
+    const auto start = std::chrono::steady_clock::now();
+    while (skt.getState() != EasySocketIntf::ConnectionState::Connecting &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+        engine.poll(0);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connecting);
+}
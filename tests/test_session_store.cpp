@@ -0,0 +1,114 @@
+#include "ion_session.h"
+#include "iomock.h"
+#include "session_store.h"
+#include "sticky_socket.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr uint16_t ANY_PORT = 9999;
+constexpr int GOOD_ADDRESS = 1;
+
+using ::testing::_;
+using ::testing::Return;
+
+namespace
+{
+
+class HugeSession : public StickySocket
+{
+  public:
+    using StickySocket::StickySocket;
+
+  private:
+    std::array<uint8_t, SessionStore::SLOT_SIZE> scratch {};
+};
+
+} // anonymous namespace
+
+class SessionStoreTest : public ::testing::Test
+{
+  protected:
+    IoMockAdapter iomock;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+    }
+};
+
+TEST_F(SessionStoreTest, erased_handle_stays_stale_when_slot_is_reused)
+{
+    SessionStore store;
+    const auto first = store.emplace<StickySocket>(iomock, "127.0.0.1", ANY_PORT);
+    ASSERT_NE(store.get(first), nullptr);
+
+    EXPECT_TRUE(store.erase(first));
+    EXPECT_FALSE(store.erase(first));
+    const auto second = store.emplace<StickySocket>(iomock, "127.0.0.2", ANY_PORT);
+
+    EXPECT_EQ(second.index, first.index);
+    EXPECT_NE(second, first);
+    EXPECT_EQ(store.get(first), nullptr);
+    EXPECT_EQ(store.get(second)->getHost(), "127.0.0.2");
+    EXPECT_EQ(store.get(SessionHandle {}), nullptr);
+}
+
+TEST_F(SessionStoreTest, erase_keeps_iteration_dense)
+{
+    SessionStore store;
+    std::vector<SessionHandle> handles;
+    for (uint16_t port = 1; port <= 4; port++)
+    {
+        handles.push_back(store.emplace<StickySocket>(iomock, "127.0.0.1", port));
+    }
+
+    store.erase(handles.at(1));
+
+    std::vector<uint16_t> ports;
+    for (const auto* skt : store)
+    {
+        ports.push_back(skt->getPort());
+    }
+    EXPECT_EQ(ports, (std::vector<uint16_t> { 1, 4, 3 }));
+    for (size_t i = 0; i < store.size(); i++)
+    {
+        EXPECT_EQ(store.get(store.handleAt(i)), &store.at(i));
+    }
+}
+
+TEST_F(SessionStoreTest, sessions_do_not_move_as_the_store_grows)
+{
+    SessionStore store;
+    const auto handle = store.emplace<IonSession>(iomock, "127.0.0.1", ANY_PORT);
+    const auto* session = store.get(handle);
+
+    for (size_t i = 0; i < 3 * SessionStore::SLOTS_PER_CHUNK; i++)
+    {
+        store.emplace<StickySocket>(iomock, "127.0.0.1", ANY_PORT);
+    }
+
+    EXPECT_EQ(store.get(handle), session);
+    EXPECT_EQ(store.capacity(), 4 * SessionStore::SLOTS_PER_CHUNK);
+}
+
+TEST_F(SessionStoreTest, oversized_sessions_fall_back_to_the_heap)
+{
+    static_assert(sizeof(IonSession) <= SessionStore::SLOT_SIZE);
+    SessionStore store;
+
+    const auto pooled = store.emplace<IonSession>(iomock, "127.0.0.1", ANY_PORT);
+    const auto heaped = store.emplace<HugeSession>(iomock, "127.0.0.1", ANY_PORT);
+
+    EXPECT_TRUE(store.isPooled(pooled));
+    EXPECT_FALSE(store.isPooled(heaped));
+    EXPECT_NE(store.get(heaped), nullptr);
+    EXPECT_TRUE(store.erase(heaped));
+}
@@ -0,0 +1,98 @@
+#include "ion_service.h"
+#include "io_access.h"
+#include "shard_ring.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+constexpr size_t SHARDS = 4;
+constexpr size_t DISPLAYS = 4000;
+
+namespace
+{
+
+auto displayKey(size_t index) -> std::string
+{
+    const auto subnet = std::to_string(index / 250);
+    const auto host = std::to_string(index % 250);
+    return "10.0." + subnet + "." + host + ":5000";
+}
+
+} // anonymous namespace
+
+TEST(ShardRing, single_shard_takes_everything)
+{
+    ShardRing ring(1);
+
+    EXPECT_EQ(ring.size(), 1);
+    EXPECT_EQ(ring.pick("10.0.0.1:5000"), 0);
+}
+
+TEST(ShardRing, zero_shards_means_one)
+{
+    ShardRing ring(0);
+
+    EXPECT_EQ(ring.size(), 1);
+}
+
+TEST(ShardRing, same_key_lands_on_same_shard)
+{
+    ShardRing ring(SHARDS);
+    ShardRing twin(SHARDS);
+
+    for (size_t i = 0; i < DISPLAYS; i++)
+    {
+        EXPECT_EQ(ring.pick(displayKey(i)), twin.pick(displayKey(i)));
+    }
+}
+
+TEST(ShardRing, spreads_keys_across_all_shards)
+{
+    ShardRing ring(SHARDS);
+    std::vector<size_t> load(SHARDS, 0);
+
+    for (size_t i = 0; i < DISPLAYS; i++)
+    {
+        load.at(ring.pick(displayKey(i)))++;
+    }
+
+    for (const auto count : load)
+    {
+        EXPECT_GT(count, DISPLAYS / SHARDS / 2);
+        EXPECT_LT(count, DISPLAYS / SHARDS * 2);
+    }
+}
+
+TEST(ShardRing, adding_a_shard_moves_few_keys)
+{
+    ShardRing before(SHARDS);
+    ShardRing after(SHARDS + 1);
+    size_t moved = 0;
+
+    for (size_t i = 0; i < DISPLAYS; i++)
+    {
+        const auto was = before.pick(displayKey(i));
+        const auto now = after.pick(displayKey(i));
+        if (was != now)
+        {
+            EXPECT_EQ(now, SHARDS);
+            moved++;
+        }
+    }
+
+    EXPECT_LT(moved, DISPLAYS / 3);
+}
+
+TEST(ShardRing, service_routes_displays_by_endpoint)
+{
+    IoAdapter io;
+    IonService service(io, IonServiceConfig { .shards = SHARDS });
+
+    EXPECT_EQ(service.shardCount(), SHARDS);
+    EXPECT_EQ(service.shardOf("10.0.0.1", 5000), ShardRing(SHARDS).pick("10.0.0.1:5000"));
+    EXPECT_TRUE(service.isHealthy());
+    EXPECT_FALSE(service.isRunning());
+}
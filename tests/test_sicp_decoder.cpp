@@ -0,0 +1,161 @@
+#include "ion_session.h"
+#include "iomock.h"
+#include "sicp_decoder.h"
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+using Bytes = std::vector<uint8_t>;
+
+namespace
+{
+
+auto makeFrame(uint8_t control, uint8_t group, const Bytes& data) -> Bytes
+{
+    Bytes frame { 0, control, group };
+    frame.insert(frame.end(), data.begin(), data.end());
+    frame[0] = static_cast<uint8_t>(frame.size() + 1);
+    frame.push_back(sicp::checksum(frame));
+    return frame;
+}
+
+auto join(const std::vector<Bytes>& frames) -> Bytes
+{
+    Bytes stream;
+    for (const auto& frame : frames)
+    {
+        stream.insert(stream.end(), frame.begin(), frame.end());
+    }
+    return stream;
+}
+
+struct Collector
+{
+    std::vector<Bytes> frames;
+    std::vector<const uint8_t*> origins;
+
+    void operator()(std::span<const uint8_t> frame)
+    {
+        frames.emplace_back(frame.begin(), frame.end());
+        origins.push_back(frame.data());
+    }
+};
+
+} // anonymous namespace
+
+TEST(SicpDecoder, frame_layout_matches_the_simulator)
+{
+    const auto frame = makeFrame(0x01, 0x01, { 0x19 });
+
+    EXPECT_EQ(frame, (Bytes { 0x05, 0x01, 0x01, 0x19, 0x1c }));
+    EXPECT_TRUE(sicp::isValid(frame));
+}
+
+TEST(SicpDecoder, whole_frames_are_views_into_the_read)
+{
+    const auto stream = join({
+        makeFrame(1, 1, { 0x19 }),
+        makeFrame(2, 1, { 0xa0, 0x01 }),
+    });
+    SicpDecoder decoder;
+    Collector sink;
+
+    EXPECT_EQ(decoder.feed(stream, std::ref(sink)), 2);
+
+    ASSERT_EQ(sink.frames.size(), 2);
+    EXPECT_EQ(sink.origins[0], stream.data());
+    EXPECT_EQ(sink.origins[1], stream.data() + 5);
+    EXPECT_EQ(decoder.pendingBytes(), 0);
+    EXPECT_EQ(decoder.getFrames(), 2);
+}
+
+TEST(SicpDecoder, reassembles_frames_split_across_reads)
+{
+    const auto first = makeFrame(1, 1, { 0x19, 0x20, 0x21 });
+    const auto second = makeFrame(1, 1, { 0x30 });
+    const auto stream = join({ first, second });
+    SicpDecoder decoder;
+    Collector sink;
+
+    for (size_t i = 0; i < stream.size(); i++)
+    {
+        decoder.feed(std::span(stream).subspan(i, 1), std::ref(sink));
+    }
+
+    EXPECT_EQ(sink.frames, (std::vector<Bytes> { first, second }));
+    EXPECT_EQ(decoder.getErrors(), 0);
+}
+
+TEST(SicpDecoder, completes_staged_frame_then_reads_in_place)
+{
+    const auto first = makeFrame(1, 1, { 0x19, 0x20, 0x21 });
+    const auto second = makeFrame(1, 1, { 0x30 });
+    const auto stream = join({ first, second });
+    SicpDecoder decoder;
+    Collector sink;
+
+    decoder.feed(std::span(stream).first(4), std::ref(sink));
+    EXPECT_EQ(decoder.pendingBytes(), 4);
+    decoder.feed(std::span(stream).subspan(4), std::ref(sink));
+
+    EXPECT_EQ(sink.frames, (std::vector<Bytes> { first, second }));
+    EXPECT_EQ(sink.origins[1], stream.data() + first.size());
+}
+
+TEST(SicpDecoder, drops_frame_with_bad_checksum_and_keeps_going)
+{
+    auto broken = makeFrame(1, 1, { 0x19 });
+    broken.back() ^= 0xff;
+    const auto good = makeFrame(1, 1, { 0x20 });
+    SicpDecoder decoder;
+    Collector sink;
+
+    decoder.feed(join({ broken, good }), std::ref(sink));
+
+    EXPECT_EQ(sink.frames, (std::vector<Bytes> { good }));
+    EXPECT_EQ(decoder.getErrors(), 1);
+}
+
+TEST(SicpDecoder, skips_bytes_that_cannot_start_a_frame)
+{
+    const auto good = makeFrame(1, 1, { 0x20 });
+    SicpDecoder decoder;
+    Collector sink;
+
+    decoder.feed(join({ { 0x00, 0x02 }, good }), std::ref(sink));
+
+    EXPECT_EQ(sink.frames, (std::vector<Bytes> { good }));
+    EXPECT_EQ(decoder.getErrors(), 2);
+}
+
+TEST(SicpDecoder, session_reports_each_frame)
+{
+    class RecordingSession : public IonSession
+    {
+      public:
+        using IonSession::IonSession;
+        std::vector<Bytes> frames;
+
+        void didReceiveFrame(std::span<const uint8_t> frame) override
+        {
+            frames.emplace_back(frame.begin(), frame.end());
+        }
+    };
+
+    IoMockAdapter iomock;
+    RecordingSession session(iomock, "127.0.0.1", 5000);
+    const auto first = makeFrame(1, 1, { 0x19 });
+    const auto second = makeFrame(1, 1, { 0x20, 0x21 });
+    const auto stream = join({ first, second });
+
+    session.didReceived(std::span(stream).first(7));
+    session.didReceived(std::span(stream).subspan(7));
+
+    EXPECT_EQ(session.frames, (std::vector<Bytes> { first, second }));
+    EXPECT_EQ(session.getDecoder().getFrames(), 2);
+}
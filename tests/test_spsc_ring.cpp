@@ -0,0 +1,63 @@
+#include "spsc_ring.h"
+
+#include <cstddef>
+#include <thread>
+
+#include <gtest/gtest.h>
+
+TEST(SpscRing, refuses_pushes_when_full_and_wraps_around)
+{
+    SpscRing<int> ring(3);
+    ASSERT_EQ(ring.capacity(), 4);
+
+    for (int i = 0; i < 4; i++)
+    {
+        EXPECT_TRUE(ring.tryPush([i](int& slot) { slot = i; }));
+    }
+    EXPECT_FALSE(ring.tryPush([](int& slot) { slot = -1; }));
+
+    int seen = -1;
+    EXPECT_TRUE(ring.tryPop([&seen](int slot) { seen = slot; }));
+    EXPECT_EQ(seen, 0);
+    EXPECT_TRUE(ring.tryPush([](int& slot) { slot = 4; }));
+
+    for (int expected = 1; expected <= 4; expected++)
+    {
+        EXPECT_TRUE(ring.tryPop([&seen](int slot) { seen = slot; }));
+        EXPECT_EQ(seen, expected);
+    }
+    EXPECT_TRUE(ring.empty());
+    EXPECT_FALSE(ring.tryPop([](int) {}));
+}
+
+TEST(SpscRing, hands_values_across_threads_in_order)
+{
+    constexpr size_t COUNT = 20000;
+    SpscRing<size_t> ring(64);
+
+    std::thread producer([&ring]()
+    {
+        for (size_t i = 0; i < COUNT;)
+        {
+            if (ring.tryPush([i](size_t& slot) { slot = i; }))
+            {
+                i++;
+                continue;
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    size_t expected = 0;
+    bool ordered = true;
+    while (expected < COUNT)
+    {
+        if (!ring.tryPop([&](size_t slot) { ordered &= (slot == expected++); }))
+        {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    EXPECT_TRUE(ordered);
+}
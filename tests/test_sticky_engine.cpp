@@ -0,0 +1,416 @@
+#include "easy_socket.h"
+#include "io_access.h"
+#include "iomock.h"
+#include "sticky_engine.h"
+#include "sticky_socket.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <gmock/gmock.h>
+#include <gtest/gtest.h>
+
+constexpr std::string A_HOST = "127.0.0.1";
+constexpr std::string OTHER_HOST = "127.0.0.2";
+constexpr uint16_t ANY_PORT = 9999;
+
+constexpr int EPOLL_DESCRIPTOR = 7;
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int OTHER_DESCRIPTOR = 4;
+constexpr int GOOD_ADDRESS = 1;
+constexpr int GOOD_SOCK_OPT = 0;
+
+using ::testing::_;
+using ::testing::DoAll;
+using ::testing::InSequence;
+using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+using ::testing::StrEq;
+using ::testing::Truly;
+
+namespace
+{
+
+auto wantsEvents(uint32_t events)
+{
+    return Truly([events](const struct epoll_event* event)
+    { return event != nullptr && event->events == events; });
+}
+
+auto readyEvent(EasySocketIntf& skt, uint32_t events)
+{
+    return [&skt, events](int, struct epoll_event* out, int, int)
+    {
+        out[0] = epoll_event { .events = events, .data = { .ptr = &skt } };
+        return 1;
+    };
+}
+
+auto wakeupEvent()
+{
+    return [](int, struct epoll_event* out, int, int)
+    {
+        out[0] = epoll_event { .events = EPOLLIN, .data = { .ptr = nullptr } };
+        return 1;
+    };
+}
+
+} // anonymous namespace
+
+class StickyEngineTest : public ::testing::Test
+{
+  protected:
+    IoMockAdapter iomock;
+
+    void SetUp() override
+    {
+        EXPECT_CALL(iomock, close(_)).WillRepeatedly(Return(0));
+        EXPECT_CALL(iomock, eventfd(0, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+        EXPECT_CALL(iomock, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+        EXPECT_CALL(iomock, connect(_, _, sizeof(sockaddr_in)))
+            .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+    }
+
+    void expectEpoll()
+    {
+        EXPECT_CALL(iomock, epoll_create1(EPOLL_CLOEXEC))
+            .WillOnce(Return(EPOLL_DESCRIPTOR));
+        EXPECT_CALL(iomock, epoll_ctl(EPOLL_DESCRIPTOR, _, _, _))
+            .WillRepeatedly(Return(0));
+    }
+};
+
+TEST_F(StickyEngineTest, poll_backend_polls_every_socket)
+{
+    EXPECT_CALL(iomock, socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0))
+        .WillOnce(Return(GOOD_DESCRIPTOR))
+        .WillOnce(Return(OTHER_DESCRIPTOR));
+    EXPECT_CALL(iomock, epoll_create1(_)).Times(0);
+    // both sockets and the wakeup descriptor
+    EXPECT_CALL(iomock, poll(_, 3, _)).WillOnce(Return(0));
+
+    StickyEngine engine(iomock);
+    engine.makeSocket<StickySocket>(A_HOST, ANY_PORT).connect();
+    engine.makeSocket<StickySocket>(OTHER_HOST, ANY_PORT).connect();
+
+    EXPECT_EQ(engine.getBackend(), StickyEngine::Backend::Poll);
+    EXPECT_EQ(engine.poll(0), 0);
+}
+
+TEST_F(StickyEngineTest, epoll_backend_registers_descriptor_on_connect)
+{
+    expectEpoll();
+    EXPECT_CALL(iomock, socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0))
+        .WillOnce(Return(GOOD_DESCRIPTOR));
+    EXPECT_CALL(
+        iomock,
+        epoll_ctl(EPOLL_DESCRIPTOR, EPOLL_CTL_ADD, GOOD_DESCRIPTOR, wantsEvents(EPOLLOUT))
+    )
+        .WillOnce(Return(0));
+
+    StickyEngine engine(iomock, StickyEngine::Backend::Epoll);
+    auto& skt = engine.makeSocket<StickySocket>(A_HOST, ANY_PORT);
+
+    EXPECT_TRUE(skt.connect());
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Connecting);
+}
+
+TEST_F(StickyEngineTest, epoll_backend_dispatches_only_ready_sockets)
+{
+    expectEpoll();
+    EXPECT_CALL(iomock, socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0))
+        .WillOnce(Return(GOOD_DESCRIPTOR))
+        .WillOnce(Return(OTHER_DESCRIPTOR));
+    EXPECT_CALL(iomock, getsockopt(GOOD_DESCRIPTOR, SOL_SOCKET, SO_ERROR, _, _))
+        .WillOnce(Return(GOOD_SOCK_OPT));
+    EXPECT_CALL(iomock, getsockopt(OTHER_DESCRIPTOR, _, _, _, _)).Times(0);
+    EXPECT_CALL(
+        iomock,
+        epoll_ctl(
+            EPOLL_DESCRIPTOR,
+            EPOLL_CTL_MOD,
+            GOOD_DESCRIPTOR,
+            wantsEvents(EPOLLIN | EPOLLPRI)
+        )
+    )
+        .WillOnce(Return(0));
+    EXPECT_CALL(iomock, poll(_, _, _)).Times(0);
+
+    StickyEngine engine(iomock, StickyEngine::Backend::Epoll);
+    auto& first = engine.makeSocket<StickySocket>(A_HOST, ANY_PORT);
+    auto& second = engine.makeSocket<StickySocket>(OTHER_HOST, ANY_PORT);
+    first.connect();
+    second.connect();
+    EXPECT_CALL(iomock, epoll_wait(EPOLL_DESCRIPTOR, _, _, _))
+        .WillOnce(readyEvent(first, EPOLLOUT));
+
+    EXPECT_EQ(engine.poll(0), 1);
+
+    EXPECT_EQ(first.getState(), EasySocketIntf::ConnectionState::Connected);
+    EXPECT_EQ(second.getState(), EasySocketIntf::ConnectionState::Connecting);
+}
+
+TEST_F(StickyEngineTest, epoll_backend_forgets_descriptor_before_closing)
+{
+    expectEpoll();
+    EXPECT_CALL(iomock, socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0))
+        .WillOnce(Return(GOOD_DESCRIPTOR));
+
+    StickyEngine engine(iomock, StickyEngine::Backend::Epoll);
+    auto& skt = engine.makeSocket<StickySocket>(A_HOST, ANY_PORT);
+    skt.connect();
+
+    {
+        InSequence order;
+        EXPECT_CALL(iomock, epoll_ctl(EPOLL_DESCRIPTOR, EPOLL_CTL_DEL, GOOD_DESCRIPTOR, _))
+            .WillOnce(Return(0));
+        EXPECT_CALL(iomock, close(GOOD_DESCRIPTOR)).WillOnce(Return(0));
+    }
+    skt.disconnect();
+
+    EXPECT_EQ(skt.getState(), EasySocketIntf::ConnectionState::Disconnected);
+}
+
+TEST_F(StickyEngineTest, post_signals_wakeup_once_until_drained)
+{
+    expectEpoll();
+    EXPECT_CALL(iomock, write(WAKE_DESCRIPTOR, _, sizeof(uint64_t)))
+        .Times(2)
+        .WillRepeatedly(Return(sizeof(uint64_t)));
+    EXPECT_CALL(iomock, read(WAKE_DESCRIPTOR, _, sizeof(uint64_t)))
+        .WillOnce(Return(sizeof(uint64_t)));
+    EXPECT_CALL(iomock, epoll_wait(EPOLL_DESCRIPTOR, _, _, _))
+        .WillOnce(wakeupEvent())
+        .WillOnce(Return(0));
+
+    StickyEngine engine(iomock, StickyEngine::Backend::Epoll);
+    std::vector<int> order;
+    engine.post([&order](StickyEngine&) { order.push_back(1); });
+    engine.post([&order](StickyEngine&) { order.push_back(2); });
+
+    engine.poll(0);
+    EXPECT_EQ(order, (std::vector<int> { 1, 2 }));
+
+    engine.post([&order](StickyEngine&) { order.push_back(3); });
+    engine.poll(0);
+    EXPECT_EQ(order, (std::vector<int> { 1, 2, 3 }));
+}
+
+TEST_F(StickyEngineTest, posted_command_finds_socket_by_endpoint)
+{
+    EXPECT_CALL(iomock, write(WAKE_DESCRIPTOR, _, _)).WillOnce(Return(sizeof(uint64_t)));
+    EXPECT_CALL(iomock, read(WAKE_DESCRIPTOR, _, _)).WillOnce(Return(sizeof(uint64_t)));
+    EXPECT_CALL(iomock, poll(_, 2, _))
+        .WillOnce(
+            [](struct pollfd* fds, nfds_t count, int)
+    {
+        fds[count - 1].revents = POLLIN;
+        return 1;
+    }
+        );
+
+    StickyEngine engine(iomock);
+    auto& skt = engine.makeSocket<StickySocket>(A_HOST, ANY_PORT);
+    StickySocket* found = nullptr;
+    engine.post([&found](StickyEngine& self) { found = self.find(A_HOST, ANY_PORT); });
+
+    engine.poll(0);
+    EXPECT_EQ(found, &skt);
+    EXPECT_EQ(engine.find(OTHER_HOST, ANY_PORT), nullptr);
+}
+
+TEST_F(StickyEngineTest, removed_session_is_closed_and_its_handle_goes_stale)
+{
+    EXPECT_CALL(iomock, socket(_, _, _)).WillOnce(Return(GOOD_DESCRIPTOR));
+    EXPECT_CALL(iomock, close(GOOD_DESCRIPTOR)).WillOnce(Return(0));
+
+    StickyEngine engine(iomock);
+    const auto handle = engine.makeSession<StickySocket>(A_HOST, ANY_PORT);
+    engine.lookup(handle)->connect();
+
+    EXPECT_TRUE(engine.remove(handle));
+    EXPECT_EQ(engine.lookup(handle), nullptr);
+    EXPECT_FALSE(engine.remove(handle));
+    EXPECT_EQ(engine.find(A_HOST, ANY_PORT), nullptr);
+    EXPECT_EQ(engine.getSessions().size(), 0);
+}
+
+TEST(StickyEngine, post_from_another_thread_wakes_blocked_poll)
+{
+    constexpr int LONG_WAIT = 5000;
+    IoAdapter io;
+    StickyEngine engine(io, StickyEngine::Backend::Epoll);
+    std::atomic<bool> done = false;
+
+    std::jthread operatorThread(
+        [&engine, &done]()
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        engine.post([&done](StickyEngine&) { done = true; });
+    }
+    );
+
+    const auto start = std::chrono::steady_clock::now();
+    while (!done && std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+        engine.poll(LONG_WAIT);
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+
+    EXPECT_TRUE(done);
+    EXPECT_LT(elapsed, std::chrono::milliseconds(LONG_WAIT));
+}
+
+TEST(StickyEngine, refused_connect_sleeps_until_the_retry_is_due)
+{
+    // bound but not listening, so connecting to it is refused right away
+    const int closed = ::socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr {
+        .sin_family = AF_INET,
+        .sin_port = 0,
+        .sin_addr = { .s_addr = htonl(INADDR_LOOPBACK) },
+    };
+    socklen_t len = sizeof(addr);
+    ::bind(closed, reinterpret_cast<struct sockaddr*>(&addr), len);
+    ::getsockname(closed, reinterpret_cast<struct sockaddr*>(&addr), &len);
+
+    IoAdapter io;
+    StickyEngine engine(io, StickyEngine::Backend::Poll);
+    auto& skt = engine.makeSocket<StickySocket>(A_HOST, ntohs(addr.sin_port));
+    ASSERT_TRUE(skt.connect());
+
+    size_t polls = 0;
+    const auto start = std::chrono::steady_clock::now();
+    while (skt.getAttempts() < 2 &&
+           std::chrono::steady_clock::now() - start < std::chrono::seconds(5))
+    {
+        engine.poll(-1);
+        polls++;
+    }
+    ::close(closed);
+
+    // refused, a blocking wait for the retry, refused again: no spinning in between
+    EXPECT_EQ(skt.getAttempts(), 2);
+    EXPECT_LT(polls, 10);
+}
+
+TEST_F(StickyEngineTest, timer_slack_aligns_timeout_to_shared_grid)
+{
+    constexpr int SLACK = 250;
+    constexpr int DUE_IN = 10;
+    EXPECT_CALL(
+        iomock, poll(_, _, Truly([](int timeout)
+    {
+        const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            Timer::Clock::now().time_since_epoch()
+        );
+        const auto offGrid = (now.count() + timeout) % SLACK;
+        return timeout >= DUE_IN && (offGrid <= 1 || offGrid == SLACK - 1);
+    }))
+    )
+        .WillOnce(Return(0));
+
+    StickyEngine engine(iomock);
+    engine.setTimerSlack(std::chrono::milliseconds(SLACK));
+    Timer timer([]() {});
+    engine.schedule(timer, Timer::Clock::now() + std::chrono::milliseconds(DUE_IN));
+
+    engine.poll(-1);
+    engine.cancel(timer);
+}
+
+TEST_F(StickyEngineTest, broadcast_shares_one_buffer_and_reports_each_target)
+{
+    const std::vector<uint8_t> frame { 0x05, 0x01, 0x00, 0x18, 0x1c };
+    EXPECT_CALL(iomock, socket(_, _, _))
+        .WillOnce(Return(GOOD_DESCRIPTOR))
+        .WillOnce(Return(OTHER_DESCRIPTOR));
+    EXPECT_CALL(iomock, getsockopt(_, _, _, _, _)).WillRepeatedly(Return(GOOD_SOCK_OPT));
+
+    std::vector<const void*> buffers;
+    EXPECT_CALL(iomock, writev(_, _, 1))
+        .WillRepeatedly(
+            [&buffers](int, const struct iovec* iov, int)
+    {
+        buffers.push_back(iov[0].iov_base);
+        return static_cast<ssize_t>(iov[0].iov_len);
+    }
+        );
+
+    StickyEngine engine(iomock);
+    std::vector<StickySocket*> targets;
+    for (const auto& host : { A_HOST, OTHER_HOST, std::string("127.0.0.3") })
+    {
+        targets.push_back(&engine.makeSocket<StickySocket>(host, ANY_PORT));
+    }
+    for (auto* skt : std::span(targets).first(2))
+    {
+        skt->connect();
+        skt->eval(pollfd { .fd = skt->getDescriptor(), .events = 0, .revents = POLLOUT });
+    }
+
+    std::vector<std::pair<std::string, bool>> report;
+    const size_t queued = engine.broadcast(
+        frame, targets,
+        [&report](EasySocketIntf& skt, bool sent)
+    { report.emplace_back(skt.getHost(), sent); }
+    );
+
+    EXPECT_EQ(queued, 2);
+    ASSERT_EQ(buffers.size(), 2);
+    EXPECT_EQ(buffers[0], buffers[1]);
+    const std::vector<std::pair<std::string, bool>> expected {
+        { A_HOST, true },
+        { OTHER_HOST, true },
+        { "127.0.0.3", false },
+    };
+    EXPECT_EQ(report, expected);
+}
+
+TEST_F(StickyEngineTest, broadcast_keeps_frame_alive_until_last_target_sends)
+{
+    EXPECT_CALL(iomock, socket(_, _, _))
+        .WillOnce(Return(GOOD_DESCRIPTOR))
+        .WillOnce(Return(OTHER_DESCRIPTOR));
+    EXPECT_CALL(iomock, getsockopt(_, _, _, _, _)).WillRepeatedly(Return(GOOD_SOCK_OPT));
+    EXPECT_CALL(iomock, writev(GOOD_DESCRIPTOR, _, _))
+        .WillRepeatedly([](int, const struct iovec* iov, int)
+    { return static_cast<ssize_t>(iov[0].iov_len); });
+    EXPECT_CALL(iomock, writev(OTHER_DESCRIPTOR, _, _))
+        .WillOnce(SetErrnoAndReturn(EAGAIN, -1))
+        .WillOnce([](int, const struct iovec* iov, int)
+    { return static_cast<ssize_t>(iov[0].iov_len); });
+
+    StickyEngine engine(iomock);
+    auto& first = engine.makeSocket<StickySocket>(A_HOST, ANY_PORT);
+    auto& second = engine.makeSocket<StickySocket>(OTHER_HOST, ANY_PORT);
+    for (auto* skt : { &first, &second })
+    {
+        skt->connect();
+        skt->eval(pollfd { .fd = skt->getDescriptor(), .events = 0, .revents = POLLOUT });
+    }
+
+    size_t sent = 0;
+    const std::vector<uint8_t> frame(100, 0x42);
+    const auto onDelivery = [&sent](EasySocketIntf&, bool ok) { sent += ok ? 1 : 0; };
+    EXPECT_EQ(engine.broadcast(frame, onDelivery), 2);
+    EXPECT_EQ(sent, 1);
+    EXPECT_EQ(second.pendingBytes(), frame.size());
+
+    second.eval(pollfd { .fd = OTHER_DESCRIPTOR, .events = 0, .revents = POLLOUT });
+    EXPECT_EQ(sent, 2);
+    EXPECT_EQ(second.pendingBytes(), 0);
+}
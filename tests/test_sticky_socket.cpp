@@ -1,14 +1,131 @@
 #include "iomock.h"
+#include "sticky_engine.h"
 #include "sticky_socket.h"
 
 #include <gmock/gmock.h>
 #include <gtest/gtest.h>
+#include <chrono>
 #include <memory>
+#include <set>
+#include <vector>
 
 constexpr int ANY_PORT = 9999;
 constexpr std::string A_HOST = "localhost";
+constexpr int GOOD_DESCRIPTOR = 3;
+constexpr int WAKE_DESCRIPTOR = 8;
+constexpr int GOOD_ADDRESS = 1;
+constexpr int BAD_ADDRESS = 0;
 
+using ::testing::_;
+using ::testing::AllOf;
+using ::testing::Gt;
+using ::testing::Le;
 using ::testing::Return;
+using ::testing::SetErrnoAndReturn;
+
+TEST(StickySocket, failed_connect_waits_for_backoff)
+{
+    IoMockAdapter iom;
+    EXPECT_CALL(iom, inet_pton(AF_INET, _, _)).Times(1).WillOnce(Return(BAD_ADDRESS));
+    StickySocket skt(iom, A_HOST, ANY_PORT);
+
+    EXPECT_FALSE(skt.connect());
+    EXPECT_GT(skt.getNextAttempt(), Timer::Clock::now());
+
+    EXPECT_FALSE(skt.reconnect());
+    EXPECT_EQ(skt.getState(), StickySocket::ConnectionState::Disconnected);
+}
+
+TEST(StickySocket, backoff_is_jittered_within_its_upper_half)
+{
+    constexpr size_t FLEET = 32;
+    constexpr auto FIRST_BACKOFF = 4 * StickySocket::BACKOFF_MULTIPLIER;
+    IoMockAdapter iom;
+    EXPECT_CALL(iom, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(BAD_ADDRESS));
+
+    std::set<Timer::Clock::duration> delays;
+    for (size_t i = 0; i < FLEET; i++)
+    {
+        StickySocket skt(iom, A_HOST, ANY_PORT);
+        const auto before = Timer::Clock::now();
+        EXPECT_FALSE(skt.connect());
+        const auto delay = skt.getNextAttempt() - before;
+
+        EXPECT_GE(delay, FIRST_BACKOFF / 2);
+        EXPECT_LE(delay, FIRST_BACKOFF + std::chrono::milliseconds(5));
+        delays.insert(std::chrono::duration_cast<std::chrono::milliseconds>(delay));
+    }
+
+    // a fleet failing together does not retry in lockstep
+    EXPECT_GT(delays.size(), 1);
+}
+
+TEST(StickySocket, fleet_dropped_together_retries_apart)
+{
+    constexpr size_t FLEET = 32;
+    IoMockAdapter iom;
+    EXPECT_CALL(iom, close(_)).WillRepeatedly(Return(0));
+    EXPECT_CALL(iom, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+    EXPECT_CALL(iom, socket(_, _, _)).WillRepeatedly(Return(GOOD_DESCRIPTOR));
+    EXPECT_CALL(iom, connect(GOOD_DESCRIPTOR, _, _))
+        .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+    EXPECT_CALL(iom, getsockopt(GOOD_DESCRIPTOR, _, _, _, _)).WillRepeatedly(Return(0));
+
+    std::vector<std::unique_ptr<StickySocket>> fleet;
+    for (size_t i = 0; i < FLEET; i++)
+    {
+        fleet.push_back(std::make_unique<StickySocket>(iom, A_HOST, ANY_PORT));
+        auto& skt = *fleet.back();
+        skt.connect();
+        skt.eval(pollfd { .fd = GOOD_DESCRIPTOR, .events = 0, .revents = POLLOUT });
+        ASSERT_TRUE(skt.isOnline());
+    }
+
+    std::set<Timer::Clock::duration> delays;
+    for (auto& skt : fleet)
+    {
+        const auto dropped = Timer::Clock::now();
+        skt->eval(pollfd { .fd = GOOD_DESCRIPTOR, .events = 0, .revents = POLLHUP });
+        const auto delay = skt->getNextAttempt() - dropped;
+
+        EXPECT_LE(delay, StickySocket::BACKOFF_MULTIPLIER + std::chrono::milliseconds(5));
+        delays.insert(std::chrono::duration_cast<std::chrono::milliseconds>(delay));
+    }
+
+    EXPECT_GT(delays.size(), 1);
+}
+
+TEST(StickySocket, connect_timeout_bounds_next_poll_by_backoff)
+{
+    constexpr int FIRST_BACKOFF = 4 * StickySocket::BACKOFF_MULTIPLIER.count();
+    IoMockAdapter iom;
+    EXPECT_CALL(iom, close(_)).WillRepeatedly(Return(0));
+    EXPECT_CALL(iom, inet_pton(AF_INET, _, _)).WillRepeatedly(Return(GOOD_ADDRESS));
+    EXPECT_CALL(iom, socket(_, _, _)).WillRepeatedly(Return(GOOD_DESCRIPTOR));
+    EXPECT_CALL(iom, connect(GOOD_DESCRIPTOR, _, _))
+        .WillRepeatedly(SetErrnoAndReturn(EINPROGRESS, -1));
+    EXPECT_CALL(iom, eventfd(_, _)).WillRepeatedly(Return(WAKE_DESCRIPTOR));
+    EXPECT_CALL(iom, poll(_, 2, _))
+        .WillOnce(
+            [](struct pollfd* fds, nfds_t, int)
+    {
+        fds[0].revents = POLLERR;
+        return 1;
+    }
+        );
+    // deadlines round up to the next millisecond tick
+    EXPECT_CALL(iom, poll(_, 2, AllOf(Gt(0), Le(FIRST_BACKOFF + 1)))).WillOnce(Return(0));
+
+    StickyEngine engine(iom);
+    auto& skt = engine.makeSocket<StickySocket>(A_HOST, ANY_PORT);
+    skt.connect();
+
+    engine.poll(0);
+    EXPECT_EQ(skt.getState(), StickySocket::ConnectionState::Disconnected);
+
+    engine.poll(60000);
+    EXPECT_EQ(skt.getState(), StickySocket::ConnectionState::Disconnected);
+}
 
 /*class SocketTest : public ::testing::Test*/
 /*{*/
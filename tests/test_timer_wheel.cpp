@@ -0,0 +1,170 @@
+#include "timer_wheel.h"
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std::chrono_literals;
+using Clock = TimerWheel::Clock;
+
+class TimerWheelTest : public ::testing::Test
+{
+  protected:
+    Clock::time_point origin { Clock::now() };
+    TimerWheel wheel { origin };
+    std::vector<int> fired;
+};
+
+TEST_F(TimerWheelTest, empty_wheel_blocks_forever)
+{
+    EXPECT_EQ(wheel.size(), 0);
+    EXPECT_EQ(wheel.timeout(origin), -1);
+    EXPECT_EQ(wheel.advance(origin + 1h), 0);
+}
+
+TEST_F(TimerWheelTest, fires_at_the_deadline_not_before)
+{
+    Timer timer([this]() { fired.push_back(1); });
+    wheel.schedule(timer, origin + 40ms);
+
+    EXPECT_TRUE(timer.isArmed());
+    EXPECT_EQ(wheel.advance(origin + 39ms), 0);
+    EXPECT_TRUE(fired.empty());
+
+    EXPECT_EQ(wheel.advance(origin + 40ms), 1);
+    EXPECT_EQ(fired.size(), 1);
+    EXPECT_FALSE(timer.isArmed());
+    EXPECT_EQ(wheel.size(), 0);
+}
+
+TEST_F(TimerWheelTest, fires_across_every_level_in_order)
+{
+    Timer soon([this]() { fired.push_back(1); });
+    Timer later([this]() { fired.push_back(2); });
+    Timer much([this]() { fired.push_back(3); });
+    Timer hours([this]() { fired.push_back(4); });
+    wheel.schedule(hours, origin + 7h);
+    wheel.schedule(much, origin + 5min);
+    wheel.schedule(later, origin + 3s);
+    wheel.schedule(soon, origin + 20ms);
+
+    wheel.advance(origin + 2999ms);
+    EXPECT_EQ(fired, std::vector<int>({ 1 }));
+
+    wheel.advance(origin + 3s);
+    EXPECT_EQ(fired, std::vector<int>({ 1, 2 }));
+
+    wheel.advance(origin + 5min - 1ms);
+    EXPECT_EQ(fired.size(), 2);
+
+    wheel.advance(origin + 5min);
+    EXPECT_EQ(fired, std::vector<int>({ 1, 2, 3 }));
+
+    wheel.advance(origin + 7h - 1ms);
+    EXPECT_EQ(fired.size(), 3);
+
+    wheel.advance(origin + 7h);
+    EXPECT_EQ(fired, std::vector<int>({ 1, 2, 3, 4 }));
+}
+
+TEST_F(TimerWheelTest, cancelled_timer_never_fires)
+{
+    Timer timer([this]() { fired.push_back(1); });
+    wheel.schedule(timer, origin + 2s);
+
+    wheel.cancel(timer);
+
+    EXPECT_FALSE(timer.isArmed());
+    EXPECT_EQ(wheel.size(), 0);
+    EXPECT_EQ(wheel.advance(origin + 3s), 0);
+    EXPECT_TRUE(fired.empty());
+}
+
+TEST_F(TimerWheelTest, destroyed_timer_leaves_the_wheel)
+{
+    {
+        Timer timer([this]() { fired.push_back(1); });
+        wheel.schedule(timer, origin + 2s);
+        EXPECT_EQ(wheel.size(), 1);
+    }
+
+    EXPECT_EQ(wheel.size(), 0);
+    EXPECT_EQ(wheel.advance(origin + 3s), 0);
+}
+
+TEST_F(TimerWheelTest, rescheduling_moves_the_deadline)
+{
+    Timer timer([this]() { fired.push_back(1); });
+    wheel.schedule(timer, origin + 10ms);
+    wheel.schedule(timer, origin + 900ms);
+
+    EXPECT_EQ(wheel.size(), 1);
+    EXPECT_EQ(wheel.advance(origin + 899ms), 0);
+    EXPECT_EQ(wheel.advance(origin + 900ms), 1);
+}
+
+TEST_F(TimerWheelTest, past_deadline_fires_on_next_advance)
+{
+    wheel.advance(origin + 1s);
+    Timer timer([this]() { fired.push_back(1); });
+    wheel.schedule(timer, origin + 500ms);
+
+    EXPECT_EQ(wheel.timeout(origin + 1s), 0);
+    EXPECT_EQ(wheel.advance(origin + 1s), 1);
+}
+
+TEST_F(TimerWheelTest, timeout_tracks_nearest_deadline)
+{
+    Timer near([]() {});
+    Timer far([]() {});
+    wheel.schedule(far, origin + 10s);
+    EXPECT_EQ(wheel.timeout(origin), 10000);
+
+    wheel.schedule(near, origin + 250ms);
+    EXPECT_EQ(wheel.timeout(origin), 250);
+    EXPECT_EQ(wheel.timeout(origin + 100ms), 150);
+
+    wheel.advance(origin + 250ms);
+    EXPECT_EQ(wheel.timeout(origin + 250ms), 9750);
+}
+
+TEST_F(TimerWheelTest, callback_may_reschedule_itself)
+{
+    int rounds = 0;
+    Timer timer([]() {});
+    Timer ticker([&]()
+    {
+        rounds++;
+        wheel.schedule(timer, origin + 5s);
+    });
+    wheel.schedule(ticker, origin + 100ms);
+
+    wheel.advance(origin + 200ms);
+
+    EXPECT_EQ(rounds, 1);
+    EXPECT_TRUE(timer.isArmed());
+}
+
+TEST_F(TimerWheelTest, many_timers_fire_exactly_once)
+{
+    constexpr size_t COUNT = 5000;
+    std::vector<std::unique_ptr<Timer>> timers;
+    size_t total = 0;
+    for (size_t i = 0; i < COUNT; i++)
+    {
+        timers.push_back(std::make_unique<Timer>([&total]() { total++; }));
+        wheel.schedule(*timers.back(), origin + std::chrono::milliseconds(i * 37));
+    }
+
+    for (auto now = origin; now <= origin + (COUNT * 37ms); now += 333ms)
+    {
+        wheel.advance(now);
+    }
+    wheel.advance(origin + (COUNT * 37ms));
+
+    EXPECT_EQ(total, COUNT);
+    EXPECT_EQ(wheel.size(), 0);
+}
@@ -0,0 +1,168 @@
+#include "io_access.h"
+#include "shared_frame.h"
+#include "sticky_engine.h"
+#include "sticky_socket.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include <gtest/gtest.h>
+
+constexpr std::string LOOPBACK = "127.0.0.1";
+constexpr int POLL_WINDOW = 10;
+constexpr int MAX_ROUNDS = 100;
+constexpr char TEST_DATA[] = "Hello";
+
+namespace
+{
+
+class RecordingSocket : public StickySocket
+{
+  public:
+    std::string received;
+
+    RecordingSocket(const IoIntf& useIo, std::string host, uint16_t port)
+        : StickySocket(useIo, std::move(host), port)
+    {
+    }
+
+    void didReceived(std::span<const uint8_t> data) override
+    {
+        received.append(data.begin(), data.end());
+    }
+};
+
+class Listener
+{
+  public:
+    Listener()
+        : descriptor(::socket(AF_INET, SOCK_STREAM, 0))
+    {
+        struct sockaddr_in addr {
+            .sin_family = AF_INET,
+            .sin_port = 0,
+            .sin_addr = { .s_addr = htonl(INADDR_LOOPBACK) },
+        };
+        socklen_t len = sizeof(addr);
+        ::bind(descriptor, reinterpret_cast<struct sockaddr*>(&addr), len);
+        ::listen(descriptor, 1);
+        ::getsockname(descriptor, reinterpret_cast<struct sockaddr*>(&addr), &len);
+        port = ntohs(addr.sin_port);
+    }
+
+    ~Listener() { ::close(descriptor); }
+
+    Listener(const Listener&) = delete;
+    Listener& operator=(const Listener&) = delete;
+    Listener(Listener&&) = delete;
+    Listener& operator=(Listener&&) = delete;
+
+    [[nodiscard]] auto accept() const -> int
+    {
+        return ::accept(descriptor, nullptr, nullptr);
+    }
+
+    int descriptor;
+    uint16_t port;
+};
+
+// counts the writes the socket makes itself, the ring's sends bypass it
+class CountingIo : public IoAdapter
+{
+  public:
+    auto writev(int fd, const struct iovec* iov, int iovcnt) const -> ssize_t override
+    {
+        writes++;
+        return IoAdapter::writev(fd, iov, iovcnt);
+    }
+
+    mutable int writes = 0;
+};
+
+template <typename Predicate> auto spin(StickyEngine& engine, Predicate done) -> bool
+{
+    for (int round = 0; round < MAX_ROUNDS && !done(); round++)
+    {
+        engine.poll(POLL_WINDOW);
+    }
+    return done();
+}
+
+} // anonymous namespace
+
+TEST(UringPoller, receives_through_the_buffer_ring)
+{
+    IoAdapter io;
+    Listener server;
+    StickyEngine engine(io, StickyEngine::Backend::Uring);
+    if (engine.getBackend() != StickyEngine::Backend::Uring)
+    {
+        GTEST_SKIP() << "io_uring is not available here.";
+    }
+
+    auto& skt = dynamic_cast<RecordingSocket&>(
+        engine.makeSocket<RecordingSocket>(LOOPBACK, server.port)
+    );
+    skt.connect();
+    ASSERT_TRUE(spin(engine, [&]() { return skt.isOnline(); }));
+
+    const int peer = server.accept();
+    ASSERT_GE(peer, 0);
+    ASSERT_EQ(::send(peer, TEST_DATA, sizeof(TEST_DATA) - 1, 0), sizeof(TEST_DATA) - 1);
+
+    EXPECT_TRUE(spin(engine, [&]() { return !skt.received.empty(); }));
+    EXPECT_EQ(skt.received, TEST_DATA);
+
+    ::close(peer);
+    EXPECT_TRUE(spin(engine, [&]() { return !skt.isOnline(); }));
+}
+
+TEST(UringPoller, sends_queued_frames_through_the_ring)
+{
+    constexpr int FRAMES = 8;
+    CountingIo io;
+    Listener server;
+    StickyEngine engine(io, StickyEngine::Backend::Uring);
+    if (engine.getBackend() != StickyEngine::Backend::Uring)
+    {
+        GTEST_SKIP() << "io_uring is not available here.";
+    }
+
+    auto& skt = engine.makeSocket<StickySocket>(LOOPBACK, server.port);
+    skt.connect();
+    ASSERT_TRUE(spin(engine, [&]() { return skt.isOnline(); }));
+    const int peer = server.accept();
+    ASSERT_GE(peer, 0);
+
+    int delivered = 0;
+    const std::string text { TEST_DATA };
+    for (int i = 0; i < FRAMES; i++)
+    {
+        auto frame = SharedFrame::make(
+            { reinterpret_cast<const uint8_t*>(text.data()), text.size() },
+            [&delivered](EasySocketIntf&, bool sent) { delivered += sent ? 1 : 0; }
+        );
+        ASSERT_EQ(skt.send(frame), static_cast<int>(text.size()));
+    }
+    EXPECT_TRUE(spin(engine, [&]() { return delivered == FRAMES; }));
+    EXPECT_EQ(skt.pendingBytes(), 0);
+    EXPECT_EQ(io.writes, 0);
+
+    std::string received(text.size() * FRAMES, '\0');
+    const auto got = ::recv(peer, received.data(), received.size(), MSG_WAITALL);
+    ASSERT_EQ(got, static_cast<ssize_t>(received.size()));
+    std::string expected;
+    for (int i = 0; i < FRAMES; i++)
+    {
+        expected += text;
+    }
+    EXPECT_EQ(received, expected);
+    ::close(peer);
+}